@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <opencv2/core.hpp>
+
+namespace PaddleOCR {
+
+/**
+ * @brief 内存池统计快照
+ */
+struct BufferPoolStatsSnapshot {
+    long long allocations = 0;      // 经过内存池的 cv::Mat 分配次数
+    long long pool_hits = 0;        // 由空闲链表满足的次数 (未触达系统堆)
+    long long cached_bytes = 0;     // 所有线程本地缓存与全局仓库中空闲块的字节数
+    long long depot_bytes = 0;      // 其中全局仓库的部分
+    long long peak_live_bytes = 0;  // 池化块同时被使用的峰值字节数，缓存总量不超过该值
+};
+
+/**
+ * @brief 池化的 cv::MatAllocator
+ *
+ * 分配大小按 2 的幂的 1/4 步长取整为尺寸等级；释放的块先进入当前线程的本地空闲链表，
+ * 本地链表满时转入全局仓库。每个 Worker 线程处理相似尺寸的请求，稳态下检测缩放图、
+ * 裁剪图、后处理 Mat 都由本线程缓存直接复用，不再访问系统堆，也不与其他 Worker 争用分配器锁。
+ * 跨线程传递的 Mat (如 IPC 线程解码的图像) 释放时会缓存在释放方线程，由全局仓库再分发。
+ *
+ * 作为进程默认分配器，所有释放 Mat 的线程都会缓存块：每个线程本地最多 32MB (更大的块只进
+ * 全局仓库)，所有线程与仓库合计不超过池化块同时使用量的峰值，且不超过 256MB，超出时直接归还系统堆。
+ *
+ * 通过 install() 设置为进程默认分配器；安装前已分配的 Mat 仍由原分配器释放。
+ */
+class PooledMatAllocator : public cv::MatAllocator {
+public:
+    /**
+     * @brief 进程级单例，永不析构 (进程退出时仍可能有 Mat 引用它)
+     */
+    static PooledMatAllocator* instance();
+
+    /**
+     * @brief 安装为 cv::Mat 默认分配器，可重复调用
+     */
+    static void install();
+
+    static bool installed();
+
+    static BufferPoolStatsSnapshot stats();
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usage_flags) const override;
+    bool allocate(cv::UMatData* data, cv::AccessFlag access_flags,
+                  cv::UMatUsageFlags usage_flags) const override;
+    void deallocate(cv::UMatData* data) const override;
+
+    /**
+     * @brief 尺寸等级 (供测试)；超出池化上限时返回 -1
+     * @param size 请求字节数
+     * @param class_size 输出该等级的块大小
+     */
+    static int sizeClass(size_t size, size_t& class_size);
+
+private:
+    PooledMatAllocator() = default;
+
+    static std::atomic<bool> installed_;
+    static std::atomic<long long> allocations_;
+    static std::atomic<long long> pool_hits_;
+};
+
+/**
+ * @brief 只增不减的张量缓冲区
+ *
+ * 检测/分类/识别的输入输出张量按历史最大尺寸保留，稳态下 resize 不再触发分配。
+ * 不清零内容，调用方必须写满 [0, size) 区间。
+ */
+template <typename T>
+class TensorBuffer {
+public:
+    T* resize(size_t size) {
+        if (size > capacity_) {
+            data_.reset(new T[size]);
+            capacity_ = size;
+        }
+        size_ = size;
+        return data_.get();
+    }
+
+    T* data() { return data_.get(); }
+    const T* data() const { return data_.get(); }
+    size_t size() const { return size_; }
+
+private:
+    std::unique_ptr<T[]> data_;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
+
+} // namespace PaddleOCR
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+
+namespace PaddleOCR {
+
+/**
+ * @brief 请求取消标记
+ *
+ * 由服务端在客户端断开或收到 cancel 命令时置位，Worker 在出队时和各推理阶段之间检查：
+ * 排队中的请求直接移出队列，正在处理的请求在检测之后、每个识别批次之前中止。
+ */
+class CancellationToken {
+public:
+    CancellationToken() = default;
+
+    /**
+     * @brief 子标记：父标记取消时一并视为取消，自身取消不影响父标记 (用于对冲副本)
+     */
+    explicit CancellationToken(std::shared_ptr<const CancellationToken> parent) : parent_(std::move(parent)) {}
+
+    void cancel() { cancelled_.store(true, std::memory_order_release); }
+    bool isCancelled() const {
+        return cancelled_.load(std::memory_order_acquire) || (parent_ && parent_->isCancelled());
+    }
+
+private:
+    std::atomic<bool> cancelled_{false};
+    std::shared_ptr<const CancellationToken> parent_;
+};
+
+/**
+ * @brief 处理过程中发现请求已取消时抛出，Worker 据此输出取消响应
+ */
+class RequestCancelled : public std::runtime_error {
+public:
+    RequestCancelled() : std::runtime_error("Request cancelled") {}
+};
+
+} // namespace PaddleOCR
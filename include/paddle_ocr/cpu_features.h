@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+
+namespace PaddleOCR {
+
+/**
+ * @brief CPU 指令集能力探测
+ *
+ * 通过 CPUID 和 XGETBV 检测硬件支持，同时确认操作系统已启用对应的寄存器状态
+ * (AVX-512 的 ZMM/opmask、AMX 的 TILECFG/TILEDATA)，避免在虚拟机或旧系统上误判。
+ */
+struct CPUFeatures {
+    bool avx2 = false;
+    bool avx512f = false;
+    bool avx512_vnni = false;     // int8 点积加速
+    bool avx512_bf16 = false;     // bf16 点积 (Cooper Lake 及以后)
+    bool amx_bf16 = false;        // AMX bf16 矩阵单元 (Sapphire Rapids 及以后)
+    bool amx_int8 = false;
+    std::string brand;            // CPU 型号字符串
+
+    /**
+     * @brief 探测当前CPU，结果在进程内缓存
+     */
+    static const CPUFeatures& detect();
+
+    /**
+     * @brief 是否具备 bf16 推理所需的硬件 (AVX512-BF16 或 AMX-BF16)
+     */
+    bool supportsBf16() const { return avx512_bf16 || amx_bf16; }
+
+    /**
+     * @brief 单行摘要，用于启动日志和状态接口
+     */
+    std::string summary() const;
+
+    /**
+     * @brief 解析CPU推理精度
+     *
+     * "auto" 在支持 bf16 的CPU上选择 bf16，否则 fp32；
+     * 显式指定 "bf16" 但硬件不支持时回退到 fp32。其他取值原样返回。
+     */
+    static std::string resolvePrecision(const std::string& requested);
+};
+
+} // namespace PaddleOCR
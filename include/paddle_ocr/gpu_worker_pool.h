@@ -1,33 +1,18 @@
 #pragma once
 
-#include <memory>
-#include <vector>
-#include <mutex>
-#include <atomic>
-#include "ocr_worker.h"
+#include "worker_pool.h"
 
 namespace PaddleOCR {
 
 /**
  * @brief GPU Worker Pool (支持单GPU多线程)
  */
-class GPUWorkerPool {
+class GPUWorkerPool : public WorkerPool {
 public:
-    GPUWorkerPool(const std::string& model_dir, int num_workers = 2);
-    ~GPUWorkerPool();
-    
-    void start();
-    void stop();
-    std::future<std::string> submitRequest(std::shared_ptr<OCRRequest> request);
+    GPUWorkerPool(const std::string& model_dir, int num_workers = 2,
+                  const OCRWorkerConfig& config = OCRWorkerConfig());
     
     int getOptimalWorkerCount();  // 根据GPU内存自动计算最优Worker数量
-    
-private:
-    OCRWorker* getAvailableWorker();
-    
-    std::vector<std::unique_ptr<OCRWorker>> workers_;
-    std::mutex workers_mutex_;
-    std::atomic<int> next_worker_index_;
 };
 
 } // namespace PaddleOCR
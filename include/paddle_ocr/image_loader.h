@@ -0,0 +1,109 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <opencv2/core.hpp>
+
+namespace PaddleOCR {
+
+/**
+ * @brief image_path 请求的缩小解码配置
+ *
+ * 大尺寸 JPEG 利用解码器的 DCT 域缩放 (1/2、1/4、1/8) 直接解码为小图做检测和识别；
+ * 只有缩小图上文字过矮的区域才重新解码并裁剪识别，且只解码到文字高度足够的最小倍数，不一定是原图。
+ */
+struct ReducedDecodeConfig {
+    bool enabled = false;      // 是否启用缩小解码
+    int min_side = 960;        // 缩小后最长边不低于该值 (约为检测边长上限 512 的 2 倍)
+    int min_text_height = 10;  // 缩小图上文字高度低于该值时重新解码识别，低于此高度识别准确率明显下降
+};
+
+/**
+ * @brief 只读内存映射文件，解码直接读取映射区，不再整体读入内存
+ */
+class MappedFile {
+public:
+    /**
+     * @brief 映射整个文件；失败时返回空指针并填写 error
+     */
+    static std::shared_ptr<MappedFile> open(const std::string& path, std::string& error);
+
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uchar* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    /**
+     * @brief 映射区的 1xN CV_8UC1 视图 (不拷贝)，供 cv::imdecode 使用
+     */
+    cv::Mat view() const;
+
+private:
+    MappedFile() = default;
+
+    const uchar* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
+
+/**
+ * @brief 缩小解码图像的来源，保持文件映射以便按需解码全分辨率原图
+ */
+struct ReducedImageSource {
+    std::shared_ptr<MappedFile> file;
+    int scale = 1;            // 缩小倍数：2、4 或 8
+    cv::Size original_size;   // 原图尺寸 (已计入 EXIF 旋转)
+
+    cv::Mat decodeFull() const { return decodeAt(1); }
+
+    /**
+     * @brief 按 1/reduction 解码 (1、2、4、8)，尺寸为原图各边除以 reduction 向上取整
+     */
+    cv::Mat decodeAt(int reduction) const;
+
+    /**
+     * @brief 缩小图上高 text_height 的文字达到 min_text_height 所需的最大缩小倍数 (小于 scale)，都达不到时返回 1
+     */
+    int redecodeScale(double text_height, int min_text_height) const;
+};
+
+/**
+ * @brief image_path 请求的图像加载
+ */
+class ImageLoader {
+public:
+    /**
+     * @brief 映射并解码图像文件
+     * @param path 图像路径
+     * @param config 缩小解码配置
+     * @param image 输出图像；缩小解码时为原图的 1/scale
+     * @param source 缩小解码时输出来源，否则置空
+     * @param error 失败原因
+     */
+    static bool load(const std::string& path, const ReducedDecodeConfig& config, cv::Mat& image,
+                     std::shared_ptr<const ReducedImageSource>& source, std::string& error);
+
+    /**
+     * @brief 解码已映射的文件 (调用方需要先读取文件内容时使用，如计算缓存键)
+     * @param path 仅用于错误信息
+     */
+    static bool decode(std::shared_ptr<MappedFile> file, const std::string& path, const ReducedDecodeConfig& config,
+                       cv::Mat& image, std::shared_ptr<const ReducedImageSource>& source, std::string& error);
+
+    /**
+     * @brief 从 JPEG 帧头读取图像尺寸，不解码；非 JPEG 返回 false
+     */
+    static bool probeJpegSize(const uchar* data, size_t size, cv::Size& image_size);
+
+    /**
+     * @brief 缩小后最长边不低于 min_side 的最大缩小倍数 (8/4/2)，不宜缩小时返回 1
+     */
+    static int chooseScale(cv::Size image_size, int min_side);
+};
+
+} // namespace PaddleOCR
@@ -0,0 +1,106 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace PaddleOCR {
+
+// Options shared by every backend. The TensorRT / pass fields only affect
+// the Paddle backend and carry the per-model settings the models used to
+// hard-code in their LoadModel.
+struct InferenceOptions {
+  std::string model_dir;
+  // for log lines; the mock backend also picks its output layout from it
+  // ("Detector", "Classifier", "Recognizer")
+  std::string model_name = "Model";
+
+  bool use_gpu = false;
+  int gpu_id = 0;
+  int gpu_mem = 4000;
+  int cpu_math_library_num_threads = 4;
+  bool use_mkldnn = false;
+  int mkldnn_cache_capacity = 0; // 0 keeps the Paddle default
+  bool use_tensorrt = false;
+  std::string precision = "fp32";
+
+  bool trt_engine = true;
+  int trt_workspace_size = 1 << 30;
+  int trt_max_batch_size = 1;
+  int trt_min_subgraph_size = 20;
+  std::string trt_shape_file;
+
+  std::vector<std::string> deleted_passes;
+  bool disable_glog_info = false;
+
+  // Width of the model head (cls labels, rec dictionary incl. blank);
+  // only backends that synthesize output need it
+  int num_classes = 0;
+};
+
+// Single-input / single-output float model, which covers det, cls and rec.
+// A backend instance is not thread safe; use Clone() for another thread.
+class InferenceBackend {
+public:
+  virtual ~InferenceBackend() = default;
+
+  virtual void Reshape(const std::vector<int> &shape) noexcept = 0;
+  virtual void CopyFromCpu(const float *data) noexcept = 0;
+  virtual bool Run() noexcept = 0;
+  virtual std::vector<int> OutputShape() noexcept = 0;
+  virtual void CopyToCpu(float *data) noexcept = 0;
+
+  // New instance sharing the loaded weights
+  virtual std::unique_ptr<InferenceBackend> Clone() noexcept = 0;
+
+  // "paddle", "onnxruntime", ...
+  virtual std::string Name() const noexcept = 0;
+
+  // Precision actually used after fallbacks (missing int8 model, CPU
+  // without bf16, runtime without reduced precision support)
+  virtual const std::string &EffectivePrecision() const noexcept = 0;
+};
+
+// Creates the backend named by type ("paddle", "onnxruntime" or
+// "mock[:<ms>[:<ms_per_mpixel>]]"). Falls back to Paddle when the requested
+// runtime is not compiled in or has no model file in options.model_dir.
+// Builds with PADDLE_OCR_NO_PADDLE have no Paddle runtime and fall back to
+// the mock backend instead.
+std::unique_ptr<InferenceBackend>
+CreateInferenceBackend(const std::string &type,
+                       const InferenceOptions &options) noexcept;
+
+#ifndef PADDLE_OCR_NO_PADDLE
+std::unique_ptr<InferenceBackend>
+CreatePaddleBackend(const InferenceOptions &options) noexcept;
+#endif
+
+// Deterministic stand-in for det/cls/rec that needs no model files: det
+// returns horizontal text bands, cls "not rotated", rec one-hot logits
+// derived from the input pixels. spec is the part after "mock:", i.e.
+// "<ms>[:<ms_per_mpixel>]" of simulated latency per Run (empty = none).
+std::unique_ptr<InferenceBackend>
+CreateMockBackend(const InferenceOptions &options,
+                  const std::string &spec) noexcept;
+
+#ifdef PADDLE_OCR_WITH_ORT
+// Loads <model_dir>/inference.onnx (paddle2onnx output); nullptr if absent.
+std::unique_ptr<InferenceBackend>
+CreateOrtBackend(const InferenceOptions &options) noexcept;
+#endif
+
+} // namespace PaddleOCR
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace PaddleOCR {
+
+/**
+ * @brief 原地解析的 IPC 请求
+ *
+ * 请求是单层 JSON 对象，其中 image_data 可达数 MB。解析只扫描一遍接收缓冲区，
+ * 不构建 Json::Value 树：字符串成员以 string_view 指向缓冲区，含转义的字符串
+ * 直接在缓冲区内反转义 (结果总不长于原文)，因此 Base64 图像数据不发生任何拷贝。
+ *
+ * 所有视图都指向传入的缓冲区，缓冲区必须在 IPCRequest 使用期间保持有效且不被改写。
+ */
+class IPCRequest {
+public:
+    enum class Type { String, Number, Bool, Null, Array, Object };
+
+    /**
+     * @brief 原地解析顶层 JSON 对象，会改写缓冲区中含转义的字符串
+     * @param data 接收缓冲区
+     * @param size 有效字节数
+     * @param error 失败时的错误描述
+     * @return 是否解析成功；与 JsonCpp 默认设置一致，对象之后的内容被忽略
+     */
+    bool parseInSitu(char* data, size_t size, std::string& error);
+
+    bool has(std::string_view key) const { return find(key) != nullptr; }
+
+    /**
+     * @brief 字符串成员的值；不存在或不是字符串时返回默认值
+     */
+    std::string_view getString(std::string_view key, std::string_view default_value = {}) const;
+
+    std::string_view command() const { return getString("command"); }
+
+    /**
+     * @brief 数字成员的值
+     * @return 成员存在且是数字时为 true
+     */
+    bool getNumber(std::string_view key, double& value) const;
+
+    /**
+     * @brief 成员的原始 JSON 文本 (字符串为反转义后的内容)；不存在时为空
+     */
+    std::string_view raw(std::string_view key) const;
+
+    /**
+     * @brief 读取数字数组的数组，如 [[x, y, w, h], ...] 或 [[[x, y], ...], ...]
+     * @param leaves_per_item 每个顶层元素展开后应含的数字个数
+     * @param values 按出现顺序展开的全部数字
+     * @return 成员存在、是数组且每个顶层元素都是恰含 leaves_per_item 个数字的数组时为 true
+     */
+    bool getNumberArrays(std::string_view key, size_t leaves_per_item, std::vector<double>& values) const;
+
+private:
+    struct Member {
+        std::string_view key;
+        Type type;
+        std::string_view value;  // 字符串为反转义后的内容，其他类型为原始 JSON 文本
+    };
+
+    const Member* find(std::string_view key) const;
+
+    std::vector<Member> members_;
+};
+
+} // namespace PaddleOCR
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace PaddleOCR {
+
+/**
+ * @brief 流式 JSON 写入器
+ *
+ * 直接把 JSON 文本追加到可复用的缓冲区，不构建 Json::Value 树。输出格式与
+ * Json::StreamWriterBuilder (indentation=""、emitUTF8=true、useSpecialFloats=false、
+ * 默认 17 位有效数字) 逐字节一致：无空白、字符串按 JsonCpp 规则转义、double 用 %.17g
+ * 且无小数点时补 ".0"、NaN/Inf 输出 null/±1e+9999。
+ *
+ * 注意：JsonCpp 按键名字典序输出对象成员，调用方必须按同样顺序调用 key()。
+ */
+class JsonWriter {
+public:
+    /**
+     * @brief 清空内容，保留已分配的容量
+     */
+    void clear();
+
+    const std::string& str() const { return out_; }
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    /**
+     * @brief 写入对象成员名，随后必须写入一个值
+     */
+    void key(std::string_view name);
+
+    void value(int v);
+    void value(long long v);
+    void value(double v);
+    void value(bool v);
+    void value(std::string_view v);
+    void value(const char* v) { value(std::string_view(v)); }
+    void null();
+
+    /**
+     * @brief 追加带引号并转义的字符串 (JsonCpp valueToQuotedStringN 规则)
+     */
+    static void appendQuoted(std::string& out, std::string_view s);
+
+    /**
+     * @brief 追加 double (JsonCpp valueToString 规则)
+     */
+    static void appendDouble(std::string& out, double v);
+
+private:
+    void separator();
+
+    std::string out_;
+    std::vector<bool> has_items_;  // 每层容器是否已有元素，决定是否需要逗号
+    bool after_key_ = false;
+};
+
+} // namespace PaddleOCR
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "utility.h"
+
+namespace PaddleOCR {
+
+/**
+ * @brief 版面模板中的一个字段 (单行文本区域)
+ */
+struct LayoutField {
+    std::string name;     // 字段名，输出到结果的 field
+    cv::Rect2f region;    // 相对图像宽高的坐标 [0, 1]
+};
+
+/**
+ * @brief 固定版面文档的字段区域集合
+ *
+ * 请求指定模板时跳过检测，直接按字段区域裁剪并批量识别。相对坐标与分辨率无关，
+ * 缩小解码的图像同样适用。启用对齐时每个区域向外扩展 align_margin 后收缩到区域内
+ * 的文字墨迹外接框，吸收拍摄/裁边造成的少量偏移；无文字的字段不输出。
+ */
+struct LayoutTemplate {
+    std::string name;
+    bool align = true;            // 是否按墨迹收缩对齐字段区域
+    float align_margin = 0.01f;   // 对齐时区域向外扩展的比例 (相对图像宽高)
+    std::vector<LayoutField> fields;
+
+    /**
+     * @brief 计算各字段在图像上的四边形，与 fields 一一对应；无文字的字段为全零四边形
+     */
+    std::vector<Quad> locate(const cv::Mat& image) const;
+};
+
+/**
+ * @brief 版面模板注册表，服务启动时从 JSON 文件加载，之后只读
+ *
+ * 文件格式:
+ * {"templates": [{"name": "bank_card", "align": true, "align_margin": 0.01,
+ *                 "fields": [{"name": "card_number", "box": [x, y, w, h]}]}]}
+ * box 为相对图像宽高的左上角坐标和宽高。
+ */
+class LayoutTemplateRegistry {
+public:
+    bool load(const std::string& path, std::string& error);
+    bool parse(std::string_view json, std::string& error);
+
+    /**
+     * @brief 按名称查找模板，不存在时返回空
+     */
+    std::shared_ptr<const LayoutTemplate> find(std::string_view name) const;
+
+    std::vector<std::string> names() const;
+    size_t size() const { return templates_.size(); }
+
+private:
+    std::unordered_map<std::string, std::shared_ptr<const LayoutTemplate>> templates_;
+};
+
+} // namespace PaddleOCR
@@ -15,15 +15,13 @@
 #pragma once
 
 #include <fstream>
+#include <paddle_ocr/buffer_pool.h>
+#include <paddle_ocr/inference_backend.h>
 #include <paddle_ocr/preprocess_op.h>
 #include <paddle_ocr/utility.h>
 #include <iostream>
 #include <memory>
 
-namespace paddle_infer {
-class Predictor;
-}
-
 namespace PaddleOCR {
 
 class Classifier {
@@ -46,6 +44,7 @@ public:
    * @param use_tensorrt 是否启用 TensorRT 优化 (需要 TensorRT 和 GPU)
    * @param precision 推理精度 ("fp32", "fp16", "int8")
    * @param cls_batch_num 批处理大小，同时处理的图像数量
+   * @param backend 推理后端 ("paddle", "onnxruntime")，未编译或缺少模型文件时回退到 paddle
    * 
    * @throws std::runtime_error 如果模型加载失败或检测到不支持的模型
    * @throws YAML::Exception 如果 inference.yml 解析失败
@@ -59,7 +58,8 @@ public:
                       const int &cpu_math_library_num_threads,
                       const bool &use_mkldnn, const double &cls_thresh,
                       const bool &use_tensorrt, const std::string &precision,
-                      const int &cls_batch_num) noexcept {
+                      const int &cls_batch_num,
+                      const std::string &backend = "paddle") noexcept {
     this->use_gpu_ = use_gpu;
     this->gpu_id_ = gpu_id;
     this->gpu_mem_ = gpu_mem;
@@ -71,18 +71,22 @@ public:
     this->precision_ = precision;
     this->cls_batch_num_ = cls_batch_num;
 
+    this->backend_type_ = backend;
+
     LoadModel(model_dir);
   }
   double cls_thresh = 0.9;
 
-  // Load Paddle inference model
+  // Load the inference model through the configured backend
   void LoadModel(const std::string &model_dir) noexcept;
 
-  void Run(const std::vector<cv::Mat> &img_list, std::vector<int> &cls_labels,
+  // Returns false when inference fails
+  bool Run(const std::vector<cv::Mat> &img_list, std::vector<int> &cls_labels,
            std::vector<float> &cls_scores, std::vector<double> &times) noexcept;
 
 private:
-  std::shared_ptr<paddle_infer::Predictor> predictor_;
+  std::unique_ptr<InferenceBackend> backend_;
+  std::string backend_type_ = "paddle";
 
   bool use_gpu_ = false;
   int gpu_id_ = 0;
@@ -98,8 +102,12 @@ private:
   int cls_batch_num_ = 1;
   // pre-process
   ClsResizeImg resize_op_;
-  Normalize normalize_op_;
-  PermuteBatch permute_op_;
+  NormalizePermute normalize_permute_op_;
+
+  // batch tensors kept at their high-water mark across requests
+  TensorBuffer<float> input_buffer_;
+  TensorBuffer<float> output_buffer_;
+  cv::Mat resize_img_;
 
 }; // class Classifier
 
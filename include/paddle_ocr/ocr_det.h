@@ -15,15 +15,13 @@
 #pragma once
 
 #include <fstream>
+#include <paddle_ocr/buffer_pool.h>
+#include <paddle_ocr/inference_backend.h>
 #include <paddle_ocr/postprocess_op.h>
 #include <paddle_ocr/preprocess_op.h>
 #include <iostream>
 #include <memory>
 
-namespace paddle_infer {
-class Predictor;
-}
-
 namespace PaddleOCR {
 
 class DBDetector {
@@ -50,6 +48,7 @@ public:
    * @param use_dilation 是否应用膨胀形态学操作
    * @param use_tensorrt 是否启用 TensorRT 优化 (需要 TensorRT)
    * @param precision 推理精度 ("fp32", "fp16", "int8")
+   * @param backend 推理后端 ("paddle", "onnxruntime")，未编译或缺少模型文件时回退到 paddle
    * 
    * @throws std::runtime_error 如果模型加载失败或检测到不支持的模型
    * @throws YAML::Exception 如果 inference.yml 解析失败
@@ -66,7 +65,8 @@ public:
                       const double &det_db_unclip_ratio,
                       const std::string &det_db_score_mode,
                       const bool &use_dilation, const bool &use_tensorrt,
-                      const std::string &precision) noexcept {
+                      const std::string &precision,
+                      const std::string &backend = "paddle") noexcept {
     this->use_gpu_ = use_gpu;
     this->gpu_id_ = gpu_id;
     this->gpu_mem_ = gpu_mem;
@@ -85,19 +85,45 @@ public:
     this->use_tensorrt_ = use_tensorrt;
     this->precision_ = precision;
 
+    this->backend_type_ = backend;
+
     LoadModel(model_dir);
   }
 
-  // Load Paddle inference model
+  // Load the inference model through the configured backend
   void LoadModel(const std::string &model_dir) noexcept;
 
-  // Run predictor
-  void Run(const cv::Mat &img,
-           std::vector<std::vector<std::vector<int>>> &boxes,
+  // Run predictor; returns false (with no boxes) when inference fails
+  bool Run(const cv::Mat &img,
+           std::vector<Quad> &boxes,
            std::vector<double> &times) noexcept;
 
+  // Run predictor with an explicit resize limit, e.g. native-resolution tiles
+  bool Run(const cv::Mat &img,
+           std::vector<Quad> &boxes,
+           std::vector<double> &times, int limit_side_len) noexcept;
+
+  int limit_side_len() const noexcept { return this->limit_side_len_; }
+
+  // Input tensor size Run uses for an image of the given size; the backend
+  // compiles one set of primitives per distinct size
+  cv::Size input_size(const cv::Size &image_size,
+                      int limit_side_len) const noexcept {
+    return ResizeImgType0::TargetSize(image_size, this->limit_type_,
+                                      limit_side_len);
+  }
+
+  // Precision the backend actually runs with after fallbacks
+  // (missing int8 model, CPU without bf16), valid after LoadModel
+  const std::string &effective_precision() const noexcept {
+    return this->backend_->EffectivePrecision();
+  }
+
+  std::string backend_name() const noexcept { return this->backend_->Name(); }
+
 private:
-  std::shared_ptr<paddle_infer::Predictor> predictor_;
+  std::unique_ptr<InferenceBackend> backend_;
+  std::string backend_type_ = "paddle";
 
   bool use_gpu_ = false;
   int gpu_id_ = 0;
@@ -124,11 +150,16 @@ private:
 
   // pre-process
   ResizeImgType0 resize_op_;
-  Normalize normalize_op_;
-  Permute permute_op_;
+  NormalizePermute normalize_permute_op_;
 
   // post-process
   DBPostProcessor post_processor_;
+
+  // tensors and maps kept at their high-water mark across requests
+  TensorBuffer<float> input_buffer_;
+  TensorBuffer<float> output_buffer_;
+  cv::Mat resize_img_;
+  cv::Mat cbuf_map_;
 };
 
 } // namespace PaddleOCR
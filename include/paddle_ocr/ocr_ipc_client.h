@@ -1,9 +1,15 @@
 #pragma once
 
+#include <array>
 #include <string>
+#include <vector>
 #include <mutex>
 #include <windows.h>
 
+namespace Json {
+class Value;
+}
+
 namespace PaddleOCR {
 
 /**
@@ -17,7 +23,47 @@ public:
     bool connect(int timeout_ms = 5000);
     void disconnect();
     
-    std::string recognizeImage(const std::string& image_path);
+    /**
+     * @brief 识别图像
+     * @param template_name 服务端注册的版面模板名，非空时跳过检测只识别模板字段
+     * @param rois 非空时只在这些区域内检测，每项为 {x, y, width, height}
+     */
+    std::string recognizeImage(const std::string& image_path, const std::string& template_name = "",
+                               const std::vector<std::array<int, 4>>& rois = {});
+    
+    /**
+     * @brief 只检测文字框 (detect 命令)，不运行识别
+     */
+    std::string detectText(const std::string& image_path, const std::vector<std::array<int, 4>>& rois = {});
+    
+    /**
+     * @brief 只识别给定的文字框 (recognize_regions 命令)，每项为四个角点 {x1, y1, ..., x4, y4}
+     */
+    std::string recognizeRegions(const std::string& image_path, const std::vector<std::array<int, 8>>& regions);
+    
+    /**
+     * @brief 设置之后识别/检测请求的截止时间 (deadline_ms)，0 表示不设置
+     * 服务端估计无法按时完成时立即拒绝，响应中的 retry_after_ms 为建议的重试等待时间
+     */
+    void setDeadline(int deadline_ms) { deadline_ms_ = deadline_ms; }
+    
+    /**
+     * @brief 为之后的识别/检测请求附加 cancel_id，可从另一连接用 cancelRequests 取消，空串表示不附加
+     */
+    void setCancelId(const std::string& cancel_id) { cancel_id_ = cancel_id; }
+    
+    /**
+     * @brief 发送 cancel 命令，取消服务端携带该 cancel_id 的未完成请求
+     */
+    std::string cancelRequests(const std::string& cancel_id);
+    
+    /**
+     * @brief 之后请求使用的优先级类别 (服务端 --priority-classes 中的名称) 和客户端标识，空串表示使用服务端默认
+     * 同一类别内按 client_id 公平分配，未指定时每个连接视为一个客户端
+     */
+    void setPriority(const std::string& priority) { priority_ = priority; }
+    void setClientId(const std::string& client_id) { client_id_ = client_id; }
+    
     std::string sendShutdownCommand();
     std::string getServiceStatus();
     
@@ -25,10 +71,15 @@ public:
 
 private:
     std::string sendRequest(const std::string& request_json);
+    std::string sendImageRequest(Json::Value& request, const std::string& image_path);
     
     std::string pipe_name_;
     HANDLE pipe_handle_;
     bool connected_;
+    int deadline_ms_ = 0;
+    std::string cancel_id_;
+    std::string priority_;
+    std::string client_id_;
     std::mutex comm_mutex_;
 };
 
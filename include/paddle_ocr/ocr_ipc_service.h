@@ -5,11 +5,15 @@
 #include <vector>
 #include <mutex>
 #include <atomic>
+#include <string_view>
+#include <unordered_map>
 #include <windows.h>
 #include <opencv2/opencv.hpp>
 #include "ocr_worker.h"
 #include "gpu_worker_pool.h"
 #include "cpu_worker_pool.h"
+#include "result_cache.h"
+#include "ipc_request.h"
 
 namespace PaddleOCR {
 
@@ -25,11 +29,13 @@ public:
      * @param pipe_name 命名管道名称 (Windows)
      * @param gpu_workers GPU Worker 数量 (默认: 0)
      * @param cpu_workers CPU Worker 数量 (默认: 1)
+     * @param worker_config Worker 可选配置 (分块检测等)
      */
     explicit OCRIPCService(const std::string& model_dir, 
                           const std::string& pipe_name = "\\\\.\\pipe\\ocr_service",
                           int gpu_workers = 0,
-                          int cpu_workers = 1);
+                          int cpu_workers = 1,
+                          const OCRWorkerConfig& worker_config = OCRWorkerConfig());
     
     ~OCRIPCService();
     
@@ -58,22 +64,104 @@ private:
     void ipcServerLoop();
     void handleClientConnection(HANDLE pipe_handle);
     void cleanupFinishedClientThreads();
-    std::string processIPCRequest(const std::string& request_json);
+    /**
+     * @brief 处理一条请求，在接收缓冲区上原地解析 (缓冲区内容会被改写)
+     * @param is_shutdown 输出是否为 shutdown 命令，避免为此再解析一遍
+     * @param client_pipe 发来请求的管道，等待结果期间检测到客户端断开时取消该请求
+     */
+    std::string processIPCRequest(char* data, size_t size, bool& is_shutdown,
+                                  HANDLE client_pipe = INVALID_HANDLE_VALUE);
     
     // Base64 编码/解码辅助函数
-    static std::vector<uchar> base64Decode(const std::string& encoded);
-    static cv::Mat base64ToMat(const std::string& base64_string);
+    static bool base64Decode(std::string_view encoded, std::vector<uchar>& decoded);
+    static cv::Mat base64ToMat(std::string_view base64_string);
+    
+      // 请求处理（统一转换为cv::Mat后传递给worker，图像所有权随请求转移）
+    /**
+     * @brief 解码图像并提交给 Worker，返回结果 JSON
+     * @param file 路径方式时已映射的文件，否则为空
+     */
+    /**
+     * @brief 识别请求中除图像以外的参数
+     */
+    struct RequestOptions {
+        OCRTask task = OCRTask::Recognize;
+        std::shared_ptr<const LayoutTemplate> layout;  // 版面模板，非空时跳过检测
+        std::vector<cv::Rect> rois;                    // 只在这些区域内检测
+        std::vector<Quad> regions;                     // recognize_regions 的文字框
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();  // 收到请求时起算
+        std::shared_ptr<CancellationToken> cancel_token;  // 客户端断开或 cancel 命令时置位
+        int priority_class = 0;                        // SchedulerConfig::classes 的下标
+        std::string client_id;                         // 未指定时每个连接一个
+    };
+    
+    /**
+     * @brief 从请求中读取任务类型、模板、rois/regions、截止时间和优先级类别
+     * @return 参数有误时返回错误描述，否则为空
+     */
+    std::string parseRequestOptions(const IPCRequest& request, RequestOptions& options) const;
+    
+    std::string recognizeImage(std::shared_ptr<MappedFile> file, std::string_view image_path,
+                               std::string_view image_base64, RequestOptions options,
+                               HANDLE client_pipe = INVALID_HANDLE_VALUE);
+    
+    /**
+     * @brief 解码图像并提交给Worker池，不等待结果；解码失败时返回已就绪的错误响应
+     */
+    std::future<std::string> submitImage(std::shared_ptr<MappedFile> file, std::string_view image_path,
+                                         std::string_view image_base64, RequestOptions options);
     
-      // 请求处理（统一转换为cv::Mat后传递给worker）
-    std::future<std::string> processOCRRequest(const cv::Mat& image);
+    /**
+     * @brief 客户端管道是否已断开；client_pipe 无效时视为未断开
+     */
+    static bool clientDisconnected(HANDLE client_pipe);
+    
+    /**
+     * @brief 等待 Worker 的结果；期间客户端断开时取消请求，已排队的立即移出队列
+     */
+    std::string waitForResult(std::future<std::string>& future, CancellationToken& cancel_token, HANDLE client_pipe);
+    
+    /**
+     * @brief 登记请求携带的 cancel_id，供 cancel 命令查找
+     */
+    void registerCancelId(std::string_view cancel_id, const std::shared_ptr<CancellationToken>& cancel_token);
+    
+    /**
+     * @brief 取消 cancel_id 对应的全部未完成请求
+     * @return 取消的请求数
+     */
+    int cancelRequests(std::string_view cancel_id);
+    
+    /**
+     * @brief 让各Worker池移出队列中已取消的请求
+     */
+    void removeCancelledRequests();
+    
+    // reduced_source 非空表示 image 为缩小解码，Worker 按需解码原图并输出原图坐标
+    std::future<std::string> processOCRRequest(cv::Mat&& image,
+                                               std::shared_ptr<const ReducedImageSource> reduced_source = nullptr,
+                                               RequestOptions options = RequestOptions());
     
     std::string model_dir_;
     std::string pipe_name_;
     int gpu_workers_;
     int cpu_workers_;
+    ReducedDecodeConfig reduced_decode_;  // image_path 请求的缩小解码配置
+    LayoutTemplateRegistry templates_;    // 启动时加载的版面模板，之后只读
+    AdmissionConfig admission_;           // 队列上限与默认截止时间
+    SchedulerConfig scheduling_;          // 优先级类别，请求按名称选用
+    HedgingConfig hedging_;               // 对冲阈值，status 中输出
+    CascadeConfig cascade_;               // 级联模式配置，status 中输出
     std::atomic<bool> running_;
     std::atomic<int> request_counter_;
 
+    // 请求携带的 cancel_id -> 取消标记，请求结束后标记随之释放
+    std::unordered_multimap<std::string, std::weak_ptr<CancellationToken>> cancel_ids_;
+    std::mutex cancel_ids_mutex_;
+    
+    // 按图像内容寻址的结果缓存，未启用时为空
+    std::unique_ptr<ResultCache> result_cache_;
+    
     // Worker 管理
     std::unique_ptr<GPUWorkerPool> gpu_worker_pool_;
     std::unique_ptr<CPUWorkerPool> cpu_worker_pool_;
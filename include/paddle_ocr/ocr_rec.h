@@ -15,15 +15,16 @@
 #pragma once
 
 #include <fstream>
+#include <paddle_ocr/inference_backend.h>
+#include <paddle_ocr/postprocess_op.h>
 #include <paddle_ocr/preprocess_op.h>
+#include <paddle_ocr/rec_batch_planner.h>
+#include <paddle_ocr/buffer_pool.h>
+#include <paddle_ocr/cancellation.h>
 #include <paddle_ocr/utility.h>
 #include <iostream>
 #include <memory>
 
-namespace paddle_infer {
-class Predictor;
-}
-
 namespace PaddleOCR {
 
 class CRNNRecognizer {
@@ -48,6 +49,7 @@ public:
    * @param rec_batch_num 批处理大小，同时处理的文本区域图像数量
    * @param rec_img_h 输入图像的标准化高度 (像素)
    * @param rec_img_w 输入图像的标准化宽度 (像素)
+   * @param backend 推理后端 ("paddle", "onnxruntime")，未编译或缺少模型文件时回退到 paddle
    * 
    * @throws std::runtime_error 如果模型加载失败或字典文件读取失败
    * @throws YAML::Exception 如果 inference.yml 解析失败
@@ -65,7 +67,8 @@ public:
                           const bool &use_tensorrt,
                           const std::string &precision,
                           const int &rec_batch_num, const int &rec_img_h,
-                          const int &rec_img_w) noexcept {
+                          const int &rec_img_w,
+                          const std::string &backend = "paddle") noexcept {
     this->use_gpu_ = use_gpu;
     this->gpu_id_ = gpu_id;
     this->gpu_mem_ = gpu_mem;
@@ -74,6 +77,7 @@ public:
     this->use_tensorrt_ = use_tensorrt;
     this->precision_ = precision;
     this->rec_batch_num_ = rec_batch_num;
+    this->batch_planner_config_.max_batch = rec_batch_num;
     this->rec_img_h_ = rec_img_h;
     this->rec_img_w_ = rec_img_w;
     std::vector<int> rec_image_shape = {3, rec_img_h, rec_img_w};
@@ -82,20 +86,48 @@ public:
     this->label_list_ = Utility::ReadDict(label_path);
     this->label_list_.emplace(this->label_list_.begin(), "#"); // blank char for ctc
     this->label_list_.emplace_back(" ");
+    this->ctc_decoder_.init(this->label_list_);
+
+    this->backend_type_ = backend;
 
     LoadModel(model_dir);
   }
 
-  // Load Paddle inference model
+  // Load the inference model through the configured backend
   void LoadModel(const std::string &model_dir) noexcept;
 
-  void Run(const std::vector<cv::Mat> &img_list,
+  // Stops before the next batch once cancel is set; the remaining entries of
+  // rec_texts / rec_text_scores are left untouched. Returns false when
+  // inference fails.
+  bool Run(const std::vector<cv::Mat> &img_list,
            std::vector<std::string> &rec_texts,
            std::vector<float> &rec_text_scores,
-           std::vector<double> &times) noexcept;
+           std::vector<double> &times,
+           const CancellationToken *cancel = nullptr) noexcept;
+
+  // Input height of the recognizer; crops warped to this height skip the
+  // resize step in Run
+  int rec_img_h() const noexcept { return this->rec_img_h_; }
+
+  // Padded batch width a text line of the given width/height ratio ends up
+  // in; the backend compiles one set of primitives per batch width
+  int batch_width(float wh_ratio) const noexcept {
+    int width = int(ceilf(this->rec_image_shape_[1] * wh_ratio));
+    return RecBatchPlanner::bucketWidth(width, this->rec_image_shape_[2],
+                                        this->batch_planner_config_.width_bucket);
+  }
+
+  // Precision the backend actually runs with after fallbacks
+  // (missing int8 model, CPU without bf16), valid after LoadModel
+  const std::string &effective_precision() const noexcept {
+    return this->backend_->EffectivePrecision();
+  }
+
+  std::string backend_name() const noexcept { return this->backend_->Name(); }
 
 private:
-  std::shared_ptr<paddle_infer::Predictor> predictor_;
+  std::unique_ptr<InferenceBackend> backend_;
+  std::string backend_type_ = "paddle";
 
   bool use_gpu_ = false;
   int gpu_id_ = 0;
@@ -104,6 +136,7 @@ private:
   bool use_mkldnn_ = false;
 
   std::vector<std::string> label_list_;
+  CTCGreedyDecoder ctc_decoder_;
 
   std::vector<float> mean_ = {0.5f, 0.5f, 0.5f};
   std::vector<float> scale_ = {1 / 0.5f, 1 / 0.5f, 1 / 0.5f};
@@ -111,13 +144,16 @@ private:
   bool use_tensorrt_ = false;
   std::string precision_ = "fp32";
   int rec_batch_num_ = 6;
+  RecBatchPlannerConfig batch_planner_config_;
   int rec_img_h_ = 32;
   int rec_img_w_ = 320;
   std::vector<int> rec_image_shape_ = {3, rec_img_h_, rec_img_w_};
   // pre-process
-  CrnnResizeImg resize_op_;
-  Normalize normalize_op_;
-  PermuteBatch permute_op_;
+  NormalizePermute normalize_permute_op_;
+
+  // batch tensors kept at their high-water mark across requests
+  TensorBuffer<float> input_buffer_;
+  TensorBuffer<float> output_buffer_;
 
 }; // class CrnnRecognizer
 
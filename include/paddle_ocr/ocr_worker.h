@@ -3,19 +3,108 @@
 #include <memory>
 #include <vector>
 #include <queue>
+#include <deque>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
 #include <future>
 #include <atomic>
+#include <functional>
+#include <chrono>
+#include <cstdint>
 #include <opencv2/opencv.hpp>
 
 #include "ocr_det.h"
 #include "ocr_rec.h"
 #include "ocr_cls.h"
+#include "tiled_detection.h"
+#include "json_writer.h"
+#include "image_loader.h"
+#include "result_cache.h"
+#include "rec_cache.h"
+#include "layout_template.h"
+#include "cancellation.h"
+#include "request_scheduler.h"
 
 namespace PaddleOCR {
 
+/**
+ * @brief 多分辨率级联配置
+ *
+ * 先以较小的检测边长快速跑一遍检测+识别，只有识别置信度低于阈值的区域
+ * 才从原图重新检测并识别；低置信度区域过多时直接回退到常规单次流程。
+ * 快速通道漏检的文字没有置信度可参考，只能从检测结果推断：最小的文字在快速通道中已接近
+ * 检测下限，或文字框覆盖的面积过小时，同样回退。这是启发式判断，不保证与单次流程结果一致。
+ * 因低置信度区域过多回退时，常规检测框与快速通道高置信度文字框重合的部分沿用已有识别结果。
+ */
+struct CascadeConfig {
+    bool enabled = false;            // 是否启用级联模式
+    int fast_side_len = 320;         // 快速检测的边长上限 (像素)
+    float rec_threshold = 0.85f;     // 低于该置信度的文字区域进入原图复检
+    float roi_expand = 0.5f;         // 复检区域按框高的比例向四周扩展
+    float max_refine_ratio = 0.5f;   // 低置信度区域占比超过该值时回退到常规流程
+    int min_text_height = 8;         // 常规流程输入中可靠检出的文字高度 (像素)，按两遍缩放比换算到快速通道，有文字框更矮时回退
+    float min_coverage = 0.02f;      // 文字框面积占图像比例低于该值时视为可能漏检，回退
+};
+
+/**
+ * @brief 准入控制配置
+ *
+ * 等待分派的请求数有上限；按排在前面的请求数和近期平均处理耗时估计排队时间，
+ * 队列已满或估计无法在截止时间前完成的请求立即拒绝并给出重试等待时间，
+ * 出队时已超过截止时间的请求不再推理。
+ */
+struct AdmissionConfig {
+    int max_queue_depth = 16;     // 每个Worker对应的等待请求数，各优先级类别默认上限为 Worker 数 × 该值，0 表示不限
+    int default_deadline_ms = 0;  // 请求未携带 deadline_ms 时使用的截止时间，0 表示不设截止时间
+};
+
+/**
+ * @brief 准入控制计数
+ */
+struct AdmissionStats {
+    int64_t rejected = 0;  // 入队前拒绝 (队列已满或无法在截止时间前完成)
+    int64_t expired = 0;   // 出队时已超过截止时间而丢弃
+    int64_t cancelled = 0; // 客户端断开或 cancel 命令取消 (含排队中移除和处理中中止)
+};
+
+/**
+ * @brief 级联模式计数
+ */
+struct CascadeStats {
+    int64_t accepted = 0;   // 快速通道 (含低置信度区域复检) 的结果直接采用
+    int64_t fallbacks = 0;  // 判断可能漏检或低置信度区域过多，回退到常规检测
+};
+
+/**
+ * @brief OCR Worker 可选配置
+ */
+struct OCRWorkerConfig {
+    TiledDetConfig tiled_det;  // 长图/大图分块检测
+    CascadeConfig cascade;     // 低分辨率快速通道 + 低置信度区域原图复检
+    std::string det_backend = "paddle";  // 各模型的推理后端: paddle | onnxruntime (需以 PADDLE_OCR_WITH_ORT 编译)
+    std::string cls_backend = "paddle";
+    std::string rec_backend = "paddle";
+    std::string cpu_precision = "auto";  // CPU检测/识别精度: auto | fp32 | bf16 | int8 (int8需先用 scripts/quantize_models.py 生成模型)
+    bool buffer_pool = true;   // 安装池化 cv::Mat 分配器 (进程级，任一Worker启用即生效)
+    ReducedDecodeConfig reduced_decode;  // image_path 请求的大尺寸 JPEG 缩小解码 (服务级)
+    ResultCacheConfig result_cache;      // 按图像内容寻址的结果缓存 (服务级)
+    RecCacheConfig rec_cache;            // 文字区域识别缓存 (进程级，任一Worker启用即生效)
+    std::string templates_path;          // 版面模板文件，请求可按名称选用以跳过检测 (服务级)
+    AdmissionConfig admission;           // 队列上限与截止时间 (Worker池级)
+    SchedulerConfig scheduling;          // 优先级类别与加权公平调度 (Worker池级)
+    HedgingConfig hedging;               // 慢请求在空闲Worker上对冲执行 (Worker池级)
+};
+
+/**
+ * @brief 请求执行的流水线阶段
+ */
+enum class OCRTask {
+    Recognize,         // 检测 + 识别
+    Detect,            // 只检测，返回文字框
+    RecognizeRegions,  // 只识别调用方给定的文字框
+};
+
 /**
  * @brief OCR 任务请求结构
  */
@@ -23,16 +112,68 @@ struct OCRRequest {
     int request_id;
     cv::Mat image_data;                 // 统一使用cv::Mat存储图像数据
     std::promise<std::string> result_promise;
+    std::shared_ptr<const ReducedImageSource> reduced_source;  // image_data 为缩小解码时非空，结果坐标按原图输出 (仅用于无 rois 的 Recognize)
+    std::shared_ptr<const LayoutTemplate> layout;              // 非空时跳过检测，只识别模板字段区域
+    OCRTask task = OCRTask::Recognize;
+    std::vector<cv::Rect> rois;        // 非空时只在这些区域内检测 (Recognize/Detect)，坐标为请求图像像素
+    std::vector<Quad> regions;         // RecognizeRegions 任务的文字框，结果与之一一对应
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();  // 超过后不再处理
+    std::shared_ptr<CancellationToken> cancel_token;  // 非空且已置位时移出队列或在阶段之间中止
+    int priority_class = 0;            // SchedulerConfig::classes 的下标
+    std::string client_id;             // 同一类别内按客户端公平分配
+    std::chrono::steady_clock::time_point submit_time = std::chrono::steady_clock::now();
+    double predicted_ms = 0.0;         // 入队时由代价模型预测的处理耗时
+    double service_ms = 0.0;           // 实际处理耗时，成功处理后由 Worker 填写
+    int box_count = -1;                // 实际文字框数，成功处理后由 Worker 填写，用于更新代价模型
+    int64_t shape_key = 0;             // 推理输入形状 (ShapeAffinity 键)，0 表示无法预知
+    std::shared_ptr<OCRRequest> hedge_of;  // 非空表示这是该请求的对冲副本，结果交给原请求
+    std::atomic<bool> result_set{false};
+    bool delivered = false;            // 本请求给出的结果是否被采用 (对冲时先完成者被采用)
     
     // 构造函数：使用cv::Mat（worker只需要处理这一种情况）
+    // 调用方仍持有该图像时深拷贝，避免处理期间被外部修改
     OCRRequest(int id, const cv::Mat& img) 
         : request_id(id), image_data(img.clone()) {}
+    
+    // 转移所有权：解码得到的新图像直接交给worker，像素不再拷贝
+    OCRRequest(int id, cv::Mat&& img)
+        : request_id(id), image_data(std::move(img)) {}
+    
+    /**
+     * @brief 给出响应；对冲副本写入原请求，原请求与副本先调用者生效，之后的调用被忽略
+     * @return 该响应是否被采用
+     */
+    bool setResult(const std::string& json);
+};
+
+/**
+ * @brief 创建对冲副本：共享图像像素和请求参数，取消标记为原请求的子标记
+ * 原请求须在分派前就有取消标记，以便副本先完成时取消原请求
+ */
+std::shared_ptr<OCRRequest> makeHedgeRequest(const std::shared_ptr<OCRRequest>& primary);
+
+/**
+ * @brief 分块检测子任务
+ * 由发起请求的Worker创建，可分发给空闲Worker执行；先认领者执行，保证每块只检测一次
+ */
+struct DetTileTask {
+    cv::Mat tile;                        // 原图上的分块视图（不拷贝像素）
+    int limit_side_len = 0;              // 分块检测的边长上限，保持原始分辨率
+    std::atomic<bool> claimed{false};
+    std::vector<Quad> boxes;             // 分块坐标系下的检测框
+    std::promise<void> done;
+
+    bool claim() {
+        bool expected = false;
+        return claimed.compare_exchange_strong(expected, true);
+    }
 };
 
 struct WordResult {
     std::string text;  // 识别的文本
-    std::vector<std::vector<int>> box;  // 文本框坐标
+    Quad box;                           // 文本框四个角点，左上起顺时针
     float confidence;  // 置信度
+    std::string field;  // 版面模板的字段名，检测模式下为空
 };
 
 /**
@@ -46,6 +187,7 @@ struct OCRResult {
     std::string error_message;
     std::vector<WordResult> words;
     double processing_time_ms;
+    bool boxes_only = false;  // Detect 任务：只输出 boxes，不输出 words
 };
 
 /**
@@ -54,15 +196,64 @@ struct OCRResult {
  */
 class OCRWorker {
 public:
-    OCRWorker(int worker_id, const std::string& model_dir, bool use_gpu, int gpu_id = 0, bool enable_cls = false);
+    OCRWorker(int worker_id, const std::string& model_dir, bool use_gpu, int gpu_id = 0, bool enable_cls = false,
+              const OCRWorkerConfig& config = OCRWorkerConfig());
     virtual ~OCRWorker();
     
     void start();
     void stop();
     void addRequest(std::shared_ptr<OCRRequest> request);
+    void addTileTask(std::shared_ptr<DetTileTask> task);
     bool isIdle() const { return is_idle_; }
+    
+    /**
+     * @brief 已加入队列但尚未完成 (含正在处理) 的请求数
+     */
+    int pendingRequests() const { return pending_requests_; }
+    
+    /**
+     * @brief 近期平均每个请求的处理耗时 (毫秒)，尚无完成的请求时为 0
+     */
+    double averageServiceMs() const { return avg_service_ms_; }
+    
+    /**
+     * @brief 出队时已超过截止时间而被丢弃的请求数
+     */
+    int64_t getExpiredCount() const { return expired_requests_; }
+    
+    /**
+     * @brief 已取消的请求数 (排队中移除和处理中中止)
+     */
+    int64_t getCancelledCount() const { return cancelled_requests_; }
+    
+    /**
+     * @brief 级联模式下快速通道结果被采用与回退的次数
+     */
+    CascadeStats getCascadeStats() const { return {cascade_accepted_.load(), cascade_fallbacks_.load()}; }
+    
+    /**
+     * @brief 缩小解码的请求因文字过矮而重新解码 (1/2、1/4 或原图) 的次数
+     */
+    int64_t getRedecodeCount() const { return redecodes_; }
+    
+    /**
+     * @brief 把队列中已取消的请求移出队列并立即给出取消响应，移出的请求追加到 removed
+     */
+    void removeCancelled(std::vector<std::shared_ptr<OCRRequest>>& removed);
     int getWorkerId() const { return worker_id_; }
     
+    /**
+     * @brief 请求第一次推理的输入形状 (ShapeAffinity 键)：整图检测为检测输入尺寸，
+     * 跳过检测的请求为最宽文字框的识别批宽度；分块检测等无法预知时为 0
+     */
+    int64_t shapeKey(const OCRRequest& request) const;
+    
+    /**
+     * @brief 检测/识别模型实际使用的推理精度 (已计入硬件和模型文件导致的回退)
+     */
+    std::string getDetPrecision() const { return detector_->effective_precision(); }
+    std::string getRecPrecision() const { return recognizer_->effective_precision(); }
+    
     /**
      * @brief 获取系统CPU信息和建议的Worker数量
      * @param use_gpu 是否使用GPU模式
@@ -71,19 +262,68 @@ public:
      */
     static std::string getWorkerRecommendation(bool use_gpu, bool enable_cls = false);
     
+    /**
+     * @brief 设置同一Worker池中的其他Worker，分块检测时把分块分发给其中空闲的Worker
+     */
+    void setPeers(const std::vector<OCRWorker*>& peers) { peers_ = peers; }
+    
+    /**
+     * @brief 每个请求给出响应后在 Worker 线程上回调 (此时 pendingRequests 已减一)，Worker池据此分派下一个请求
+     */
+    void setCompletionCallback(std::function<void(const OCRRequest&)> callback) { completion_callback_ = std::move(callback); }
+    
+    /**
+     * @brief 把处理结果序列化为响应 JSON，与原 Json::Value + StreamWriterBuilder 输出逐字节一致
+     * @param writer 调用方复用的写入器，函数开头会清空
+     */
+    static void writeResultJson(const OCRResult& result, int worker_id, JsonWriter& writer);
+    
+    /**
+     * @brief 处理过程抛出异常时的错误响应 JSON
+     */
+    static void writeErrorJson(int request_id, const std::string& error, int worker_id, JsonWriter& writer);
+    
+    /**
+     * @brief 准入控制拒绝请求时的响应 JSON，retry_after_ms 为建议的重试等待时间
+     */
+    static void writeRejectJson(int request_id, const std::string& error, int retry_after_ms, JsonWriter& writer);
+    
 private:
     void workerLoop();
     OCRResult processRequest(const OCRRequest& request);
+    void runTileTask(DetTileTask& task);
+    void detectTiled(const cv::Mat& image, std::vector<Quad>& boxes);
+    void detectFull(const cv::Mat& image, std::vector<Quad>& boxes);
+    void recognizeBoxes(const cv::Mat& image, const std::vector<Quad>& boxes,
+                        std::vector<WordResult>& words);
+    bool runCascade(const cv::Mat& image, std::vector<WordResult>& words);
+    void recognizeLayout(const cv::Mat& image, const LayoutTemplate& layout, std::vector<WordResult>& words);
+    void recognizeRegions(const cv::Mat& image, const std::vector<Quad>& regions, std::vector<WordResult>& words);
+    void detectRois(const cv::Mat& image, const std::vector<cv::Rect>& rois, std::vector<Quad>& boxes);
+    void throwIfCancelled() const;
+    void restoreFullResolution(const ReducedImageSource& source, std::vector<WordResult>& words);
     
     int worker_id_;
     bool use_gpu_;
     int gpu_id_;
     bool enable_cls_;  // 是否启用文本方向分类
+    OCRWorkerConfig config_;
     std::atomic<bool> running_;
     std::atomic<bool> is_idle_;
+    std::atomic<int> pending_requests_{0};
+    std::atomic<double> avg_service_ms_{0.0};   // 请求处理耗时的指数滑动平均
+    std::atomic<int64_t> expired_requests_{0};
+    std::atomic<int64_t> cancelled_requests_{0};
+    std::atomic<int64_t> cascade_accepted_{0};
+    std::atomic<int64_t> cascade_fallbacks_{0};
+    std::atomic<int64_t> redecodes_{0};
+    const CancellationToken* active_cancel_ = nullptr;  // 正在处理的请求的取消标记，仅 Worker 线程访问
+    std::function<void(const OCRRequest&)> completion_callback_;
     
     std::thread worker_thread_;
-    std::queue<std::shared_ptr<OCRRequest>> request_queue_;
+    std::deque<std::shared_ptr<OCRRequest>> request_queue_;  // 已取消的请求可从中间移除
+    std::queue<std::shared_ptr<DetTileTask>> tile_queue_;  // 其他Worker分发来的分块，优先于整图请求执行
+    std::vector<OCRWorker*> peers_;
     std::mutex queue_mutex_;
     std::condition_variable cv_;
     
@@ -91,6 +331,8 @@ private:
     std::unique_ptr<DBDetector> detector_;
     std::unique_ptr<Classifier> classifier_;
     std::unique_ptr<CRNNRecognizer> recognizer_;
+    RecPerspectiveCrop crop_op_;  // 所有框并行裁剪，只读取框所在区域
+    JsonWriter result_writer_;    // 结果序列化缓冲区，跨请求复用
 };
 
 } // namespace PaddleOCR
@@ -20,42 +20,37 @@ namespace PaddleOCR {
 
 class DBPostProcessor {
 public:
-  void GetContourArea(const std::vector<std::vector<float>> &box,
-                      float unclip_ratio, float &distance) noexcept;
+  // Corners of a rotated rect, float precision, before rounding to a Quad
+  using MiniBox = std::array<cv::Point2f, 4>;
 
-  cv::RotatedRect UnClip(const std::vector<std::vector<float>> &box,
+  void GetContourArea(const MiniBox &box, float unclip_ratio,
+                      float &distance) noexcept;
+
+  cv::RotatedRect UnClip(const MiniBox &box,
                          const float &unclip_ratio) noexcept;
 
   float **Mat2Vec(const cv::Mat &mat) noexcept;
 
-  std::vector<std::vector<int>>
-  OrderPointsClockwise(const std::vector<std::vector<int>> &pts) noexcept;
+  Quad OrderPointsClockwise(const Quad &pts) noexcept;
 
-  std::vector<std::vector<float>> GetMiniBoxes(const cv::RotatedRect &box,
-                                               float &ssid) noexcept;
+  MiniBox GetMiniBoxes(const cv::RotatedRect &box, float &ssid) noexcept;
 
-  float BoxScoreFast(const std::vector<std::vector<float>> &box_array,
-                     const cv::Mat &pred) noexcept;
+  float BoxScoreFast(const MiniBox &box_array, const cv::Mat &pred) noexcept;
   float PolygonScoreAcc(const std::vector<cv::Point> &contour,
                         const cv::Mat &pred) noexcept;
 
-  std::vector<std::vector<std::vector<int>>>
-  BoxesFromBitmap(const cv::Mat &pred, const cv::Mat &bitmap,
-                  const float &box_thresh, const float &det_db_unclip_ratio,
-                  const std::string &det_db_score_mode) noexcept;
+  std::vector<Quad> BoxesFromBitmap(const cv::Mat &pred, const cv::Mat &bitmap,
+                                    const float &box_thresh,
+                                    const float &det_db_unclip_ratio,
+                                    const std::string &det_db_score_mode) noexcept;
 
-  void FilterTagDetRes(std::vector<std::vector<std::vector<int>>> &boxes,
-                       float ratio_h, float ratio_w,
+  void FilterTagDetRes(std::vector<Quad> &boxes, float ratio_h, float ratio_w,
                        const cv::Mat &srcimg) noexcept;
 
 private:
-  static bool XsortInt(const std::vector<int> &a,
-                       const std::vector<int> &b) noexcept;
-
-  static bool XsortFp32(const std::vector<float> &a,
-                        const std::vector<float> &b) noexcept;
+  static bool XsortInt(const cv::Point &a, const cv::Point &b) noexcept;
 
-  std::vector<std::vector<float>> Mat2Vector(const cv::Mat &mat) noexcept;
+  static bool XsortFp32(const cv::Point2f &a, const cv::Point2f &b) noexcept;
 
   inline int _max(int a, int b) const noexcept { return a >= b ? a : b; }
 
@@ -78,6 +73,32 @@ private:
   }
 };
 
+// Greedy CTC decoder for the recognizer output. Each timestep row is scanned
+// once by a fused argmax + max kernel (SSE2 when available, first index wins
+// on ties like std::max_element), repeated labels and the blank (index 0)
+// are dropped, and the UTF-8 text is built in a buffer reserved up front.
+class CTCGreedyDecoder {
+public:
+  void init(const std::vector<std::string> &label_list) noexcept;
+
+  // Decodes one sequence of time_steps x num_classes probabilities.
+  // Returns false when no character survives (score would be undefined).
+  // char_scores / char_positions, when given, receive the probability and
+  // timestep of every emitted character.
+  bool Run(const float *probs, int time_steps, int num_classes,
+           std::string &text, float &score,
+           std::vector<float> *char_scores = nullptr,
+           std::vector<int> *char_positions = nullptr) const noexcept;
+
+  // Index of the first maximum of row[0, n) and its value.
+  static int ArgMax(const float *row, int n, float &max_value) noexcept;
+
+private:
+  std::string label_bytes_;               // all labels back to back
+  std::vector<uint32_t> label_offsets_;   // label i = [offsets[i], offsets[i+1])
+  size_t max_label_len_ = 0;
+};
+
 class TablePostProcessor {
 public:
   void init(const std::string &label_path,
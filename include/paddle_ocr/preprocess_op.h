@@ -15,6 +15,7 @@
 #pragma once
 
 #include <opencv2/imgproc.hpp>
+#include <paddle_ocr/utility.h>
 
 namespace PaddleOCR {
 
@@ -41,6 +42,11 @@ public:
   virtual void Run(const cv::Mat &img, cv::Mat &resize_img,
                    const std::string &limit_type, int limit_side_len,
                    float &ratio_h, float &ratio_w, bool use_tensorrt) noexcept;
+
+  // Size Run resizes an image of the given size to (multiples of 32)
+  static cv::Size TargetSize(const cv::Size &size,
+                             const std::string &limit_type,
+                             int limit_side_len) noexcept;
 };
 
 class CrnnResizeImg {
@@ -70,6 +76,34 @@ public:
                    const int max_len = 488) noexcept;
 };
 
+// Fused normalize + HWC->CHW for one 8-bit image written straight into a
+// batch tensor slot of width dst_w; columns beyond im.cols get the
+// normalized value of a zero pixel, same as CrnnResizeImg's padding.
+class NormalizePermute {
+public:
+  virtual void Run(const cv::Mat &im, const std::vector<float> &mean,
+                   const std::vector<float> &scale, const bool is_scale,
+                   float *data, int dst_w) noexcept;
+
+private:
+  // lookup tables are rebuilt only when the normalization changes
+  std::vector<float> lut_;
+  std::vector<float> lut_mean_;
+  std::vector<float> lut_scale_;
+  bool lut_is_scale_ = false;
+};
+
+// One perspective warp per text box, straight from the source quad to the
+// recognizer input height. Only the bounding rect of each box is read from
+// the source image and all boxes are warped in parallel. Tall boxes
+// (h >= 1.5 * w) are rotated 90 degrees like Utility::GetRotateCropImage.
+// target_h <= 0 keeps the native box height.
+class RecPerspectiveCrop {
+public:
+  virtual void Run(const cv::Mat &srcimage, const std::vector<Quad> &boxes,
+                   int target_h, std::vector<cv::Mat> &crops) noexcept;
+};
+
 class Resize {
 public:
   virtual void Run(const cv::Mat &img, cv::Mat &resize_img, const int h,
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace PaddleOCR {
+
+/**
+ * @brief 识别批次规划配置
+ */
+struct RecBatchPlannerConfig {
+    int max_batch = 16;              // 单批最大图像数
+    int width_bucket = 64;           // 批宽度向上取整的粒度，减少输入形状种类以复用已编译的kernel
+    int max_batch_width = 1600;      // 多图批次的宽度上限，超出的超长文本行单独成批
+    int batch_overhead = 320;        // 每个批次的固定开销，折算为一张图的列数
+};
+
+/**
+ * @brief 一个识别批次，对应排序后下标 [begin, end)
+ */
+struct RecBatch {
+    size_t begin;
+    size_t end;
+    int width;   // 批内所有图像填充到的宽度
+};
+
+/**
+ * @brief 识别批次填充统计快照
+ */
+struct RecBatchStatsSnapshot {
+    long long batches = 0;
+    long long images = 0;
+    long long useful_columns = 0;     // 图像实际内容列数之和
+    long long padded_columns = 0;     // 填充后输入张量列数之和
+    long long fixed_chunk_columns = 0; // 按固定 max_batch 切分时的填充后列数，用于估算节省量
+};
+
+/**
+ * @brief 识别批次规划器
+ *
+ * 图像按宽度升序排列后，用动态规划选择切分点，使 (填充后总面积 + 批次开销) 最小：
+ * 一条超长文本行不再拖累同批的其他短行。
+ */
+class RecBatchPlanner {
+public:
+    /**
+     * @brief 规划批次
+     * @param sorted_widths 按升序排列的图像宽度 (缩放到识别高度后)
+     * @param min_width 批宽度下限 (识别器默认输入宽度)
+     * @param config 规划配置
+     */
+    static std::vector<RecBatch> plan(const std::vector<int>& sorted_widths, int min_width,
+                                      const RecBatchPlannerConfig& config);
+
+    /**
+     * @brief 批宽度按 width_bucket 向上取整，且不小于 min_width
+     */
+    static int bucketWidth(int width, int min_width, int width_bucket);
+
+    /**
+     * @brief 记录一次 Run 的填充情况，供服务状态接口汇总
+     */
+    static void record(const std::vector<int>& sorted_widths, const std::vector<RecBatch>& batches,
+                       int min_width, const RecBatchPlannerConfig& config);
+
+    /**
+     * @brief 进程内所有识别器的累计填充统计
+     */
+    static RecBatchStatsSnapshot stats();
+
+private:
+    static std::atomic<long long> total_batches_;
+    static std::atomic<long long> total_images_;
+    static std::atomic<long long> useful_columns_;
+    static std::atomic<long long> padded_columns_;
+    static std::atomic<long long> fixed_chunk_columns_;
+};
+
+} // namespace PaddleOCR
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <opencv2/core.hpp>
+
+namespace PaddleOCR {
+
+/**
+ * @brief 识别缓存配置
+ */
+struct RecCacheConfig {
+    bool enabled = false;                  // 是否启用识别缓存
+    size_t max_bytes = size_t(8) << 20;    // 缩略图与文本的总内存上限
+    float min_score = 0.9f;                // 只缓存置信度不低于该值的识别结果
+    int max_outliers = 2;                  // 每个字符宽的窗口内差异像素 (差值超过一半灰度) 的上限，总数上限按缩略图面积放大
+};
+
+/**
+ * @brief 识别缓存统计快照
+ */
+struct RecCacheStats {
+    long long lookups = 0;
+    long long hits = 0;
+    long long rejected = 0;   // 同宽度桶内有候选但宽高比或缩略图校验均不通过
+    long long inserts = 0;
+    long long evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+/**
+ * @brief 文字区域识别缓存 (进程级，所有 Worker 共享)
+ *
+ * 卡证模板上的固定标签 ("姓名"、"卡号"、表头、logo 等) 每张图都会出现。识别前把裁剪图
+ * Otsu 二值化 (与亮度、底色无关)，裁到文字墨迹外接框 (消除检测框的位置抖动)，再缩放为固定
+ * 高度的缩略图。缩略图宽度作为桶键，桶内要求墨迹宽高比一致 (相差不超过一列)，再逐个比对缩略图：
+ * 任一字符宽的窗口内差异像素不超过 max_outliers、且总数不超过按面积放大的上限时，直接返回缓存
+ * 的文本和置信度，只有变化的字段送入识别模型。宁可漏判也不误判：单个字符不同的文本在该字符处
+ * 有成片的像素反转，长文本的容差不会被一个字符的差异用掉；缩略图宽度超过上限的长文本不缓存。
+ * 按 LRU 淘汰，内存占用不超过 max_bytes。
+ */
+class RecognitionCache {
+public:
+    /**
+     * @brief 裁剪图的归一化指纹
+     */
+    struct Fingerprint {
+        int width = 0;               // 缩略图宽度，按墨迹宽高比缩放并取 4 的倍数；0 表示无文字或过长不缓存
+        float aspect = 0.0f;         // 墨迹外接框的精确宽高比
+        std::vector<uchar> thumb;    // kThumbHeight x width 缩略图，墨迹为 255
+    };
+
+    static constexpr int kThumbHeight = 16;
+
+    static RecognitionCache& instance();
+
+    /**
+     * @brief 设置配置并启用；Worker 构造时调用 (各 Worker 配置相同)；未启用的配置被忽略
+     */
+    void configure(const RecCacheConfig& config);
+
+    bool enabled() const;
+
+    /**
+     * @brief 计算裁剪图指纹 (BGR 或灰度)
+     */
+    static Fingerprint fingerprint(const cv::Mat& crop);
+
+    /**
+     * @brief 查找近似相同的裁剪图的识别结果
+     */
+    bool lookup(const Fingerprint& fingerprint, std::string& text, float& score);
+
+    /**
+     * @brief 缓存识别结果；置信度低于 min_score 时忽略
+     */
+    void insert(Fingerprint&& fingerprint, const std::string& text, float score);
+
+    RecCacheStats stats() const;
+
+    /**
+     * @brief 清空缓存和统计 (供测试)
+     */
+    void clear();
+
+private:
+    RecognitionCache() = default;
+
+    struct Entry {
+        Fingerprint fingerprint;
+        std::string text;
+        float score = 0.0f;
+
+        size_t bytes() const { return fingerprint.thumb.size() + text.size() + sizeof(Entry); }
+    };
+
+    using EntryIt = std::list<Entry>::iterator;
+
+    bool matchLocked(const Entry& entry, const Fingerprint& fingerprint) const;
+    EntryIt findLocked(const Fingerprint& fingerprint);
+    void eraseLocked(EntryIt it);
+
+    mutable std::mutex mutex_;
+    bool enabled_ = false;
+    RecCacheConfig config_;
+    std::list<Entry> lru_;  // 头部为最近使用
+    std::unordered_map<int, std::vector<EntryIt>> buckets_;  // 缩略图宽度 -> 条目
+    size_t bytes_ = 0;
+    RecCacheStats stats_;
+};
+
+} // namespace PaddleOCR
@@ -0,0 +1,332 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace PaddleOCR {
+
+struct OCRRequest;
+
+/**
+ * @brief 优先级类别
+ */
+struct PriorityClassConfig {
+    std::string name;
+    int weight = 1;           // 各类别都有积压时按权重比例分配 Worker
+    int max_queue_depth = 0;  // 该类别等待分派的请求上限，0 表示按 Worker 数 × AdmissionConfig::max_queue_depth
+};
+
+/**
+ * @brief Worker池请求调度配置
+ */
+struct SchedulerConfig {
+    // 第一个类别为请求未指定 priority 时的默认类别
+    std::vector<PriorityClassConfig> classes = {{"interactive", 8, 0}, {"bulk", 1, 0}};
+    bool shortest_job_first = true;  // 类别内按预测耗时优先分派小请求，关闭时按请求数公平轮转
+    double aging = 0.5;              // 每等待 1 ms，请求的调度代价减少的毫秒数，防止大请求饿死
+    bool shape_affinity = true;      // 有多个空闲Worker时交给最近处理过同一输入形状的Worker
+
+    /**
+     * @brief 按名称查找类别
+     * @return 类别下标，不存在时返回 -1
+     */
+    int findClass(std::string_view name) const;
+
+    /**
+     * @brief 解析命令行的类别列表，如 "interactive:8,bulk:1:2000" (名称:权重[:队列上限])
+     */
+    static bool parse(const std::string& spec, SchedulerConfig& config, std::string& error);
+};
+
+/**
+ * @brief 单个优先级类别的统计快照
+ */
+struct PriorityClassStats {
+    std::string name;
+    int weight = 0;
+    int max_queue_depth = 0;
+    size_t queued = 0;          // 当前等待分派的请求数
+    int64_t dispatched = 0;     // 已分派给 Worker
+    int64_t rejected = 0;       // 队列已满或无法按时完成而拒绝
+    int64_t completed = 0;      // 已完成 (含出错、超时和取消)
+    double p50_ms = 0.0;        // 近期请求从提交到完成的延迟分位数
+    double p99_ms = 0.0;
+};
+
+/**
+ * @brief 代价模型的统计快照
+ */
+struct CostModelStats {
+    int64_t samples = 0;              // 参与拟合的已完成请求数
+    double base_ms = 0.0;             // 固定开销
+    double ms_per_megapixel = 0.0;    // 检测每百万像素耗时
+    double ms_per_box = 0.0;          // 识别每个文字框耗时
+    double boxes_per_megapixel = 0.0; // 整图识别时估计文字框数用
+    double mean_abs_error_ms = 0.0;   // 近期预测误差
+};
+
+/**
+ * @brief 请求处理耗时的在线代价模型
+ *
+ * 耗时 ≈ 固定开销 + 检测面积 (百万像素) × 每百万像素耗时 + 文字框数 × 每框耗时，
+ * 系数由已完成请求的实际耗时做指数加权岭回归在线拟合，随负载和缓存命中率变化。
+ * 整图识别的文字框数处理前未知，按近期每百万像素的平均文字框数估计。
+ */
+class CostModel {
+public:
+    /**
+     * @brief 预测处理耗时 (毫秒)；样本不足时返回近期平均耗时，尚无样本时返回 kDefaultCostMs
+     */
+    double predict(const OCRRequest& request) const;
+
+    /**
+     * @brief 用成功处理的请求 (service_ms 和 box_count 已填写) 更新模型
+     */
+    void update(const OCRRequest& request);
+
+    /**
+     * @brief 样本是否足以按请求尺寸区分耗时
+     */
+    bool ready() const { return samples_ >= kMinSamples; }
+
+    CostModelStats stats() const;
+
+    static constexpr double kDefaultCostMs = 100.0;
+
+private:
+    struct Features {
+        double megapixels = 0.0;  // 需要检测的面积
+        double boxes = 0.0;       // 需要识别的文字框数
+    };
+
+    // observed 为 true 时整图识别使用实际文字框数，否则使用估计值
+    Features featuresOf(const OCRRequest& request, bool observed) const;
+
+    static constexpr int64_t kMinSamples = 8;
+    static constexpr double kDecay = 0.99;  // 约按最近 100 个请求拟合
+
+    double xtx_[3][3] = {};   // 加权 XᵀX，特征为 [1, 百万像素, 文字框数]
+    double xty_[3] = {};
+    double coef_[3] = {};
+    double box_sum_ = 0.0;    // 整图识别的加权文字框数与面积，估计文字框密度
+    double area_sum_ = 0.0;
+    double mean_ms_ = 0.0;
+    double abs_error_ms_ = 0.0;
+    int64_t samples_ = 0;
+};
+
+/**
+ * @brief 对冲执行配置
+ */
+struct HedgingConfig {
+    double percentile = 0.0;  // 处理时间超过近期该百分位 (按预测耗时归一) 且有空闲Worker时对冲，0 表示关闭
+    int min_samples = 20;     // 已完成请求少于该数时不对冲
+};
+
+/**
+ * @brief 对冲计数，对冲率 = launched / dispatched，胜率 = wins / launched
+ */
+struct HedgingStats {
+    int64_t dispatched = 0;  // 分派给Worker的请求 (不含对冲副本)
+    int64_t launched = 0;    // 发起的对冲
+    int64_t wins = 0;        // 对冲副本先于原请求完成
+};
+
+/**
+ * @brief 对冲阈值
+ *
+ * 记录近期请求 实际耗时/预测耗时 的比值，请求处理时间超过 预测耗时 × 比值的百分位 时视为慢请求。
+ * 按比值而不是绝对耗时判断，大图不会仅因尺寸大而被对冲，首次遇到新尺寸或被其他进程抢占
+ * 而异常慢的请求才会。
+ */
+class HedgePolicy {
+public:
+    explicit HedgePolicy(const HedgingConfig& config) : config_(config) {}
+
+    bool enabled() const { return config_.percentile > 0.0; }
+
+    /**
+     * @brief 记录成功处理的请求
+     */
+    void record(const OCRRequest& request);
+
+    /**
+     * @brief 处理超过该时间 (毫秒) 仍未完成时对冲，样本不足时返回负数
+     */
+    double thresholdMs(const OCRRequest& request) const;
+
+private:
+    static constexpr size_t kWindow = 256;
+
+    HedgingConfig config_;
+    std::vector<double> ratios_;  // 最近 kWindow 个比值，环形覆盖
+    size_t next_ = 0;
+    int64_t samples_ = 0;
+    double quantile_ = 0.0;       // 每次记录后重新计算
+};
+
+/**
+ * @brief 单个Worker的输入形状缓存统计
+ */
+struct WorkerShapeStats {
+    int worker_id = 0;
+    int64_t requests = 0;  // 有形状键的请求
+    int64_t hits = 0;      // 分派时该形状仍在Worker最近处理过的形状中
+    double hit_rate = 0.0;
+};
+
+/**
+ * @brief 按输入形状把请求交给预热过该形状的Worker
+ *
+ * 每个Worker的推理引擎按输入形状缓存已编译的 oneDNN primitive (检测、识别各 10 个)，
+ * 轮询分派会让每个Worker都编译一遍所有形状，并互相挤出缓存。这里为每个Worker按形状类别
+ * 各记录最近处理过的形状 (与引擎缓存同容量的 LRU)，有多个空闲Worker时交给最近处理过
+ * 同一形状的那个，没有时交给任一空闲Worker。命中率按该 LRU 估算。
+ */
+class ShapeAffinity {
+public:
+    ShapeAffinity(size_t workers, size_t capacity);
+
+    /**
+     * @brief 检测输入尺寸对应的形状键
+     */
+    static int64_t detKey(int height, int width);
+
+    /**
+     * @brief 识别批宽度对应的形状键
+     */
+    static int64_t recKey(int width);
+
+    /**
+     * @brief 从空闲Worker中选择
+     * @param idle 候选Worker下标，按优先顺序排列
+     * @param shape_key 形状键，0 表示无法预知形状
+     * @return idle 中被选中的位置，没有Worker处理过该形状时为 0
+     */
+    size_t choose(int64_t shape_key, const std::vector<size_t>& idle) const;
+
+    /**
+     * @brief 记录请求交给了该Worker，统计命中并更新其最近形状
+     */
+    void record(size_t worker, int64_t shape_key);
+
+    std::vector<WorkerShapeStats> stats() const;
+
+private:
+    struct Entry {
+        int64_t key;
+        uint64_t stamp;  // 越大越新
+    };
+
+    struct WorkerState {
+        std::vector<Entry> recent;  // 各形状类别最多 capacity_ 个
+        int64_t requests = 0;
+        int64_t hits = 0;
+    };
+
+    std::vector<WorkerState> workers_;
+    size_t capacity_;
+    uint64_t clock_ = 0;
+};
+
+/**
+ * @brief 两级加权公平队列
+ *
+ * 请求先按优先级类别、再按客户端 (client_id，默认每个连接一个) 分流。Worker 空闲时
+ * 取虚拟时间最小的类别，再在该类别中取"客户端虚拟时间 + 请求代价"最小的请求；每分派
+ * 一个请求，类别虚拟时间增加 代价/权重，客户端虚拟时间增加 代价。重新出现积压的类别/客户端
+ * 从当前虚拟时间起算，空闲期间不积累额度。因此交互类请求按权重优先，批量任务只占用剩余
+ * 容量，同一类别内提交大量请求的客户端也不会挤占其他客户端。
+ *
+ * 开启 shortest_job_first 时代价为 CostModel 预测的耗时减去 等待时间 × aging：同时积压的
+ * 客户端中小请求先分派，降低混合负载的平均延迟，大请求等待越久越靠前，不会饿死。
+ * 关闭时每个请求代价为 1，客户端内按提交顺序分派。
+ *
+ * 不加锁，由所属 Worker 池在其互斥锁内调用。
+ */
+class RequestScheduler {
+public:
+    /**
+     * @param default_queue_depth 未单独配置队列上限的类别使用的上限，0 表示不限
+     */
+    RequestScheduler(const SchedulerConfig& config, int default_queue_depth);
+
+    size_t queued() const { return queued_; }
+
+    /**
+     * @brief 该类别的等待队列是否已满
+     */
+    bool full(int priority_class) const;
+
+    /**
+     * @brief 按各类别权重估计新的 priority_class 请求之前会被分派的请求数
+     */
+    size_t queuedAhead(int priority_class) const;
+
+    void push(std::shared_ptr<OCRRequest> request);
+
+    /**
+     * @brief 取出下一个应分派的请求，队列为空时返回 nullptr
+     */
+    std::shared_ptr<OCRRequest> pop();
+
+    /**
+     * @brief 移出已取消的请求
+     */
+    void removeCancelled(std::vector<std::shared_ptr<OCRRequest>>& removed);
+
+    void recordRejected(int priority_class);
+
+    /**
+     * @brief 记录延迟，成功处理的请求同时用于更新代价模型
+     */
+    void recordCompleted(const OCRRequest& request);
+
+    std::vector<PriorityClassStats> stats() const;
+
+    const CostModel& costModel() const { return cost_model_; }
+
+private:
+    struct Flow {
+        std::deque<std::shared_ptr<OCRRequest>> queue;
+        double vtime = 0.0;
+    };
+
+    struct ClassState {
+        PriorityClassConfig config;
+        std::unordered_map<std::string, Flow> flows;  // client_id -> 该客户端的等待队列
+        double vtime = 0.0;
+        double flow_vtime = 0.0;  // 类别内的虚拟时间，新出现积压的客户端从这里起算
+        size_t queued = 0;
+        int64_t dispatched = 0;
+        int64_t rejected = 0;
+        int64_t completed = 0;
+        std::vector<double> latencies_ms;  // 最近 kLatencyWindow 个请求的延迟，环形覆盖
+        size_t latency_next = 0;
+    };
+
+    static constexpr size_t kLatencyWindow = 1024;
+
+    // 越界的类别下标归入默认类别
+    ClassState& classAt(int priority_class);
+    const ClassState& classAt(int priority_class) const;
+
+    // 请求的调度代价，越小越先分派
+    double costOf(const OCRRequest& request) const;
+    double agedCost(const OCRRequest& request, std::chrono::steady_clock::time_point now) const;
+
+    std::vector<ClassState> classes_;
+    double virtual_time_ = 0.0;  // 最近一次分派的类别虚拟时间
+    size_t queued_ = 0;
+    bool shortest_job_first_;
+    double aging_;
+    CostModel cost_model_;
+};
+
+} // namespace PaddleOCR
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "cancellation.h"
+
+namespace PaddleOCR {
+
+/**
+ * @brief 识别结果缓存配置 (服务级)
+ */
+struct ResultCacheConfig {
+    bool enabled = false;                   // 是否启用结果缓存
+    size_t max_entries = 1024;              // 最多缓存的结果数
+    size_t max_bytes = size_t(64) << 20;    // 缓存结果 JSON 的总字节上限
+    int ttl_seconds = 300;                  // 结果有效期 (秒)，<= 0 表示不过期
+};
+
+/**
+ * @brief 结果缓存统计快照
+ */
+struct ResultCacheStats {
+    long long hits = 0;          // 直接命中缓存
+    long long misses = 0;        // 未命中，实际提交了计算
+    long long coalesced = 0;     // 与正在进行的相同请求合并，未占用 Worker
+    long long evictions = 0;     // 因条数/字节上限淘汰
+    long long expirations = 0;   // 因过期删除
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+/**
+ * @brief 按图像内容寻址的识别结果缓存
+ *
+ * 键为请求图像编码字节 (Base64 文本或文件内容) 的 64 位哈希加长度。只缓存成功的结果，
+ * LRU 淘汰并受条数、字节数和有效期限制。相同键的并发请求只计算一次 (singleflight)：
+ * 后到的请求等待首个请求的结果，不再占用 Worker。只有成功的结果会分给合并进来的请求；
+ * 首个请求失败 (如超过它自己的截止时间或被取消) 时，后到的请求按自己的参数重新计算。
+ * 共享的计算使用自己的取消标记，按等待者计数：单个调用方断开或取消只让它自己停止等待，
+ * 所有等待者都放弃后才取消计算。命中或合并得到的响应由调用方用 rebind 换成自己的 request_id 和实际耗时。
+ */
+class ResultCache {
+public:
+    struct Key {
+        uint64_t hash = 0;
+        uint64_t size = 0;
+
+        bool operator==(const Key& other) const { return hash == other.hash && size == other.size; }
+    };
+
+    /**
+     * @brief 提交计算，返回结果的 future；cancel_token 为该计算的取消标记
+     */
+    using Submit = std::function<std::future<std::string>(std::shared_ptr<CancellationToken> cancel_token)>;
+
+    /**
+     * @param on_cancel 取消计算后调用 (如让 Worker 池把已取消的请求移出队列)
+     */
+    explicit ResultCache(const ResultCacheConfig& config, std::function<void()> on_cancel = {});
+
+    /**
+     * @brief 计算缓存键
+     * @param content 图像编码字节
+     * @param variant 影响结果的请求参数 (如任务类型)，不同参数的结果互不复用
+     */
+    static Key makeKey(std::string_view content, std::string_view variant = {});
+
+    /**
+     * @brief 64 位内容哈希 (XXH64 算法)
+     */
+    static uint64_t hash64(const void* data, size_t size, uint64_t seed = 0);
+
+    /**
+     * @brief 返回缓存结果；未命中时若有相同键的计算正在进行则等待其结果，否则调用 submit 并等待
+     *
+     * 等待的计算失败或抛出异常时改为单独调用 submit；本次调用 submit 或其结果抛出的异常传给调用方。
+     * @param abandoned 等待期间定期检查，返回 true 表示调用方不再需要结果 (如已断开、取消、超过截止时间)
+     * @param shared 非空时写入结果是否来自缓存或其他请求的计算 (而非本次调用 submit)
+     * @return 调用方放弃等待时为空
+     */
+    std::optional<std::string> getOrCompute(const Key& key, const Submit& submit,
+                                            const std::function<bool()>& abandoned = {}, bool* shared = nullptr);
+
+    /**
+     * @brief 把共享的响应改写为本请求的：替换 request_id 和 processing_time_ms，并加上 "cached": true
+     *
+     * 响应无法解析时原样返回。
+     */
+    static std::string rebind(const std::string& response, int request_id, double processing_time_ms);
+
+    ResultCacheStats stats() const;
+
+    const ResultCacheConfig& config() const { return config_; }
+
+private:
+    struct KeyHash {
+        size_t operator()(const Key& key) const { return static_cast<size_t>(key.hash ^ (key.size * 0x9E3779B97F4A7C15ULL)); }
+    };
+
+    struct Entry {
+        Key key;
+        std::string value;
+        std::chrono::steady_clock::time_point expires_at;
+    };
+
+    /**
+     * @brief 正在进行的共享计算
+     */
+    struct Flight {
+        std::shared_future<std::string> result;
+        std::shared_ptr<CancellationToken> cancel_token = std::make_shared<CancellationToken>();
+        int waiters = 1;  // 仍在等待结果的调用方，含发起计算的请求
+    };
+
+    /**
+     * @brief 等待 future 完成；调用方放弃时调用 give_up 一次，之后继续等待或立即返回由 keep_waiting 决定
+     * @return 调用方是否放弃了等待
+     */
+    static bool waitFor(const std::shared_future<std::string>& result, const std::function<bool()>& abandoned,
+                        const std::function<void()>& give_up, bool keep_waiting);
+
+    /**
+     * @brief 一个等待者放弃共享计算，最后一个放弃时取消计算，之后到达的相同请求重新发起计算
+     */
+    void leave(const Key& key, const std::shared_ptr<Flight>& flight);
+
+    /**
+     * @brief 计算结束，key 仍指向该计算时移除
+     */
+    void finishLocked(const Key& key, const std::shared_ptr<Flight>& flight);
+
+    /**
+     * @brief 不合并，按调用方自己的参数计算并等待
+     */
+    std::optional<std::string> computeAlone(const Submit& submit, const std::function<bool()>& abandoned);
+
+    void insertLocked(const Key& key, const std::string& value);
+    void eraseLocked(std::list<Entry>::iterator it);
+
+    ResultCacheConfig config_;
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;  // 头部为最近使用
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+    std::unordered_map<Key, std::shared_ptr<Flight>, KeyHash> in_flight_;
+    std::function<void()> on_cancel_;
+    size_t bytes_ = 0;
+    ResultCacheStats stats_;
+};
+
+} // namespace PaddleOCR
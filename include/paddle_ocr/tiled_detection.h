@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "utility.h"
+
+namespace PaddleOCR {
+
+/**
+ * @brief 分块检测配置
+ *
+ * 长截图(如 1080x8000)按 limit_side_len 整图缩放后文字会缩到无法识别，
+ * 分块模式把图像切成带重叠的原始分辨率小块分别检测，再合并接缝处的重复框。
+ */
+struct TiledDetConfig {
+    bool enabled = false;           // 是否启用分块检测
+    int tile_side = 1280;           // 分块最大边长 (像素)，分块内不再缩放
+    int overlap = 160;              // 相邻分块的重叠像素，需大于单行文字高度
+    float min_aspect_ratio = 2.5f;  // 长边/短边超过该值的长图触发分块
+    long long min_pixels = 16000000; // 像素总数超过该值的大图触发分块 (0 表示不按像素触发)
+};
+
+/**
+ * @brief 分块规划与检测框合并
+ */
+class DetTilePlanner {
+public:
+    /**
+     * @brief 判断图像是否需要分块检测
+     * @param size 原图尺寸
+     * @param config 分块配置
+     * @param limit_side_len 检测器整图缩放的边长上限
+     */
+    static bool shouldTile(const cv::Size& size, const TiledDetConfig& config, int limit_side_len);
+
+    /**
+     * @brief 将图像切分为带重叠的分块
+     * @return 原图坐标系下的分块矩形，按行优先排列
+     */
+    static std::vector<cv::Rect> planTiles(const cv::Size& size, const TiledDetConfig& config);
+
+    /**
+     * @brief 合并各分块的检测结果
+     *
+     * 分块坐标平移回原图后，去掉接缝处被截断的重复框：
+     * 一个框大部分落在另一分块的框内时保留较大者；同一行文字被竖向接缝切开时合并为外接矩形。
+     *
+     * @param tile_boxes 每个分块在分块坐标系下的检测框
+     * @param tiles 与 tile_boxes 对应的分块矩形
+     * @return 原图坐标系下的检测框
+     */
+    static std::vector<Quad> mergeTileBoxes(
+        const std::vector<std::vector<Quad>>& tile_boxes,
+        const std::vector<cv::Rect>& tiles);
+};
+
+} // namespace PaddleOCR
@@ -14,10 +14,16 @@
 
 #pragma once
 
+#include <array>
 #include <opencv2/imgproc.hpp>
 
 namespace PaddleOCR {
 
+// Text box as four corner points, clockwise from the top-left once
+// FilterTagDetRes has ordered them. Fixed size and trivially copyable, so a
+// std::vector<Quad> holds all boxes of an image in one allocation.
+using Quad = std::array<cv::Point, 4>;
+
 struct OCRPredictResult {
   std::vector<std::vector<int>> box;
   std::string text;
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include "ocr_worker.h"
+
+namespace PaddleOCR {
+
+/**
+ * @brief Worker 池的公共部分：准入控制、调度分派、对冲和统计
+ *
+ * CPU/GPU 池只在创建 Worker 时的设备参数上不同，其余逻辑都在这里。
+ */
+class WorkerPool {
+public:
+    /**
+     * @param use_gpu 为 true 时所有Worker使用GPU 0
+     */
+    WorkerPool(const std::string& model_dir, int num_workers, bool use_gpu, const OCRWorkerConfig& config);
+    ~WorkerPool();
+    
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    
+    void start();
+    void stop();
+    /**
+     * @brief 提交请求；请求先进入调度器，有Worker空闲时按优先级类别和客户端加权公平分派
+     * 所属类别的队列已满或无法在截止时间前完成时不入队，future 直接得到带 retry_after_ms 的拒绝响应
+     */
+    std::future<std::string> submitRequest(std::shared_ptr<OCRRequest> request);
+    
+    AdmissionStats getAdmissionStats() const;
+    
+    /**
+     * @brief 所有Worker级联模式的采用与回退次数之和
+     */
+    CascadeStats getCascadeStats() const;
+    
+    /**
+     * @brief 所有Worker缩小解码后重新解码的次数之和
+     */
+    int64_t getRedecodeCount() const;
+    
+    /**
+     * @brief 各优先级类别的队列深度、分派数和延迟分位数
+     */
+    std::vector<PriorityClassStats> getSchedulerStats() const;
+    
+    /**
+     * @brief 调度使用的耗时代价模型系数与预测误差
+     */
+    CostModelStats getCostModelStats() const;
+    
+    /**
+     * @brief 对冲发起次数与对冲副本先完成的次数
+     */
+    HedgingStats getHedgingStats() const;
+    
+    /**
+     * @brief 各Worker的输入形状缓存命中率 (按最近处理过的形状估算)
+     */
+    std::vector<WorkerShapeStats> getShapeStats() const;
+    
+    /**
+     * @brief 把调度器和各Worker队列中已取消的请求移出队列，返回移除数
+     */
+    int removeCancelled();
+    
+    /**
+     * @brief 池内Worker检测/识别模型实际使用的推理精度 (各Worker配置相同，取第一个)
+     */
+    std::string getDetPrecision() const;
+    std::string getRecPrecision() const;
+    
+private:
+    /**
+     * @brief 准入检查，调用方需持有 workers_mutex_
+     * @return 拒绝时返回 false，并给出原因和建议的重试等待时间
+     */
+    bool admitRequest(const OCRRequest& request, std::string& reason, int& retry_after_ms) const;
+    
+    /**
+     * @brief 把调度器中的请求分派给空闲Worker (每个Worker一次一个)，调用方需持有 workers_mutex_
+     */
+    void dispatchLocked();
+    
+    /**
+     * @brief 从空闲Worker中为该请求选择一个并记录形状，调用方需持有 workers_mutex_
+     * @param idle 空闲Worker下标，选中的一个会从中移除
+     */
+    OCRWorker* pickWorkerLocked(const OCRRequest& request, std::vector<size_t>& idle);
+    
+    /**
+     * @brief Worker 完成一个请求后的回调：记录延迟并分派下一个请求
+     */
+    void onRequestCompleted(const OCRRequest& request);
+    
+    /**
+     * @brief 各Worker近期平均处理耗时的均值 (毫秒)，尚无数据时为 0
+     */
+    double averageServiceMs() const;
+    
+    /**
+     * @brief 对冲线程：等到最早的请求超过对冲阈值，或有请求完成、分派时重新检查
+     */
+    void hedgeLoop();
+    
+    /**
+     * @brief 为超过阈值的请求在空闲Worker上发起对冲，调用方需持有 workers_mutex_
+     * @return 下一个请求到达阈值的时间，没有时为 time_point::max()
+     */
+    std::chrono::steady_clock::time_point hedgeLocked();
+    
+    /**
+     * @brief 已分派给Worker尚未完成的请求
+     */
+    struct InFlight {
+        std::shared_ptr<OCRRequest> request;
+        std::chrono::steady_clock::time_point started;
+        std::shared_ptr<OCRRequest> partner;  // 对冲的另一份，未对冲或另一份已完成时为空
+        bool hedged = false;                  // 已发起过对冲，或本身是对冲副本
+    };
+    
+    std::vector<std::unique_ptr<OCRWorker>> workers_;
+    mutable std::mutex workers_mutex_;
+    std::atomic<int> next_worker_index_;
+    RequestScheduler scheduler_;  // 等待分派的请求，受 workers_mutex_ 保护
+    std::atomic<int64_t> rejected_requests_{0};
+    std::atomic<int64_t> cancelled_requests_{0};  // 分派前在调度器中取消
+    std::vector<InFlight> in_flight_;  // 受 workers_mutex_ 保护
+    HedgePolicy hedge_policy_;
+    ShapeAffinity shape_affinity_;     // 受 workers_mutex_ 保护
+    bool prefer_warm_workers_;         // 关闭时仍统计命中率，便于对比
+    std::thread hedge_thread_;
+    std::condition_variable hedge_cv_;
+    bool hedge_running_ = false;
+    int64_t hedges_launched_ = 0;
+    int64_t hedge_wins_ = 0;
+};
+
+} // namespace PaddleOCR
@@ -0,0 +1,351 @@
+"""
+CPU INT8 quantization for the det/rec models.
+
+Calibrates det and rec with PaddleSlim post-training quantization on a local
+image folder. Then it runs fp32 and int8 side by side through Paddle
+Inference (oneDNN, int8 kernels enabled for the quantized model) and writes
+an accuracy/latency report. The quantized model is installed to
+<model-dir>/<det|rec>/int8 only when the accuracy gate passes, which is where
+`ocr_service --precision int8` looks for it.
+
+Requirements: paddlepaddle, paddleslim, opencv-python, numpy
+
+Usage:
+    python scripts/quantize_models.py --model-dir models --image-dir images
+    python scripts/quantize_models.py --model-dir models --image-dir D:/cards --calib-num 200 --max-rec-drop 0.005
+"""
+
+import argparse
+import json
+import os
+import shutil
+import sys
+import time
+
+import cv2
+import numpy as np
+
+# Keep in sync with OCRWorker (src/ocr_worker.cpp)
+DET_LIMIT_SIDE_LEN = 512
+DET_DB_THRESH = 0.2
+DET_MEAN = np.array([0.485, 0.456, 0.406], dtype=np.float32)
+DET_STD = np.array([0.229, 0.224, 0.225], dtype=np.float32)
+REC_IMG_H = 28
+REC_IMG_W = 192
+
+MODEL_VARIANTS = [
+    ("inference.json", "inference.pdiparams"),
+    ("model.json", "model.pdiparams"),
+    ("inference.pdmodel", "inference.pdiparams"),
+    ("model.pdmodel", "model.pdiparams"),
+]
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description="CPU INT8 quantization with accuracy gate")
+    parser.add_argument("--model-dir", default="models", help="模型根目录，包含 det/ rec/")
+    parser.add_argument("--image-dir", required=True, help="校准与评估用的本地图片目录")
+    parser.add_argument("--models", default="det,rec", help="需要量化的模型，逗号分隔")
+    parser.add_argument("--calib-num", type=int, default=64, help="校准图片数量")
+    parser.add_argument("--eval-num", type=int, default=100, help="评估图片数量 (与校准集可重叠)")
+    parser.add_argument("--algo", default="KL", choices=["KL", "avg", "abs_max", "mse", "hist"],
+                        help="激活量化阈值算法")
+    parser.add_argument("--threads", type=int, default=2, help="评估时的CPU数学库线程数，与Worker保持一致")
+    parser.add_argument("--max-det-drop", type=float, default=0.02,
+                        help="允许的检测框匹配F1下降 (相对fp32结果)")
+    parser.add_argument("--max-rec-drop", type=float, default=0.01,
+                        help="允许的识别文本一致率下降 (相对fp32结果)")
+    parser.add_argument("--report-dir", default="dist/quant_report", help="报告输出目录")
+    parser.add_argument("--force", action="store_true", help="精度不达标也安装int8模型")
+    return parser.parse_args()
+
+
+def find_model(model_dir):
+    for model_file, params_file in MODEL_VARIANTS:
+        if os.path.exists(os.path.join(model_dir, model_file)):
+            return model_file, params_file
+    raise FileNotFoundError("No valid model file found in " + model_dir)
+
+
+def list_images(image_dir):
+    exts = (".jpg", ".jpeg", ".png", ".bmp")
+    files = sorted(f for f in os.listdir(image_dir) if f.lower().endswith(exts))
+    if not files:
+        raise FileNotFoundError("No images found in " + image_dir)
+    return [os.path.join(image_dir, f) for f in files]
+
+
+def det_preprocess(img):
+    """与 ResizeImgType0("max") + Normalize + Permute 一致"""
+    h, w = img.shape[:2]
+    ratio = 1.0
+    if max(h, w) > DET_LIMIT_SIDE_LEN:
+        ratio = DET_LIMIT_SIDE_LEN / float(max(h, w))
+    resize_h = max(int(round(int(h * ratio) / 32.0) * 32), 32)
+    resize_w = max(int(round(int(w * ratio) / 32.0) * 32), 32)
+    resized = cv2.resize(img, (resize_w, resize_h)).astype(np.float32) / 255.0
+    resized = (resized - DET_MEAN) / DET_STD
+    return resized.transpose(2, 0, 1)[np.newaxis, :], (h / float(resize_h), w / float(resize_w))
+
+
+def det_boxes(prob_map, ratio):
+    """简化的DB后处理：二值图连通域外接矩形，足够用于fp32/int8结果对比"""
+    bitmap = (prob_map > DET_DB_THRESH).astype(np.uint8)
+    contours, _ = cv2.findContours(bitmap, cv2.RETR_LIST, cv2.CHAIN_APPROX_SIMPLE)
+    boxes = []
+    for contour in contours:
+        x, y, w, h = cv2.boundingRect(contour)
+        if w < 3 or h < 3:
+            continue
+        # 近似 unclip：按框高向外扩展
+        pad = int(h * 0.4)
+        x0, y0 = max(0, x - pad), max(0, y - pad)
+        x1, y1 = x + w + pad, y + h + pad
+        boxes.append((int(x0 * ratio[1]), int(y0 * ratio[0]), int(x1 * ratio[1]), int(y1 * ratio[0])))
+    return boxes
+
+
+def rec_preprocess(crop):
+    """与 CrnnResizeImg + Normalize(0.5, 0.5) 一致，单张图按自身宽高比"""
+    h, w = crop.shape[:2]
+    resize_w = max(REC_IMG_W, int(np.ceil(REC_IMG_H * w / float(h))))
+    target_w = int(np.ceil(REC_IMG_H * w / float(h)))
+    resized = cv2.resize(crop, (target_w, REC_IMG_H)).astype(np.float32) / 255.0
+    resized = (resized - 0.5) / 0.5
+    padded = np.full((REC_IMG_H, resize_w, 3), -1.0, dtype=np.float32)
+    padded[:, :target_w, :] = resized
+    return padded.transpose(2, 0, 1)[np.newaxis, :]
+
+
+def load_labels(model_dir):
+    with open(os.path.join(model_dir, "ppocr_keys_v1.txt"), encoding="utf-8") as f:
+        labels = [line.rstrip("\r\n") for line in f]
+    return ["#"] + labels + [" "]
+
+
+def ctc_decode(probs, labels):
+    idx = probs.argmax(axis=1)
+    text, last = [], 0
+    for n, i in enumerate(idx):
+        if i > 0 and not (n > 0 and i == last) and i < len(labels):
+            text.append(labels[i])
+        last = i
+    return "".join(text)
+
+
+def create_predictor(model_dir, int8, threads):
+    from paddle import inference
+    model_file, params_file = find_model(model_dir)
+    config = inference.Config(os.path.join(model_dir, model_file), os.path.join(model_dir, params_file))
+    config.disable_gpu()
+    config.enable_mkldnn()
+    config.set_mkldnn_cache_capacity(10)
+    if int8:
+        config.enable_mkldnn_int8()
+    config.set_cpu_math_library_num_threads(threads)
+    config.switch_ir_optim(True)
+    config.enable_memory_optim()
+    config.disable_glog_info()
+    return inference.create_predictor(config)
+
+
+def run_predictor(predictor, data):
+    input_handle = predictor.get_input_handle(predictor.get_input_names()[0])
+    input_handle.reshape(data.shape)
+    input_handle.copy_from_cpu(np.ascontiguousarray(data))
+    predictor.run()
+    output_handle = predictor.get_output_handle(predictor.get_output_names()[0])
+    return output_handle.copy_to_cpu()
+
+
+def collect_rec_crops(det_dir, images, threads, limit):
+    """用fp32检测模型在样本图上切出文本行，作为识别模型的校准和评估数据"""
+    predictor = create_predictor(det_dir, False, threads)
+    crops = []
+    for path in images:
+        img = cv2.imread(path)
+        if img is None:
+            continue
+        data, ratio = det_preprocess(img)
+        prob = run_predictor(predictor, data)[0, 0]
+        for x0, y0, x1, y1 in det_boxes(prob, ratio):
+            crop = img[y0:min(y1, img.shape[0]), x0:min(x1, img.shape[1])]
+            if crop.shape[0] > 2 and crop.shape[1] > 2:
+                crops.append(crop)
+            if len(crops) >= limit:
+                return crops
+    return crops
+
+
+def quantize(model_dir, output_dir, samples, algo):
+    import paddle
+    from paddleslim.quant import quant_post_static
+
+    paddle.enable_static()
+    model_file, params_file = find_model(model_dir)
+
+    def sample_generator():
+        for sample in samples:
+            yield [sample]
+
+    exe = paddle.static.Executor(paddle.CPUPlace())
+    quant_post_static(
+        executor=exe,
+        model_dir=model_dir,
+        quantize_model_path=output_dir,
+        batch_generator=sample_generator,
+        model_filename=model_file,
+        params_filename=params_file,
+        save_model_filename="inference.pdmodel",
+        save_params_filename="inference.pdiparams",
+        batch_nums=len(samples),
+        algo=algo,
+        quantizable_op_type=["conv2d", "depthwise_conv2d", "matmul", "matmul_v2", "mul"],
+    )
+    paddle.disable_static()
+
+
+def box_f1(ref, pred, iou_thresh=0.5):
+    def iou(a, b):
+        ix = max(0, min(a[2], b[2]) - max(a[0], b[0]))
+        iy = max(0, min(a[3], b[3]) - max(a[1], b[1]))
+        inter = ix * iy
+        union = (a[2] - a[0]) * (a[3] - a[1]) + (b[2] - b[0]) * (b[3] - b[1]) - inter
+        return inter / float(union) if union > 0 else 0.0
+
+    if not ref and not pred:
+        return 1.0
+    used, matched = set(), 0
+    for r in ref:
+        for j, p in enumerate(pred):
+            if j not in used and iou(r, p) >= iou_thresh:
+                used.add(j)
+                matched += 1
+                break
+    precision = matched / float(len(pred)) if pred else 0.0
+    recall = matched / float(len(ref)) if ref else 0.0
+    return 2 * precision * recall / (precision + recall) if precision + recall > 0 else 0.0
+
+
+def timed(predictor, data):
+    start = time.perf_counter()
+    out = run_predictor(predictor, data)
+    return out, (time.perf_counter() - start) * 1000.0
+
+
+def evaluate_det(fp32_dir, int8_dir, images, threads):
+    fp32 = create_predictor(fp32_dir, False, threads)
+    int8 = create_predictor(int8_dir, True, threads)
+    f1s, fp32_ms, int8_ms = [], [], []
+    for path in images:
+        img = cv2.imread(path)
+        if img is None:
+            continue
+        data, ratio = det_preprocess(img)
+        # 预热一次，避免oneDNN首次编译计入延迟
+        run_predictor(fp32, data)
+        run_predictor(int8, data)
+        ref, t_ref = timed(fp32, data)
+        out, t_out = timed(int8, data)
+        f1s.append(box_f1(det_boxes(ref[0, 0], ratio), det_boxes(out[0, 0], ratio)))
+        fp32_ms.append(t_ref)
+        int8_ms.append(t_out)
+    return {
+        "samples": len(f1s),
+        "agreement": float(np.mean(f1s)) if f1s else 0.0,
+        "fp32_latency_ms": float(np.mean(fp32_ms)) if fp32_ms else 0.0,
+        "int8_latency_ms": float(np.mean(int8_ms)) if int8_ms else 0.0,
+    }
+
+
+def evaluate_rec(fp32_dir, int8_dir, crops, labels, threads):
+    fp32 = create_predictor(fp32_dir, False, threads)
+    int8 = create_predictor(int8_dir, True, threads)
+    same, fp32_ms, int8_ms = 0, [], []
+    for crop in crops:
+        data = rec_preprocess(crop)
+        run_predictor(fp32, data)
+        run_predictor(int8, data)
+        ref, t_ref = timed(fp32, data)
+        out, t_out = timed(int8, data)
+        if ctc_decode(ref[0], labels) == ctc_decode(out[0], labels):
+            same += 1
+        fp32_ms.append(t_ref)
+        int8_ms.append(t_out)
+    return {
+        "samples": len(crops),
+        "agreement": same / float(len(crops)) if crops else 0.0,
+        "fp32_latency_ms": float(np.mean(fp32_ms)) if fp32_ms else 0.0,
+        "int8_latency_ms": float(np.mean(int8_ms)) if int8_ms else 0.0,
+    }
+
+
+def write_report(report_dir, report):
+    os.makedirs(report_dir, exist_ok=True)
+    with open(os.path.join(report_dir, "quant_report.json"), "w", encoding="utf-8") as f:
+        json.dump(report, f, ensure_ascii=False, indent=2)
+
+    lines = ["# CPU INT8 Quantization Report", "",
+             "| model | samples | agreement vs fp32 | max drop | fp32 ms | int8 ms | speedup | installed |",
+             "|---|---|---|---|---|---|---|---|"]
+    for name, r in report["models"].items():
+        speedup = r["fp32_latency_ms"] / r["int8_latency_ms"] if r["int8_latency_ms"] > 0 else 0.0
+        lines.append("| {} | {} | {:.4f} | {:.4f} | {:.2f} | {:.2f} | {:.2f}x | {} |".format(
+            name, r["samples"], r["agreement"], r["max_drop"], r["fp32_latency_ms"],
+            r["int8_latency_ms"], speedup, "yes" if r["installed"] else "no"))
+    with open(os.path.join(report_dir, "quant_report.md"), "w", encoding="utf-8") as f:
+        f.write("\n".join(lines) + "\n")
+    print("\n".join(lines))
+
+
+def main():
+    args = parse_args()
+    images = list_images(args.image_dir)
+    calib_images = images[:args.calib_num]
+    eval_images = images[:args.eval_num]
+    targets = [m.strip() for m in args.models.split(",") if m.strip()]
+
+    det_dir = os.path.join(args.model_dir, "det")
+    rec_dir = os.path.join(args.model_dir, "rec")
+    report = {"image_dir": args.image_dir, "algo": args.algo, "threads": args.threads, "models": {}}
+
+    for name in targets:
+        model_dir = os.path.join(args.model_dir, name)
+        candidate_dir = os.path.join(model_dir, "int8_candidate")
+        install_dir = os.path.join(model_dir, "int8")
+        print("=== Quantizing {} ===".format(name))
+
+        if name == "det":
+            samples = [det_preprocess(img)[0] for img in (cv2.imread(p) for p in calib_images) if img is not None]
+            quantize(model_dir, candidate_dir, samples, args.algo)
+            result = evaluate_det(model_dir, candidate_dir, eval_images, args.threads)
+            max_drop = args.max_det_drop
+        elif name == "rec":
+            crops = collect_rec_crops(det_dir, images, args.threads, max(args.calib_num, args.eval_num) * 4)
+            if not crops:
+                print("No text lines found for rec calibration, skipped")
+                continue
+            quantize(model_dir, candidate_dir, [rec_preprocess(c) for c in crops[:args.calib_num * 4]], args.algo)
+            result = evaluate_rec(rec_dir, candidate_dir, crops, load_labels(rec_dir), args.threads)
+            max_drop = args.max_rec_drop
+        else:
+            print("Unknown model: " + name)
+            continue
+
+        # 精度门限：与fp32结果的一致率下降不超过 max_drop 才安装
+        passed = (1.0 - result["agreement"]) <= max_drop
+        installed = passed or args.force
+        if installed:
+            if os.path.exists(install_dir):
+                shutil.rmtree(install_dir)
+            shutil.move(candidate_dir, install_dir)
+        result.update({"max_drop": max_drop, "passed": passed, "installed": installed})
+        report["models"][name] = result
+        print("{}: agreement={:.4f}, gate={}".format(name, result["agreement"], "PASS" if passed else "FAIL"))
+
+    write_report(args.report_dir, report)
+    return 0 if all(r["passed"] for r in report["models"].values()) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
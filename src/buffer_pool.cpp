@@ -0,0 +1,287 @@
+#include "paddle_ocr/buffer_pool.h"
+#include <algorithm>
+#include <bit>
+#include <mutex>
+#include <vector>
+
+namespace PaddleOCR {
+
+namespace {
+
+constexpr size_t kMinBlock = 64;                    // 最小块，与 fastMalloc 对齐一致
+constexpr size_t kMaxPooledBlock = size_t(1) << 27; // 超过 128MB 的分配不池化
+constexpr int kClassCount = 96;
+constexpr size_t kLocalBlocksPerClass = 8;          // 线程本地每个等级最多缓存的块数
+constexpr size_t kLocalMaxBytes = size_t(32) << 20; // 线程本地缓存上限，更大的块只进全局仓库
+constexpr size_t kDepotBlocksPerClass = 32;         // 全局仓库每个等级最多缓存的块数
+constexpr long long kMaxCachedBytes = 256LL << 20;  // 所有线程本地缓存与全局仓库合计上限
+constexpr size_t kAutoStep = 0x7fffffff;            // 即 CV_AUTOSTEP
+
+/**
+ * @brief 尺寸等级编号 -> 块大小，与 PooledMatAllocator::sizeClass 互逆
+ */
+size_t classSize(int cls) {
+    if (cls == 0) {
+        return kMinBlock;
+    }
+    int k = (cls - 1) / 4 + 6;
+    size_t step = static_cast<size_t>((cls - 1) % 4 + 4);
+    return (step + 1) << (k - 2);
+}
+
+std::atomic<long long> live_bytes{0};       // 池化等级的块中正被 Mat 使用的字节
+std::atomic<long long> peak_live_bytes{0};  // live_bytes 的历史峰值
+std::atomic<long long> cached_bytes{0};     // 所有线程本地缓存与全局仓库中空闲块的字节
+
+void addLive(size_t bytes) {
+    long long live = live_bytes.fetch_add(static_cast<long long>(bytes), std::memory_order_relaxed) +
+                     static_cast<long long>(bytes);
+    long long peak = peak_live_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+/**
+ * @brief 为即将缓存的块预留额度
+ *
+ * 缓存总量不超过实际用量的峰值 (即稳态工作集) 与 kMaxCachedBytes 中的较小者，
+ * 所有线程 (含 OpenCV 并行线程、IPC 线程) 共用这一额度。
+ */
+bool reserveCached(size_t bytes) {
+    long long limit = std::min(kMaxCachedBytes, peak_live_bytes.load(std::memory_order_relaxed));
+    long long amount = static_cast<long long>(bytes);
+    if (cached_bytes.fetch_add(amount, std::memory_order_relaxed) + amount > limit) {
+        cached_bytes.fetch_sub(amount, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void releaseCached(size_t bytes) {
+    cached_bytes.fetch_sub(static_cast<long long>(bytes), std::memory_order_relaxed);
+}
+
+/**
+ * @brief 全局仓库：线程本地缓存溢出或线程退出时的去处
+ */
+struct Depot {
+    std::mutex mutex;
+    std::vector<void*> free_lists[kClassCount];
+    long long cached_bytes = 0;
+
+    void* pop(int cls, size_t class_size) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& list = free_lists[cls];
+        if (list.empty()) {
+            return nullptr;
+        }
+        void* block = list.back();
+        list.pop_back();
+        cached_bytes -= static_cast<long long>(class_size);
+        return block;
+    }
+
+    // 总字节额度由调用方通过 reserveCached 预留
+    bool push(int cls, size_t class_size, void* block) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& list = free_lists[cls];
+        if (list.size() >= kDepotBlocksPerClass) {
+            return false;
+        }
+        list.push_back(block);
+        cached_bytes += static_cast<long long>(class_size);
+        return true;
+    }
+};
+
+Depot& depot() {
+    // 有意泄漏：进程退出时静态析构顺序不确定，仍可能有 Mat 归还内存
+    static Depot* instance = new Depot();
+    return *instance;
+}
+
+/**
+ * @brief 线程本地缓存，线程退出时把缓存块交还仓库
+ */
+struct ThreadCache {
+    std::vector<void*> free_lists[kClassCount];
+    size_t cached_bytes = 0;
+
+    ThreadCache() {
+        for (auto& list : free_lists) {
+            list.reserve(kLocalBlocksPerClass);
+        }
+    }
+
+    ~ThreadCache();
+};
+
+// ThreadCache 析构后本线程仍可能释放 Mat (其他 thread_local 对象)，此时直接走仓库
+thread_local bool cache_destroyed = false;
+
+ThreadCache::~ThreadCache() {
+    cache_destroyed = true;
+    for (int cls = 0; cls < kClassCount; ++cls) {
+        for (void* block : free_lists[cls]) {
+            if (!depot().push(cls, classSize(cls), block)) {
+                releaseCached(classSize(cls));
+                cv::fastFree(block);
+            }
+        }
+        free_lists[cls].clear();
+    }
+}
+
+ThreadCache* threadCache() {
+    if (cache_destroyed) {
+        return nullptr;
+    }
+    thread_local ThreadCache cache;
+    return &cache;
+}
+
+} // namespace
+
+std::atomic<bool> PooledMatAllocator::installed_{false};
+std::atomic<long long> PooledMatAllocator::allocations_{0};
+std::atomic<long long> PooledMatAllocator::pool_hits_{0};
+
+PooledMatAllocator* PooledMatAllocator::instance() {
+    static PooledMatAllocator* allocator = new PooledMatAllocator();
+    return allocator;
+}
+
+void PooledMatAllocator::install() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        cv::Mat::setDefaultAllocator(instance());
+        installed_ = true;
+    });
+}
+
+bool PooledMatAllocator::installed() {
+    return installed_.load();
+}
+
+BufferPoolStatsSnapshot PooledMatAllocator::stats() {
+    BufferPoolStatsSnapshot snapshot;
+    snapshot.allocations = allocations_.load();
+    snapshot.pool_hits = pool_hits_.load();
+    snapshot.cached_bytes = cached_bytes.load();
+    snapshot.peak_live_bytes = peak_live_bytes.load();
+    Depot& d = depot();
+    std::lock_guard<std::mutex> lock(d.mutex);
+    snapshot.depot_bytes = d.cached_bytes;
+    return snapshot;
+}
+
+int PooledMatAllocator::sizeClass(size_t size, size_t& class_size) {
+    if (size <= kMinBlock) {
+        class_size = kMinBlock;
+        return 0;
+    }
+    if (size > kMaxPooledBlock) {
+        class_size = size;
+        return -1;
+    }
+    // 2^k <= v < 2^(k+1)，每个 2 的幂区间再分 4 档，浪费不超过 25%
+    size_t v = size - 1;
+    int k = static_cast<int>(std::bit_width(v)) - 1;
+    size_t quarter = size_t(1) << (k - 2);
+    size_t step = v / quarter; // [4, 7]
+    class_size = (step + 1) * quarter;
+    return (k - 6) * 4 + static_cast<int>(step - 4) + 1;
+}
+
+cv::UMatData* PooledMatAllocator::allocate(int dims, const int* sizes, int type, void* data0, size_t* step,
+                                           cv::AccessFlag /*flags*/, cv::UMatUsageFlags /*usage_flags*/) const {
+    // 与 OpenCV StdMatAllocator 相同的步长计算
+    size_t total = CV_ELEM_SIZE(type);
+    for (int i = dims - 1; i >= 0; i--) {
+        if (step) {
+            if (data0 && step[i] != kAutoStep) {
+                CV_Assert(total <= step[i]);
+                total = step[i];
+            } else {
+                step[i] = total;
+            }
+        }
+        total *= sizes[i];
+    }
+
+    uchar* data = static_cast<uchar*>(data0);
+    if (!data) {
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        size_t class_size = 0;
+        int cls = sizeClass(total, class_size);
+        if (cls >= 0) {
+            ThreadCache* cache = threadCache();
+            if (cache && !cache->free_lists[cls].empty()) {
+                data = static_cast<uchar*>(cache->free_lists[cls].back());
+                cache->free_lists[cls].pop_back();
+                cache->cached_bytes -= class_size;
+            } else {
+                data = static_cast<uchar*>(depot().pop(cls, class_size));
+            }
+            if (data) {
+                pool_hits_.fetch_add(1, std::memory_order_relaxed);
+                releaseCached(class_size);
+            }
+            addLive(class_size);
+        }
+        if (!data) {
+            data = static_cast<uchar*>(cv::fastMalloc(class_size));
+        }
+    }
+
+    cv::UMatData* u = new cv::UMatData(this);
+    u->data = u->origdata = data;
+    u->size = total;
+    if (data0) {
+        u->flags |= cv::UMatData::USER_ALLOCATED;
+    }
+    return u;
+}
+
+bool PooledMatAllocator::allocate(cv::UMatData* u, cv::AccessFlag /*access_flags*/,
+                                  cv::UMatUsageFlags /*usage_flags*/) const {
+    return u != nullptr;
+}
+
+void PooledMatAllocator::deallocate(cv::UMatData* u) const {
+    if (!u) {
+        return;
+    }
+    CV_Assert(u->urefcount == 0);
+    CV_Assert(u->refcount == 0);
+    if (!(u->flags & cv::UMatData::USER_ALLOCATED)) {
+        void* block = u->origdata;
+        size_t class_size = 0;
+        int cls = sizeClass(u->size, class_size);
+        bool cached = false;
+        if (cls >= 0) {
+            live_bytes.fetch_sub(static_cast<long long>(class_size), std::memory_order_relaxed);
+            if (reserveCached(class_size)) {
+                ThreadCache* cache = threadCache();
+                if (cache && cache->free_lists[cls].size() < kLocalBlocksPerClass &&
+                    cache->cached_bytes + class_size <= kLocalMaxBytes) {
+                    cache->free_lists[cls].push_back(block);
+                    cache->cached_bytes += class_size;
+                    cached = true;
+                } else {
+                    cached = depot().push(cls, class_size, block);
+                }
+                if (!cached) {
+                    releaseCached(class_size);
+                }
+            }
+        }
+        if (!cached) {
+            cv::fastFree(block);
+        }
+        u->origdata = 0;
+    }
+    delete u;
+}
+
+} // namespace PaddleOCR
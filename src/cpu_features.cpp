@@ -0,0 +1,119 @@
+#include "paddle_ocr/cpu_features.h"
+#include <iostream>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#endif
+
+namespace PaddleOCR {
+
+namespace {
+
+#if defined(_MSC_VER) || (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)))
+#define PADDLE_OCR_HAS_CPUID 1
+
+void cpuid(int leaf, int subleaf, unsigned int regs[4]) {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuidex(info, leaf, subleaf);
+    for (int i = 0; i < 4; ++i) {
+        regs[i] = static_cast<unsigned int>(info[i]);
+    }
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+unsigned long long xgetbv0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+}
+#endif
+
+CPUFeatures probe() {
+    CPUFeatures features;
+#ifdef PADDLE_OCR_HAS_CPUID
+    unsigned int regs[4];
+    cpuid(0, 0, regs);
+    unsigned int max_leaf = regs[0];
+
+    cpuid(1, 0, regs);
+    bool osxsave = (regs[2] >> 27) & 1;
+    unsigned long long xcr0 = osxsave ? xgetbv0() : 0;
+    bool os_avx = (xcr0 & 0x6) == 0x6;                       // XMM | YMM
+    bool os_avx512 = os_avx && (xcr0 & 0xE0) == 0xE0;        // opmask | ZMM_Hi256 | Hi16_ZMM
+    bool os_amx = (xcr0 & 0x60000) == 0x60000;               // XTILECFG | XTILEDATA
+
+    if (max_leaf >= 7) {
+        cpuid(7, 0, regs);
+        features.avx2 = os_avx && ((regs[1] >> 5) & 1);
+        features.avx512f = os_avx512 && ((regs[1] >> 16) & 1);
+        features.avx512_vnni = features.avx512f && ((regs[2] >> 11) & 1);
+        features.amx_bf16 = os_amx && ((regs[3] >> 22) & 1);
+        features.amx_int8 = os_amx && ((regs[3] >> 25) & 1);
+
+        cpuid(7, 1, regs);
+        features.avx512_bf16 = features.avx512f && ((regs[0] >> 5) & 1);
+    }
+
+    cpuid(0x80000000, 0, regs);
+    if (regs[0] >= 0x80000004) {
+        char brand[49] = {0};
+        for (unsigned int i = 0; i < 3; ++i) {
+            cpuid(0x80000002 + i, 0, regs);
+            std::memcpy(brand + i * 16, regs, 16);
+        }
+        features.brand = brand;
+        size_t first = features.brand.find_first_not_of(' ');
+        features.brand = first == std::string::npos ? std::string() : features.brand.substr(first);
+    }
+#endif
+    return features;
+}
+
+} // namespace
+
+const CPUFeatures& CPUFeatures::detect() {
+    static const CPUFeatures features = probe();
+    return features;
+}
+
+std::string CPUFeatures::summary() const {
+    std::string flags;
+    auto add = [&flags](bool enabled, const char* name) {
+        if (enabled) {
+            if (!flags.empty()) flags += ",";
+            flags += name;
+        }
+    };
+    add(avx2, "AVX2");
+    add(avx512f, "AVX512F");
+    add(avx512_vnni, "AVX512_VNNI");
+    add(avx512_bf16, "AVX512_BF16");
+    add(amx_bf16, "AMX_BF16");
+    add(amx_int8, "AMX_INT8");
+    return (brand.empty() ? std::string("Unknown CPU") : brand) + " [" + flags + "]";
+}
+
+std::string CPUFeatures::resolvePrecision(const std::string& requested) {
+    const CPUFeatures& features = detect();
+    if (requested == "auto") {
+        return features.supportsBf16() ? "bf16" : "fp32";
+    }
+    if (requested == "bf16" && !features.supportsBf16()) {
+        std::cerr << "[WARNING] CPU has no AVX512-BF16/AMX-BF16 support, falling back to fp32" << std::endl;
+        return "fp32";
+    }
+    return requested;
+}
+
+} // namespace PaddleOCR
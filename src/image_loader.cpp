@@ -0,0 +1,218 @@
+#include "paddle_ocr/image_loader.h"
+#include <opencv2/imgcodecs.hpp>
+#include <climits>
+#include <cstdlib>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace PaddleOCR {
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::string& path, std::string& error) {
+    std::shared_ptr<MappedFile> file(new MappedFile());
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        error = "Failed to open image file: " + path;
+        return nullptr;
+    }
+    file->file_ = handle;
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(handle, &file_size) || file_size.QuadPart <= 0) {
+        error = "Empty or unreadable image file: " + path;
+        return nullptr;
+    }
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        error = "Failed to map image file: " + path;
+        return nullptr;
+    }
+    file->mapping_ = mapping;
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        error = "Failed to map image file: " + path;
+        return nullptr;
+    }
+    file->data_ = static_cast<const uchar*>(view);
+    file->size_ = static_cast<size_t>(file_size.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "Failed to open image file: " + path;
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        error = "Empty or unreadable image file: " + path;
+        return nullptr;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // 映射建立后即可关闭描述符
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        error = "Failed to map image file: " + path;
+        return nullptr;
+    }
+    file->data_ = static_cast<const uchar*>(view);
+    file->size_ = static_cast<size_t>(st.st_size);
+#endif
+    return file;
+}
+
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+    if (data_) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_) {
+        CloseHandle(mapping_);
+    }
+    if (file_) {
+        CloseHandle(file_);
+    }
+#else
+    if (data_) {
+        munmap(const_cast<uchar*>(data_), size_);
+    }
+#endif
+}
+
+cv::Mat MappedFile::view() const {
+    // imdecode 只读取输入，const_cast 不会写入只读映射
+    return cv::Mat(1, static_cast<int>(size_), CV_8UC1, const_cast<uchar*>(data_));
+}
+
+cv::Mat ReducedImageSource::decodeAt(int reduction) const {
+    int flags = reduction == 8 ? cv::IMREAD_REDUCED_COLOR_8
+              : reduction == 4 ? cv::IMREAD_REDUCED_COLOR_4
+              : reduction == 2 ? cv::IMREAD_REDUCED_COLOR_2
+                               : cv::IMREAD_COLOR;
+    return cv::imdecode(file->view(), flags);
+}
+
+int ReducedImageSource::redecodeScale(double text_height, int min_text_height) const {
+    for (int reduction = scale / 2; reduction > 1; reduction /= 2) {
+        if (text_height * scale / reduction >= min_text_height) {
+            return reduction;
+        }
+    }
+    return 1;
+}
+
+bool ImageLoader::probeJpegSize(const uchar* data, size_t size, cv::Size& image_size) {
+    if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+        return false;
+    }
+    size_t pos = 2;
+    while (pos + 4 <= size) {
+        if (data[pos] != 0xFF) {
+            return false;
+        }
+        uchar marker = data[pos + 1];
+        if (marker == 0xFF) {
+            ++pos;  // 填充字节
+            continue;
+        }
+        pos += 2;
+        // 无长度字段的独立标记
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+            continue;
+        }
+        if (marker == 0xD9 || marker == 0xDA) {
+            return false;  // 在帧头之前遇到图像结束或扫描开始
+        }
+        size_t length = (static_cast<size_t>(data[pos]) << 8) | data[pos + 1];
+        if (length < 2 || pos + length > size) {
+            return false;
+        }
+        // SOF0-SOF15，排除 DHT(C4)、JPG(C8)、DAC(CC)；EXIF 缩略图在 APP1 段内，整段跳过
+        bool is_sof = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+        if (is_sof) {
+            if (length < 7) {
+                return false;
+            }
+            int height = (data[pos + 3] << 8) | data[pos + 4];
+            int width = (data[pos + 5] << 8) | data[pos + 6];
+            if (width <= 0 || height <= 0) {
+                return false;
+            }
+            image_size = cv::Size(width, height);
+            return true;
+        }
+        pos += length;
+    }
+    return false;
+}
+
+int ImageLoader::chooseScale(cv::Size image_size, int min_side) {
+    int long_side = image_size.width > image_size.height ? image_size.width : image_size.height;
+    for (int scale : {8, 4, 2}) {
+        if (long_side / scale >= min_side) {
+            return scale;
+        }
+    }
+    return 1;
+}
+
+bool ImageLoader::load(const std::string& path, const ReducedDecodeConfig& config, cv::Mat& image,
+                       std::shared_ptr<const ReducedImageSource>& source, std::string& error) {
+    source.reset();
+    std::shared_ptr<MappedFile> file = MappedFile::open(path, error);
+    if (!file) {
+        // 与 cv::imread 失败时的错误信息保持一致，客户端可能依赖该文本
+        error = "Failed to load image from path: " + path;
+        return false;
+    }
+    return decode(std::move(file), path, config, image, source, error);
+}
+
+bool ImageLoader::decode(std::shared_ptr<MappedFile> file, const std::string& path, const ReducedDecodeConfig& config,
+                         cv::Mat& image, std::shared_ptr<const ReducedImageSource>& source, std::string& error) {
+    source.reset();
+    if (file->size() > static_cast<size_t>(INT_MAX)) {
+        error = "Image file too large: " + path;
+        return false;
+    }
+
+    cv::Size jpeg_size;
+    int scale = 1;
+    if (config.enabled && probeJpegSize(file->data(), file->size(), jpeg_size)) {
+        scale = chooseScale(jpeg_size, config.min_side);
+    }
+
+    if (scale > 1) {
+        auto reduced = std::make_shared<ReducedImageSource>();
+        reduced->file = file;
+        reduced->scale = scale;
+        image = reduced->decodeAt(scale);
+        if (!image.empty()) {
+            reduced->original_size = jpeg_size;
+            // 解码时已按 EXIF 方向旋转：缩小图与帧头宽高对调时原图尺寸也对调
+            int expected_cols = (jpeg_size.width + scale - 1) / scale;
+            int rotated_cols = (jpeg_size.height + scale - 1) / scale;
+            if (std::abs(image.cols - expected_cols) > 1 && std::abs(image.cols - rotated_cols) <= 1) {
+                std::swap(reduced->original_size.width, reduced->original_size.height);
+            }
+            source = std::move(reduced);
+            return true;
+        }
+    }
+
+    image = cv::imdecode(file->view(), cv::IMREAD_COLOR);
+    if (image.empty()) {
+        error = "Failed to load image from path: " + path;
+        return false;
+    }
+    return true;
+}
+
+} // namespace PaddleOCR
@@ -0,0 +1,226 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <paddle_ocr/inference_backend.h>
+#include <paddle_ocr/utility.h>
+#ifndef PADDLE_OCR_NO_PADDLE
+#include <paddle_inference/paddle_inference_api.h>
+#endif
+
+#include <iostream>
+
+namespace PaddleOCR {
+
+#ifndef PADDLE_OCR_NO_PADDLE
+
+namespace {
+
+class PaddleBackend : public InferenceBackend {
+public:
+  PaddleBackend(std::shared_ptr<paddle_infer::Predictor> predictor,
+                const std::string &precision) noexcept
+      : predictor_(std::move(predictor)), precision_(precision) {
+    this->input_ =
+        this->predictor_->GetInputHandle(this->predictor_->GetInputNames()[0]);
+    this->output_ = this->predictor_->GetOutputHandle(
+        this->predictor_->GetOutputNames()[0]);
+  }
+
+  void Reshape(const std::vector<int> &shape) noexcept override {
+    this->input_->Reshape(shape);
+  }
+
+  void CopyFromCpu(const float *data) noexcept override {
+    this->input_->CopyFromCpu(data);
+  }
+
+  bool Run() noexcept override { return this->predictor_->Run(); }
+
+  std::vector<int> OutputShape() noexcept override {
+    return this->output_->shape();
+  }
+
+  void CopyToCpu(float *data) noexcept override {
+    this->output_->CopyToCpu(data);
+  }
+
+  std::unique_ptr<InferenceBackend> Clone() noexcept override {
+    return std::make_unique<PaddleBackend>(this->predictor_->Clone(),
+                                           this->precision_);
+  }
+
+  std::string Name() const noexcept override { return "paddle"; }
+
+  const std::string &EffectivePrecision() const noexcept override {
+    return this->precision_;
+  }
+
+private:
+  std::shared_ptr<paddle_infer::Predictor> predictor_;
+  std::unique_ptr<paddle_infer::Tensor> input_;
+  std::unique_ptr<paddle_infer::Tensor> output_;
+  std::string precision_;
+};
+
+} // namespace
+
+std::unique_ptr<InferenceBackend>
+CreatePaddleBackend(const InferenceOptions &options) noexcept {
+  paddle_infer::Config config;
+  bool json_model = false;
+  std::string model_file_path, param_file_path;
+  // CPU int8 runs the quantized model written by scripts/quantize_models.py
+  // to <model_dir>/int8; without it the fp32 model is used.
+  std::string load_dir = options.model_dir;
+  bool use_int8 = false;
+  if (!options.use_gpu && options.precision == "int8") {
+    if (Utility::PathExists(options.model_dir + "/int8")) {
+      load_dir = options.model_dir + "/int8";
+      use_int8 = true;
+    } else {
+      std::cerr << "[WARNING] No int8 model found in " << options.model_dir
+                << "/int8, falling back to fp32" << std::endl;
+    }
+  }
+  std::vector<std::pair<std::string, std::string>> model_variants = {
+      {"/inference.json", "/inference.pdiparams"},
+      {"/model.json", "/model.pdiparams"},
+      {"/inference.pdmodel", "/inference.pdiparams"},
+      {"/model.pdmodel", "/model.pdiparams"}};
+  for (const auto &variant : model_variants) {
+    if (Utility::PathExists(load_dir + variant.first)) {
+      model_file_path = load_dir + variant.first;
+      param_file_path = load_dir + variant.second;
+      json_model = (variant.first.find(".json") != std::string::npos);
+      break;
+    }
+  }
+  if (model_file_path.empty()) {
+    std::cerr << "[ERROR] No valid model file found in " << load_dir
+              << std::endl;
+    exit(1);
+  }
+  config.SetModel(model_file_path, param_file_path);
+  std::string effective_precision = "fp32";
+  if (options.use_gpu) {
+    config.EnableUseGpu(options.gpu_mem, options.gpu_id);
+    if (options.use_tensorrt) {
+      auto precision = paddle_infer::Config::Precision::kFloat32;
+      if (options.precision == "fp16") {
+        precision = paddle_infer::Config::Precision::kHalf;
+      }
+      if (options.precision == "int8") {
+        precision = paddle_infer::Config::Precision::kInt8;
+      }
+      effective_precision = options.precision;
+      if (options.trt_engine) {
+        config.EnableTensorRtEngine(options.trt_workspace_size,
+                                    options.trt_max_batch_size,
+                                    options.trt_min_subgraph_size, precision,
+                                    false, false);
+      }
+      if (!Utility::PathExists(options.trt_shape_file)) {
+        config.CollectShapeRangeInfo(options.trt_shape_file);
+      } else {
+        config.EnableTunedTensorRtDynamicShape(options.trt_shape_file, true);
+      }
+    }
+  } else {
+    config.DisableGpu();
+    // bf16 is only requested on CPUs with AVX512-BF16/AMX-BF16, see
+    // CPUFeatures::resolvePrecision
+    bool use_bf16 = options.precision == "bf16";
+    if (options.use_mkldnn || use_int8 || use_bf16) {
+      config.EnableMKLDNN();
+      if (options.mkldnn_cache_capacity > 0) {
+        // cache a bounded number of shapes for mkldnn to avoid memory leak
+        config.SetMkldnnCacheCapacity(options.mkldnn_cache_capacity);
+      }
+      if (use_int8) {
+        // turns the fake quant/dequant ops of the quantized model into
+        // oneDNN int8 kernels (VNNI on supporting CPUs)
+        config.EnableMkldnnInt8();
+      }
+      if (use_bf16) {
+        config.EnableMkldnnBfloat16();
+      }
+      effective_precision = use_int8 ? "int8" : (use_bf16 ? "bf16" : "fp32");
+    } else {
+      config.DisableMKLDNN();
+    }
+    config.SetCpuMathLibraryNumThreads(options.cpu_math_library_num_threads);
+    if (json_model) {
+      config.EnableNewIR();
+      config.EnableNewExecutor();
+    }
+  }
+
+  if (!options.deleted_passes.empty()) {
+    auto pass_builder = config.pass_builder();
+    for (const auto &pass : options.deleted_passes) {
+      pass_builder->DeletePass(pass);
+    }
+  }
+  // use zero_copy_run as default
+  config.SwitchUseFeedFetchOps(false);
+  // true for multiple input
+  config.SwitchSpecifyInputNames(true);
+
+  config.SwitchIrOptim(true);
+
+  config.EnableMemoryOptim();
+  if (options.disable_glog_info) {
+    config.DisableGlogInfo();
+  }
+  std::cout << "[INFO] Using " << options.model_name
+            << " Model: " << model_file_path << ", param: " << param_file_path
+            << std::endl;
+  return std::make_unique<PaddleBackend>(paddle_infer::CreatePredictor(config),
+                                         effective_precision);
+}
+
+#endif // PADDLE_OCR_NO_PADDLE
+
+std::unique_ptr<InferenceBackend>
+CreateInferenceBackend(const std::string &type,
+                       const InferenceOptions &options) noexcept {
+  if (type == "mock" || type.rfind("mock:", 0) == 0) {
+    return CreateMockBackend(options, type.size() > 5 ? type.substr(5) : "");
+  }
+  if (type == "onnxruntime") {
+#ifdef PADDLE_OCR_WITH_ORT
+    auto backend = CreateOrtBackend(options);
+    if (backend) {
+      return backend;
+    }
+    std::cerr << "[WARNING] No ONNX model found in " << options.model_dir
+              << ", falling back to paddle" << std::endl;
+#else
+    std::cerr << "[WARNING] Built without ONNX Runtime (PADDLE_OCR_WITH_ORT), "
+              << options.model_name << " falls back to paddle" << std::endl;
+#endif
+  } else if (type != "paddle") {
+    std::cerr << "[WARNING] Unknown inference backend '" << type
+              << "', using paddle" << std::endl;
+  }
+#ifdef PADDLE_OCR_NO_PADDLE
+  std::cerr << "[WARNING] Built without Paddle Inference (PADDLE_OCR_NO_PADDLE), "
+            << options.model_name << " uses the mock backend" << std::endl;
+  return CreateMockBackend(options, "");
+#else
+  return CreatePaddleBackend(options);
+#endif
+}
+
+} // namespace PaddleOCR
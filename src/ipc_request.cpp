@@ -0,0 +1,438 @@
+#include "paddle_ocr/ipc_request.h"
+#include <charconv>
+#include <cstring>
+
+namespace PaddleOCR {
+
+namespace {
+
+constexpr int kMaxDepth = 1000;  // 与 JsonCpp 默认 stackLimit 一致
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+char* writeUtf8(char* out, unsigned int cp) {
+    if (cp < 0x80) {
+        *out++ = static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        *out++ = static_cast<char>(0xC0 | (cp >> 6));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        *out++ = static_cast<char>(0xE0 | (cp >> 12));
+        *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        *out++ = static_cast<char>(0xF0 | (cp >> 18));
+        *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    return out;
+}
+
+/**
+ * @brief 单遍扫描的解析游标
+ */
+struct Cursor {
+    char* p;
+    char* end;
+    std::string error;
+
+    bool fail(const char* message) {
+        error = message;
+        return false;
+    }
+
+    void skipWhitespace() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+            ++p;
+        }
+    }
+
+    bool readHex4(unsigned int& value) {
+        if (end - p < 4) {
+            return fail("Bad unicode escape sequence in string");
+        }
+        value = 0;
+        for (int i = 0; i < 4; ++i) {
+            int digit = hexValue(p[i]);
+            if (digit < 0) {
+                return fail("Bad unicode escape sequence in string");
+            }
+            value = (value << 4) | static_cast<unsigned int>(digit);
+        }
+        p += 4;
+        return true;
+    }
+
+    /**
+     * @brief 解析字符串，p 指向开头的引号
+     * @param out 非空时在原位置反转义并输出视图；为空时只校验 (嵌套容器的原始文本须保持完整)
+     */
+    bool parseString(std::string_view* out) {
+        char* begin = ++p;
+        // 快速路径：没有转义时只需找到结束引号 (Base64 数据总是走这里)
+        while (p < end && *p != '"' && *p != '\\') {
+            ++p;
+        }
+        if (p == end) {
+            return fail("Missing '\"' at end of string");
+        }
+        if (*p == '"') {
+            if (out) {
+                *out = std::string_view(begin, static_cast<size_t>(p - begin));
+            }
+            ++p;
+            return true;
+        }
+
+        char* write = p;
+        auto put = [&](char c) {
+            if (out) {
+                *write = c;
+            }
+            ++write;
+        };
+        while (p < end) {
+            char c = *p++;
+            if (c == '"') {
+                if (out) {
+                    *out = std::string_view(begin, static_cast<size_t>(write - begin));
+                }
+                return true;
+            }
+            if (c != '\\') {
+                put(c);
+                continue;
+            }
+            if (p == end) {
+                break;
+            }
+            char escape = *p++;
+            switch (escape) {
+            case '"':  put('"'); break;
+            case '\\': put('\\'); break;
+            case '/':  put('/'); break;
+            case 'b':  put('\b'); break;
+            case 'f':  put('\f'); break;
+            case 'n':  put('\n'); break;
+            case 'r':  put('\r'); break;
+            case 't':  put('\t'); break;
+            case 'u': {
+                unsigned int cp = 0;
+                if (!readHex4(cp)) {
+                    return false;
+                }
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    unsigned int low = 0;
+                    if (end - p < 2 || p[0] != '\\' || p[1] != 'u') {
+                        return fail("Missing second half of a unicode surrogate pair");
+                    }
+                    p += 2;
+                    if (!readHex4(low)) {
+                        return false;
+                    }
+                    if (low < 0xDC00 || low > 0xDFFF) {
+                        return fail("Bad second half of a unicode surrogate pair");
+                    }
+                    cp = 0x10000 + ((cp & 0x3FF) << 10) + (low & 0x3FF);
+                }
+                // 转义序列至少 6 字节，UTF-8 编码至多 4 字节，写指针不会越过读指针
+                if (out) {
+                    write = writeUtf8(write, cp);
+                }
+                break;
+            }
+            default:
+                return fail("Bad escape sequence in string");
+            }
+        }
+        return fail("Missing '\"' at end of string");
+    }
+
+    bool parseNumber() {
+        char* begin = p;
+        if (p < end && *p == '-') {
+            ++p;
+        }
+        char* digits = p;
+        while (p < end && *p >= '0' && *p <= '9') {
+            ++p;
+        }
+        if (p == digits) {
+            return fail("Syntax error: value, object or array expected.");
+        }
+        if (p < end && *p == '.') {
+            digits = ++p;
+            while (p < end && *p >= '0' && *p <= '9') {
+                ++p;
+            }
+            if (p == digits) {
+                return fail("Bad number");
+            }
+        }
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            ++p;
+            if (p < end && (*p == '+' || *p == '-')) {
+                ++p;
+            }
+            digits = p;
+            while (p < end && *p >= '0' && *p <= '9') {
+                ++p;
+            }
+            if (p == digits) {
+                return fail("Bad number");
+            }
+        }
+        return p > begin;
+    }
+
+    bool parseLiteral(const char* literal) {
+        size_t len = std::strlen(literal);
+        if (static_cast<size_t>(end - p) < len || std::memcmp(p, literal, len) != 0) {
+            return fail("Syntax error: value, object or array expected.");
+        }
+        p += len;
+        return true;
+    }
+
+    /**
+     * @brief 解析任意值；顶层字符串原地反转义，其他值只校验语法，value 为其原始文本
+     */
+    bool parseValue(IPCRequest::Type& type, std::string_view& value, int depth, bool in_situ) {
+        if (depth > kMaxDepth) {
+            return fail("Exceeded stackLimit in readValue().");
+        }
+        skipWhitespace();
+        if (p == end) {
+            return fail("Syntax error: value, object or array expected.");
+        }
+        char* begin = p;
+        bool ok = false;
+        switch (*p) {
+        case '"':
+            type = IPCRequest::Type::String;
+            if (in_situ) {
+                return parseString(&value);
+            }
+            ok = parseString(nullptr);
+            break;
+        case '{':
+            type = IPCRequest::Type::Object;
+            ok = skipContainer('}', depth);
+            break;
+        case '[':
+            type = IPCRequest::Type::Array;
+            ok = skipContainer(']', depth);
+            break;
+        case 't':
+            type = IPCRequest::Type::Bool;
+            ok = parseLiteral("true");
+            break;
+        case 'f':
+            type = IPCRequest::Type::Bool;
+            ok = parseLiteral("false");
+            break;
+        case 'n':
+            type = IPCRequest::Type::Null;
+            ok = parseLiteral("null");
+            break;
+        default:
+            type = IPCRequest::Type::Number;
+            ok = parseNumber();
+            break;
+        }
+        if (ok) {
+            value = std::string_view(begin, static_cast<size_t>(p - begin));
+        }
+        return ok;
+    }
+
+    /**
+     * @brief 跳过嵌套的对象或数组，p 指向开头的括号
+     */
+    bool skipContainer(char close, int depth) {
+        bool is_object = close == '}';
+        ++p;
+        skipWhitespace();
+        if (p < end && *p == close) {
+            ++p;
+            return true;
+        }
+        while (true) {
+            std::string_view ignored;
+            IPCRequest::Type type;
+            skipWhitespace();
+            if (p < end && *p == close) {
+                // 结尾多余的逗号，JsonCpp 默认允许
+                ++p;
+                return true;
+            }
+            if (is_object) {
+                if (p == end || *p != '"') {
+                    return fail("Missing '}' or object member name");
+                }
+                if (!parseString(nullptr)) {
+                    return false;
+                }
+                skipWhitespace();
+                if (p == end || *p != ':') {
+                    return fail("Missing ':' after object member name");
+                }
+                ++p;
+            }
+            if (!parseValue(type, ignored, depth + 1, false)) {
+                return false;
+            }
+            skipWhitespace();
+            if (p == end) {
+                return fail(is_object ? "Missing ',' or '}' in object declaration"
+                                      : "Missing ',' or ']' in array declaration");
+            }
+            if (*p == close) {
+                ++p;
+                return true;
+            }
+            if (*p != ',') {
+                return fail(is_object ? "Missing ',' or '}' in object declaration"
+                                      : "Missing ',' or ']' in array declaration");
+            }
+            ++p;
+        }
+    }
+};
+
+} // namespace
+
+bool IPCRequest::parseInSitu(char* data, size_t size, std::string& error) {
+    members_.clear();
+    Cursor cursor{data, data + size, {}};
+
+    cursor.skipWhitespace();
+    if (cursor.p == cursor.end || *cursor.p != '{') {
+        error = "Request must be a JSON object";
+        return false;
+    }
+    ++cursor.p;
+
+    while (true) {
+        Member member;
+        cursor.skipWhitespace();
+        if (cursor.p < cursor.end && *cursor.p == '}') {
+            return true;  // 结尾多余的逗号
+        }
+        if (cursor.p == cursor.end || *cursor.p != '"') {
+            error = "Missing '}' or object member name";
+            return false;
+        }
+        if (!cursor.parseString(&member.key)) {
+            error = cursor.error;
+            return false;
+        }
+        cursor.skipWhitespace();
+        if (cursor.p == cursor.end || *cursor.p != ':') {
+            error = "Missing ':' after object member name";
+            return false;
+        }
+        ++cursor.p;
+        if (!cursor.parseValue(member.type, member.value, 1, true)) {
+            error = cursor.error;
+            return false;
+        }
+        members_.push_back(member);
+
+        cursor.skipWhitespace();
+        if (cursor.p < cursor.end && *cursor.p == '}') {
+            return true;
+        }
+        if (cursor.p == cursor.end || *cursor.p != ',') {
+            error = "Missing ',' or '}' in object declaration";
+            return false;
+        }
+        ++cursor.p;
+    }
+}
+
+const IPCRequest::Member* IPCRequest::find(std::string_view key) const {
+    // 重复的键以最后一个为准，与 JsonCpp 一致
+    for (auto it = members_.rbegin(); it != members_.rend(); ++it) {
+        if (it->key == key) {
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+std::string_view IPCRequest::getString(std::string_view key, std::string_view default_value) const {
+    const Member* member = find(key);
+    if (!member || member->type != Type::String) {
+        return default_value;
+    }
+    return member->value;
+}
+
+bool IPCRequest::getNumber(std::string_view key, double& value) const {
+    const Member* member = find(key);
+    if (!member || member->type != Type::Number) {
+        return false;
+    }
+    const char* end = member->value.data() + member->value.size();
+    auto parsed = std::from_chars(member->value.data(), end, value);
+    return parsed.ec == std::errc() && parsed.ptr == end;
+}
+
+std::string_view IPCRequest::raw(std::string_view key) const {
+    const Member* member = find(key);
+    return member ? member->value : std::string_view();
+}
+
+bool IPCRequest::getNumberArrays(std::string_view key, size_t leaves_per_item, std::vector<double>& values) const {
+    values.clear();
+    const Member* member = find(key);
+    if (!member || member->type != Type::Array) {
+        return false;
+    }
+
+    // 成员文本已通过语法检查，这里只区分数字与其他值，并统计每个顶层元素的数字个数
+    const char* p = member->value.data();
+    const char* end = p + member->value.size();
+    int depth = 0;
+    size_t item_start = 0;
+    while (p < end) {
+        char c = *p;
+        if (c == '[') {
+            if (++depth == 2) {
+                item_start = values.size();
+            }
+            ++p;
+        } else if (c == ']') {
+            if (depth == 2 && values.size() - item_start != leaves_per_item) {
+                return false;
+            }
+            --depth;
+            ++p;
+        } else if (c == ',' || c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            ++p;
+        } else if (c == '-' || (c >= '0' && c <= '9')) {
+            if (depth < 2) {
+                return false;  // 顶层元素必须是数组
+            }
+            double value = 0.0;
+            auto parsed = std::from_chars(p, end, value);
+            if (parsed.ec != std::errc()) {
+                return false;
+            }
+            values.push_back(value);
+            p = parsed.ptr;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace PaddleOCR
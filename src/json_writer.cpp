@@ -0,0 +1,144 @@
+#include "paddle_ocr/json_writer.h"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+namespace PaddleOCR {
+
+void JsonWriter::clear() {
+    out_.clear();
+    has_items_.clear();
+    after_key_ = false;
+}
+
+void JsonWriter::separator() {
+    if (after_key_) {
+        after_key_ = false;
+        return;
+    }
+    if (!has_items_.empty()) {
+        if (has_items_.back()) {
+            out_ += ',';
+        }
+        has_items_.back() = true;
+    }
+}
+
+void JsonWriter::beginObject() {
+    separator();
+    out_ += '{';
+    has_items_.push_back(false);
+}
+
+void JsonWriter::endObject() {
+    has_items_.pop_back();
+    out_ += '}';
+}
+
+void JsonWriter::beginArray() {
+    separator();
+    out_ += '[';
+    has_items_.push_back(false);
+}
+
+void JsonWriter::endArray() {
+    has_items_.pop_back();
+    out_ += ']';
+}
+
+void JsonWriter::key(std::string_view name) {
+    separator();
+    appendQuoted(out_, name);
+    out_ += ':';
+    after_key_ = true;
+}
+
+void JsonWriter::value(int v) {
+    value(static_cast<long long>(v));
+}
+
+void JsonWriter::value(long long v) {
+    separator();
+    char buffer[24];
+    auto res = std::to_chars(buffer, buffer + sizeof(buffer), v);
+    out_.append(buffer, res.ptr);
+}
+
+void JsonWriter::value(double v) {
+    separator();
+    appendDouble(out_, v);
+}
+
+void JsonWriter::value(bool v) {
+    separator();
+    out_ += v ? "true" : "false";
+}
+
+void JsonWriter::value(std::string_view v) {
+    separator();
+    appendQuoted(out_, v);
+}
+
+void JsonWriter::null() {
+    separator();
+    out_ += "null";
+}
+
+void JsonWriter::appendQuoted(std::string& out, std::string_view s) {
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+    // 连续的无需转义字节整段追加
+    size_t run_start = 0;
+    for (size_t i = 0; i < s.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        out.append(s.data() + run_start, i - run_start);
+        run_start = i + 1;
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\b': out += "\\b"; break;
+        case '\f': out += "\\f"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            out += "\\u00";
+            out += hex[c >> 4];
+            out += hex[c & 0xF];
+            break;
+        }
+    }
+    out.append(s.data() + run_start, s.size() - run_start);
+    out += '"';
+}
+
+void JsonWriter::appendDouble(std::string& out, double v) {
+    if (!std::isfinite(v)) {
+        out += std::isnan(v) ? "null" : (v < 0 ? "-1e+9999" : "1e+9999");
+        return;
+    }
+    char buffer[36];
+    int len = std::snprintf(buffer, sizeof(buffer), "%.17g", v);
+    if (len <= 0) {
+        return;
+    }
+    bool has_point = false;
+    for (int i = 0; i < len; ++i) {
+        // 与 JsonCpp 一致：非 C locale 下的小数逗号改为小数点
+        if (buffer[i] == ',') {
+            buffer[i] = '.';
+        }
+        if (buffer[i] == '.' || buffer[i] == 'e') {
+            has_point = true;
+        }
+    }
+    out.append(buffer, static_cast<size_t>(len));
+    if (!has_point) {
+        out += ".0";
+    }
+}
+
+} // namespace PaddleOCR
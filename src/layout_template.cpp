@@ -0,0 +1,197 @@
+#include "paddle_ocr/layout_template.h"
+#include <json/json.h>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace PaddleOCR {
+
+namespace {
+
+constexpr double kMinInkContrast = 32.0;  // 区域灰度极差低于该值视为空白
+constexpr int kMinInkPerLine = 2;         // 墨迹投影计数不少于该值的行/列才计入外接框
+
+/**
+ * @brief 在灰度区域内查找文字墨迹外接框 (区域坐标)
+ */
+bool findInk(const cv::Mat& gray, cv::Rect& box) {
+    double min_value = 0.0, max_value = 0.0;
+    cv::minMaxLoc(gray, &min_value, &max_value);
+    if (max_value - min_value < kMinInkContrast) {
+        return false;
+    }
+
+    // 墨迹取少数类，兼容深色字浅色底和浅色字深色底
+    cv::Mat ink;
+    cv::threshold(gray, ink, 0, 255, cv::THRESH_BINARY_INV | cv::THRESH_OTSU);
+    if (cv::countNonZero(ink) * 2 > static_cast<int>(ink.total())) {
+        cv::bitwise_not(ink, ink);
+    }
+
+    cv::Mat col_sum, row_sum;
+    cv::reduce(ink, col_sum, 0, cv::REDUCE_SUM, CV_32S);
+    cv::reduce(ink, row_sum, 1, cv::REDUCE_SUM, CV_32S);
+    auto bounds = [](const cv::Mat& sums, int& first, int& last) {
+        const int* p = sums.ptr<int>();
+        int n = static_cast<int>(sums.total());
+        first = 0;
+        last = n - 1;
+        while (first < n && p[first] < kMinInkPerLine * 255) ++first;
+        while (last > first && p[last] < kMinInkPerLine * 255) --last;
+        return first < n;
+    };
+    int x0, x1, y0, y1;
+    if (!bounds(col_sum, x0, x1) || !bounds(row_sum, y0, y1)) {
+        return false;
+    }
+    box = cv::Rect(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+    return true;
+}
+
+bool readUnit(const Json::Value& value, float& out) {
+    if (!value.isNumeric()) {
+        return false;
+    }
+    out = value.asFloat();
+    return out >= 0.0f && out <= 1.0f;
+}
+
+} // namespace
+
+std::vector<Quad> LayoutTemplate::locate(const cv::Mat& image) const {
+    std::vector<Quad> quads(fields.size(), Quad{});
+    if (image.empty()) {
+        return quads;
+    }
+
+    cv::Mat gray;
+    if (align) {
+        if (image.channels() == 3) {
+            cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+        } else {
+            gray = image;
+        }
+    }
+
+    const cv::Rect bounds(0, 0, image.cols, image.rows);
+    for (size_t i = 0; i < fields.size(); ++i) {
+        const cv::Rect2f& region = fields[i].region;
+        cv::Rect rect(static_cast<int>(std::lround(region.x * image.cols)),
+                      static_cast<int>(std::lround(region.y * image.rows)),
+                      static_cast<int>(std::lround(region.width * image.cols)),
+                      static_cast<int>(std::lround(region.height * image.rows)));
+        rect &= bounds;
+        if (rect.area() <= 0) {
+            continue;
+        }
+
+        if (align) {
+            int margin_x = static_cast<int>(std::lround(align_margin * image.cols));
+            int margin_y = static_cast<int>(std::lround(align_margin * image.rows));
+            cv::Rect search(rect.x - margin_x, rect.y - margin_y,
+                            rect.width + 2 * margin_x, rect.height + 2 * margin_y);
+            search &= bounds;
+            cv::Rect ink;
+            if (!findInk(gray(search), ink)) {
+                continue;
+            }
+            // 与检测框的 unclip 类似，在墨迹四周保留少量边距
+            int pad = std::max(2, ink.height / 6);
+            rect = cv::Rect(search.x + ink.x - pad, search.y + ink.y - pad,
+                            ink.width + 2 * pad, ink.height + 2 * pad) & bounds;
+        }
+
+        int right = rect.x + rect.width - 1;
+        int bottom = rect.y + rect.height - 1;
+        quads[i] = Quad{cv::Point(rect.x, rect.y), cv::Point(right, rect.y),
+                        cv::Point(right, bottom), cv::Point(rect.x, bottom)};
+    }
+    return quads;
+}
+
+bool LayoutTemplateRegistry::load(const std::string& path, std::string& error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = "Failed to open template file: " + path;
+        return false;
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    return parse(content.str(), error);
+}
+
+bool LayoutTemplateRegistry::parse(std::string_view json, std::string& error) {
+    Json::Value root;
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    std::string errors;
+    if (!reader->parse(json.data(), json.data() + json.size(), &root, &errors)) {
+        error = "Invalid template JSON: " + errors;
+        return false;
+    }
+    const Json::Value& templates = root["templates"];
+    if (!templates.isArray()) {
+        error = "Template file must contain a \"templates\" array";
+        return false;
+    }
+
+    std::unordered_map<std::string, std::shared_ptr<const LayoutTemplate>> loaded;
+    for (const auto& item : templates) {
+        auto layout = std::make_shared<LayoutTemplate>();
+        layout->name = item["name"].asString();
+        if (layout->name.empty()) {
+            error = "Template without a name";
+            return false;
+        }
+        layout->align = item.get("align", layout->align).asBool();
+        if (item.isMember("align_margin") && !readUnit(item["align_margin"], layout->align_margin)) {
+            error = "Template " + layout->name + ": align_margin must be within [0, 1]";
+            return false;
+        }
+
+        for (const auto& field_value : item["fields"]) {
+            LayoutField field;
+            field.name = field_value["name"].asString();
+            const Json::Value& box = field_value["box"];
+            float x = 0.0f, y = 0.0f, w = 0.0f, h = 0.0f;
+            if (field.name.empty() || !box.isArray() || box.size() != 4 ||
+                !readUnit(box[0], x) || !readUnit(box[1], y) || !readUnit(box[2], w) || !readUnit(box[3], h) ||
+                w <= 0.0f || h <= 0.0f || x + w > 1.0f + 1e-4f || y + h > 1.0f + 1e-4f) {
+                error = "Template " + layout->name + ": each field needs a name and a relative box [x, y, w, h] inside [0, 1]";
+                return false;
+            }
+            field.region = cv::Rect2f(x, y, w, h);
+            layout->fields.push_back(std::move(field));
+        }
+        if (layout->fields.empty()) {
+            error = "Template " + layout->name + " has no fields";
+            return false;
+        }
+        if (!loaded.emplace(layout->name, std::move(layout)).second) {
+            error = "Duplicate template name: " + item["name"].asString();
+            return false;
+        }
+    }
+
+    templates_ = std::move(loaded);
+    return true;
+}
+
+std::shared_ptr<const LayoutTemplate> LayoutTemplateRegistry::find(std::string_view name) const {
+    auto it = templates_.find(std::string(name));
+    return it != templates_.end() ? it->second : nullptr;
+}
+
+std::vector<std::string> LayoutTemplateRegistry::names() const {
+    std::vector<std::string> result;
+    result.reserve(templates_.size());
+    for (const auto& entry : templates_) {
+        result.push_back(entry.first);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+} // namespace PaddleOCR
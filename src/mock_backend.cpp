@@ -0,0 +1,202 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Mock backend: synthetic but deterministic det/cls/rec outputs so the
+// pipeline around inference (queueing, pre/postprocess, serialization, IPC)
+// can be profiled and tested without Paddle and without model files.
+
+#include <paddle_ocr/inference_backend.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <thread>
+
+namespace PaddleOCR {
+
+namespace {
+
+struct MockLatency {
+  double base_ms = 0.0;       // per Run call
+  double ms_per_mpixel = 0.0; // per million input pixels (N*H*W)
+};
+
+class MockBackend : public InferenceBackend {
+public:
+  MockBackend(const InferenceOptions &options, MockLatency latency) noexcept
+      : model_name_(options.model_name), num_classes_(options.num_classes),
+        precision_(options.precision), latency_(latency) {}
+
+  void Reshape(const std::vector<int> &shape) noexcept override {
+    this->input_shape_ = shape;
+    size_t num = std::accumulate(shape.begin(), shape.end(), size_t(1),
+                                 std::multiplies<size_t>());
+    this->input_.resize(num);
+  }
+
+  void CopyFromCpu(const float *data) noexcept override {
+    std::memcpy(this->input_.data(), data, this->input_.size() * sizeof(float));
+  }
+
+  bool Run() noexcept override {
+    auto start = std::chrono::steady_clock::now();
+    if (this->input_shape_.size() != 4) {
+      return false;
+    }
+    if (this->model_name_ == "Detector") {
+      this->RunDetector();
+    } else if (this->model_name_ == "Classifier") {
+      this->RunClassifier();
+    } else {
+      this->RunRecognizer();
+    }
+
+    // sleep out whatever of the simulated latency synthesis did not use
+    double pixels = double(this->input_.size()) / this->input_shape_[1];
+    double latency_ms = this->latency_.base_ms +
+                        this->latency_.ms_per_mpixel * pixels / 1e6;
+    if (latency_ms > 0.0) {
+      std::this_thread::sleep_until(
+          start + std::chrono::microseconds(int64_t(latency_ms * 1000.0)));
+    }
+    return true;
+  }
+
+  std::vector<int> OutputShape() noexcept override {
+    return this->output_shape_;
+  }
+
+  void CopyToCpu(float *data) noexcept override {
+    std::memcpy(data, this->output_.data(),
+                this->output_.size() * sizeof(float));
+  }
+
+  std::unique_ptr<InferenceBackend> Clone() noexcept override {
+    return std::make_unique<MockBackend>(*this);
+  }
+
+  std::string Name() const noexcept override { return "mock"; }
+
+  const std::string &EffectivePrecision() const noexcept override {
+    return this->precision_;
+  }
+
+private:
+  // [1, 1, H, W] probability map with one band per "text line": lines of
+  // pitch/2 height every pitch rows, spanning the middle 80% of the width
+  void RunDetector() noexcept {
+    int n = this->input_shape_[0];
+    int h = this->input_shape_[2];
+    int w = this->input_shape_[3];
+    this->output_shape_ = {n, 1, h, w};
+    this->output_.assign(size_t(n) * h * w, 0.0f);
+
+    int pitch = std::max(16, h / 8);
+    int x0 = w / 10;
+    int x1 = w - w / 10;
+    for (int b = 0; b < n; ++b) {
+      float *map = this->output_.data() + size_t(b) * h * w;
+      for (int y = 0; y < h; ++y) {
+        int phase = y % pitch;
+        if (phase < pitch / 4 || phase >= pitch * 3 / 4) {
+          continue;
+        }
+        std::fill(map + size_t(y) * w + x0, map + size_t(y) * w + x1, 0.95f);
+      }
+    }
+  }
+
+  // [N, 2]: every crop is label 0 (not rotated)
+  void RunClassifier() noexcept {
+    int n = this->input_shape_[0];
+    this->output_shape_ = {n, 2};
+    this->output_.resize(size_t(n) * 2);
+    for (int b = 0; b < n; ++b) {
+      this->output_[b * 2] = 0.99f;
+      this->output_[b * 2 + 1] = 0.01f;
+    }
+  }
+
+  // [N, W/8, C] one-hot rows. Even steps carry a character picked from a
+  // hash of the crop pixels, odd steps are blank, so the same crop always
+  // decodes to the same text of about W/16 characters.
+  void RunRecognizer() noexcept {
+    int n = this->input_shape_[0];
+    int w = this->input_shape_[3];
+    int steps = std::max(1, w / 8);
+    int classes = this->num_classes_ > 1 ? this->num_classes_ : 97;
+    this->output_shape_ = {n, steps, classes};
+    this->output_.assign(size_t(n) * steps * classes, 0.0f);
+
+    size_t sample_size = this->input_.size() / n;
+    for (int b = 0; b < n; ++b) {
+      const float *sample = this->input_.data() + size_t(b) * sample_size;
+      uint64_t seed = 1469598103934665603ULL; // FNV-1a over a pixel subsample
+      for (size_t i = 0; i < sample_size; i += 61) {
+        uint32_t bits;
+        std::memcpy(&bits, sample + i, sizeof(bits));
+        seed = (seed ^ bits) * 1099511628211ULL;
+      }
+      float *logits = this->output_.data() + size_t(b) * steps * classes;
+      for (int t = 0; t < steps; ++t) {
+        int label = 0;
+        if (t % 2 == 0) {
+          seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+          label = 1 + int((seed >> 33) % uint64_t(classes - 1));
+        }
+        logits[size_t(t) * classes + label] = 0.9f;
+      }
+    }
+  }
+
+  std::string model_name_;
+  int num_classes_ = 0;
+  std::string precision_;
+  MockLatency latency_;
+
+  std::vector<int> input_shape_;
+  std::vector<float> input_;
+  std::vector<int> output_shape_;
+  std::vector<float> output_;
+};
+
+} // namespace
+
+std::unique_ptr<InferenceBackend>
+CreateMockBackend(const InferenceOptions &options,
+                  const std::string &spec) noexcept {
+  MockLatency latency;
+  if (!spec.empty()) {
+    try {
+      size_t colon = spec.find(':');
+      latency.base_ms = std::stod(spec.substr(0, colon));
+      if (colon != std::string::npos) {
+        latency.ms_per_mpixel = std::stod(spec.substr(colon + 1));
+      }
+    } catch (const std::exception &) {
+      std::cerr << "[WARNING] Invalid mock latency '" << spec
+                << "', expected <ms>[:<ms_per_mpixel>]" << std::endl;
+      latency = MockLatency();
+    }
+  }
+  std::cout << "[INFO] " << options.model_name << " uses mock backend ("
+            << latency.base_ms << "ms + " << latency.ms_per_mpixel
+            << "ms/MPixel)" << std::endl;
+  return std::make_unique<MockBackend>(options, latency);
+}
+
+} // namespace PaddleOCR
@@ -1,7 +1,10 @@
 #include <paddle_ocr/ocr_ipc_client.h>
+#include <array>
 #include <iostream>
 #include <chrono>
 #include <json/json.h>
+#include <string>
+#include <vector>
 #ifdef _WIN32
 #include <windows.h>
 #include <io.h>
@@ -36,6 +39,30 @@ void setupConsole() {
 }
 #endif
 
+/**
+ * @brief 解析逗号分隔的 N 个整数，如 "10,20,300,40"
+ */
+template <size_t N>
+bool parseIntList(const std::string& text, std::array<int, N>& values) {
+    size_t pos = 0;
+    for (size_t i = 0; i < N; ++i) {
+        size_t used = 0;
+        try {
+            values[i] = std::stoi(text.substr(pos), &used);
+        } catch (const std::exception&) {
+            return false;
+        }
+        pos += used;
+        if (i + 1 < N) {
+            if (pos >= text.size() || text[pos] != ',') {
+                return false;
+            }
+            ++pos;
+        }
+    }
+    return pos == text.size();
+}
+
 void printUsage() {
     std::wcout << L"OCR IPC Client 1.0.2\n";
     std::wcout << L"Repo: https://github.com/sssxyd/cpp-paddle-ocr\n";
@@ -43,11 +70,23 @@ void printUsage() {
     std::wcout << L"\nOptions:\n";
     std::wcout << L"  --pipe-name <name>    命名管道名称 (默认: \\\\.\\pipe\\ocr_service)\n";
     std::wcout << L"  --timeout <ms>        连接超时时间 (默认: 5000ms)\n";
+    std::wcout << L"  --template <name>     使用服务端注册的版面模板识别 (跳过检测)\n";
+    std::wcout << L"  --roi <x,y,w,h>       只在该区域内检测，可重复指定\n";
+    std::wcout << L"  --detect              只检测文字框，不识别\n";
+    std::wcout << L"  --region <x1,y1,...,x4,y4> 只识别给定的文字框 (跳过检测)，可重复指定\n";
+    std::wcout << L"  --deadline <ms>       截止时间，服务端无法按时完成时立即拒绝\n";
+    std::wcout << L"  --cancel-id <id>      为请求附加 cancel_id，可在另一终端用 --cancel 取消\n";
+    std::wcout << L"  --cancel <id>         取消服务端携带该 cancel_id 的未完成请求\n";
+    std::wcout << L"  --priority <name>     优先级类别，如 interactive、bulk\n";
+    std::wcout << L"  --client-id <id>      客户端标识，同一类别内按客户端公平分配\n";
     std::wcout << L"  --status              获取服务状态信息\n";
     std::wcout << L"  --shutdown            优雅关闭OCR服务\n";
     std::wcout << L"  --help                显示此帮助信息\n";
     std::wcout << L"\n示例:\n";
     std::wcout << L"  ocr-client image.jpg\n";
+    std::wcout << L"  ocr-client --template bank_card card.jpg\n";
+    std::wcout << L"  ocr-client --detect --roi 0,0,500,200 image.jpg\n";
+    std::wcout << L"  ocr-client --region 10,10,200,10,200,40,10,40 image.jpg\n";
     std::wcout << L"  ocr-client --status\n";
     std::wcout << L"  ocr-client --shutdown\n";
     std::wcout << L"  ocr-client --pipe-name \\\\.\\pipe\\ocr_service image.jpg\n";
@@ -63,6 +102,15 @@ int main(int argc, char* argv[]) {
     int timeout_ms = 5000;
     bool get_status = false;
     bool shutdown_service = false;
+    std::string template_name;
+    std::vector<std::array<int, 4>> rois;
+    std::vector<std::array<int, 8>> regions;
+    bool detect_only = false;
+    int deadline_ms = 0;
+    std::string cancel_id;
+    std::string cancel_target;
+    std::string priority;
+    std::string client_id;
     
     // 解析命令行参数
     for (int i = 1; i < argc; ++i) {
@@ -77,6 +125,43 @@ int main(int argc, char* argv[]) {
         }
         else if (arg == "--timeout" && i + 1 < argc) {
             timeout_ms = std::stoi(argv[++i]);
+        }
+        else if (arg == "--template" && i + 1 < argc) {
+            template_name = argv[++i];
+        }
+        else if (arg == "--roi" && i + 1 < argc) {
+            std::array<int, 4> roi;
+            if (!parseIntList(argv[++i], roi)) {
+                std::wcerr << L"Invalid --roi, expected x,y,w,h" << std::endl;
+                return 1;
+            }
+            rois.push_back(roi);
+        }
+        else if (arg == "--region" && i + 1 < argc) {
+            std::array<int, 8> region;
+            if (!parseIntList(argv[++i], region)) {
+                std::wcerr << L"Invalid --region, expected x1,y1,x2,y2,x3,y3,x4,y4" << std::endl;
+                return 1;
+            }
+            regions.push_back(region);
+        }
+        else if (arg == "--deadline" && i + 1 < argc) {
+            deadline_ms = std::stoi(argv[++i]);
+        }
+        else if (arg == "--cancel-id" && i + 1 < argc) {
+            cancel_id = argv[++i];
+        }
+        else if (arg == "--cancel" && i + 1 < argc) {
+            cancel_target = argv[++i];
+        }
+        else if (arg == "--priority" && i + 1 < argc) {
+            priority = argv[++i];
+        }
+        else if (arg == "--client-id" && i + 1 < argc) {
+            client_id = argv[++i];
+        }
+        else if (arg == "--detect") {
+            detect_only = true;
         }        else if (arg == "--status") {
             get_status = true;
         }
@@ -91,7 +176,7 @@ int main(int argc, char* argv[]) {
             return 1;
         }
     }    
-    if (!get_status && !shutdown_service && image_path.empty()) {
+    if (!get_status && !shutdown_service && cancel_target.empty() && image_path.empty()) {
         std::wcerr << L"Error: Image path is required" << std::endl;
         printUsage();
         return 1;
@@ -136,7 +221,10 @@ int main(int argc, char* argv[]) {
             return 1;
         }
         
-        if (get_status) {
+        if (!cancel_target.empty()) {
+            std::string result = client.cancelRequests(cancel_target);
+            std::wcout << utf8ToWideString(result) << std::endl;
+        } else if (get_status) {
             // 获取状态信息
             try {
                 std::string response = client.getServiceStatus();
@@ -169,7 +257,18 @@ int main(int argc, char* argv[]) {
             }
         } else {          
             // 执行OCR识别
-            std::string result = client.recognizeImage(image_path);
+            client.setDeadline(deadline_ms);
+            client.setCancelId(cancel_id);
+            client.setPriority(priority);
+            client.setClientId(client_id);
+            std::string result;
+            if (!regions.empty()) {
+                result = client.recognizeRegions(image_path, regions);
+            } else if (detect_only) {
+                result = client.detectText(image_path, rois);
+            } else {
+                result = client.recognizeImage(image_path, template_name, rois);
+            }
             std::wstring result_wide = utf8ToWideString(result);
             std::wcout << result_wide << std::endl;
         }
@@ -13,14 +13,13 @@
 // limitations under the License.
 
 #include <paddle_ocr/ocr_cls.h>
-#include <paddle_inference/paddle_inference_api.h>
 
 #include <chrono>
 #include <numeric>
 
 namespace PaddleOCR {
 
-void Classifier::Run(const std::vector<cv::Mat> &img_list,
+bool Classifier::Run(const std::vector<cv::Mat> &img_list,
                      std::vector<int> &cls_labels,
                      std::vector<float> &cls_scores,
                      std::vector<double> &times) noexcept {
@@ -38,50 +37,48 @@ void Classifier::Run(const std::vector<cv::Mat> &img_list,
     auto preprocess_start = std::chrono::steady_clock::now();
     int end_img_no = std::min(img_num, beg_img_no + this->cls_batch_num_);
     int batch_num = end_img_no - beg_img_no;
-    // preprocess
-    std::vector<cv::Mat> norm_img_batch;
+    // preprocess: normalize + HWC->CHW straight into the reused batch tensor
+    size_t slot_size =
+        size_t(cls_image_shape[0]) * cls_image_shape[1] * cls_image_shape[2];
+    float *input = this->input_buffer_.resize(batch_num * slot_size);
     for (int ino = beg_img_no; ino < end_img_no; ++ino) {
-      cv::Mat srcimg;
-      img_list[ino].copyTo(srcimg);
-      cv::Mat resize_img;
-      this->resize_op_.Run(srcimg, resize_img, this->use_tensorrt_,
-                           cls_image_shape);
-
-      this->normalize_op_.Run(resize_img, this->mean_, this->scale_,
-                              this->is_scale_);
-      if (resize_img.cols < cls_image_shape[2]) {
-        cv::copyMakeBorder(resize_img, resize_img, 0, 0, 0,
-                           cls_image_shape[2] - resize_img.cols,
-                           cv::BORDER_CONSTANT, cv::Scalar(0, 0, 0));
+      this->resize_op_.Run(img_list[ino], this->resize_img_,
+                           this->use_tensorrt_, cls_image_shape);
+      const cv::Mat &resize_img = this->resize_img_;
+      float *slot = input + (ino - beg_img_no) * slot_size;
+      this->normalize_permute_op_.Run(resize_img, this->mean_, this->scale_,
+                                      this->is_scale_, slot,
+                                      cls_image_shape[2]);
+      // cls pads with zeros after normalization
+      int pad_from = std::min(resize_img.cols, cls_image_shape[2]);
+      for (int row = 0; row < cls_image_shape[0] * cls_image_shape[1]; ++row) {
+        float *line = slot + size_t(row) * cls_image_shape[2];
+        std::fill(line + pad_from, line + cls_image_shape[2], 0.0f);
       }
-      norm_img_batch.emplace_back(std::move(resize_img));
     }
-    std::vector<float> input(batch_num * cls_image_shape[0] *
-                                 cls_image_shape[1] * cls_image_shape[2],
-                             0.0f);
-    this->permute_op_.Run(norm_img_batch, input.data());
     auto preprocess_end = std::chrono::steady_clock::now();
     preprocess_diff += preprocess_end - preprocess_start;
 
     // inference.
-    auto input_names = this->predictor_->GetInputNames();
-    auto input_t = this->predictor_->GetInputHandle(input_names[0]);
-    input_t->Reshape({batch_num, cls_image_shape[0], cls_image_shape[1],
-                      cls_image_shape[2]});
+    this->backend_->Reshape({batch_num, cls_image_shape[0], cls_image_shape[1],
+                             cls_image_shape[2]});
     auto inference_start = std::chrono::steady_clock::now();
-    input_t->CopyFromCpu(input.data());
-    this->predictor_->Run();
+    this->backend_->CopyFromCpu(input);
+    if (!this->backend_->Run()) {
+      return false;
+    }
 
-    std::vector<float> predict_batch;
-    auto output_names = this->predictor_->GetOutputNames();
-    auto output_t = this->predictor_->GetOutputHandle(output_names[0]);
-    auto predict_shape = output_t->shape();
+    // expects batch x labels
+    auto predict_shape = this->backend_->OutputShape();
+    if (predict_shape.size() != 2 || predict_shape[0] != batch_num) {
+      return false;
+    }
 
-    int out_num = std::accumulate(predict_shape.begin(), predict_shape.end(), 1,
-                                  std::multiplies<int>());
-    predict_batch.resize(out_num);
+    size_t out_num = std::accumulate(predict_shape.begin(), predict_shape.end(),
+                                     size_t(1), std::multiplies<size_t>());
+    float *predict_batch = this->output_buffer_.resize(out_num);
 
-    output_t->CopyToCpu(predict_batch.data());
+    this->backend_->CopyToCpu(predict_batch);
     auto inference_end = std::chrono::steady_clock::now();
     inference_diff += inference_end - inference_start;
 
@@ -103,74 +100,26 @@ void Classifier::Run(const std::vector<cv::Mat> &img_list,
   times.emplace_back(preprocess_diff.count() * 1000);
   times.emplace_back(inference_diff.count() * 1000);
   times.emplace_back(postprocess_diff.count() * 1000);
+  return true;
 }
 
 void Classifier::LoadModel(const std::string &model_dir) noexcept {
-  paddle_infer::Config config;
-  bool json_model = false;
-  std::string model_file_path, param_file_path;
-  std::vector<std::pair<std::string, std::string>> model_variants = {
-      {"/inference.json", "/inference.pdiparams"},
-      {"/model.json", "/model.pdiparams"},
-      {"/inference.pdmodel", "/inference.pdiparams"},
-      {"/model.pdmodel", "/model.pdiparams"}};
-  for (const auto &variant : model_variants) {
-    if (Utility::PathExists(model_dir + variant.first)) {
-      model_file_path = model_dir + variant.first;
-      param_file_path = model_dir + variant.second;
-      json_model = (variant.first.find(".json") != std::string::npos);
-      break;
-    }
-  }
-  if (model_file_path.empty()) {
-    std::cerr << "[ERROR] No valid model file found in " << model_dir
-              << std::endl;
-    exit(1);
-  }
-  config.SetModel(model_file_path, param_file_path);
-  if (this->use_gpu_) {
-    config.EnableUseGpu(this->gpu_mem_, this->gpu_id_);
-    if (this->use_tensorrt_) {
-      auto precision = paddle_infer::Config::Precision::kFloat32;
-      if (this->precision_ == "fp16") {
-        precision = paddle_infer::Config::Precision::kHalf;
-      }
-      if (this->precision_ == "int8") {
-        precision = paddle_infer::Config::Precision::kInt8;
-      }
-      config.EnableTensorRtEngine(1 << 20, 10, 3, precision, false, false);
-      if (!Utility::PathExists("./trt_cls_shape.txt")) {
-        config.CollectShapeRangeInfo("./trt_cls_shape.txt");
-      } else {
-        config.EnableTunedTensorRtDynamicShape("./trt_cls_shape.txt", true);
-      }
-    }
-  } else {
-    config.DisableGpu();
-    if (this->use_mkldnn_) {
-      config.EnableMKLDNN();
-    } else {
-      config.DisableMKLDNN();
-    }
-    config.SetCpuMathLibraryNumThreads(this->cpu_math_library_num_threads_);
-    if (json_model) {
-      config.EnableNewIR();
-      config.EnableNewExecutor();
-    }
-  }
-
-  // false for zero copy tensor
-  config.SwitchUseFeedFetchOps(false);
-  // true for multiple input
-  config.SwitchSpecifyInputNames(true);
-
-  config.SwitchIrOptim(true);
-
-  config.EnableMemoryOptim();
-  config.DisableGlogInfo();
-
-  std::cout << "[INFO] Using Classifier Model: " << model_file_path
-            << ", param: " << param_file_path << std::endl;
-  this->predictor_ = paddle_infer::CreatePredictor(config);
+  InferenceOptions options;
+  options.model_dir = model_dir;
+  options.model_name = "Classifier";
+  options.use_gpu = this->use_gpu_;
+  options.gpu_id = this->gpu_id_;
+  options.gpu_mem = this->gpu_mem_;
+  options.cpu_math_library_num_threads = this->cpu_math_library_num_threads_;
+  options.use_mkldnn = this->use_mkldnn_;
+  options.use_tensorrt = this->use_tensorrt_;
+  options.precision = this->precision_;
+  options.trt_workspace_size = 1 << 20;
+  options.trt_max_batch_size = 10;
+  options.trt_min_subgraph_size = 3;
+  options.trt_shape_file = "./trt_cls_shape.txt";
+  options.disable_glog_info = true;
+  options.num_classes = 2;
+  this->backend_ = CreateInferenceBackend(this->backend_type_, options);
 }
 } // namespace PaddleOCR
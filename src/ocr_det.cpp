@@ -13,7 +13,6 @@
 // limitations under the License.
 
 #include <paddle_ocr/ocr_det.h>
-#include <paddle_inference/paddle_inference_api.h>
 
 #include <chrono>
 #include <numeric>
@@ -21,115 +20,69 @@
 namespace PaddleOCR {
 
 void DBDetector::LoadModel(const std::string &model_dir) noexcept {
-  //   AnalysisConfig config;
-  paddle_infer::Config config;
-  bool json_model = false;
-  std::string model_file_path, param_file_path;
-  std::vector<std::pair<std::string, std::string>> model_variants = {
-      {"/inference.json", "/inference.pdiparams"},
-      {"/model.json", "/model.pdiparams"},
-      {"/inference.pdmodel", "/inference.pdiparams"},
-      {"/model.pdmodel", "/model.pdiparams"}};
-  for (const auto &variant : model_variants) {
-    if (Utility::PathExists(model_dir + variant.first)) {
-      model_file_path = model_dir + variant.first;
-      param_file_path = model_dir + variant.second;
-      json_model = (variant.first.find(".json") != std::string::npos);
-      break;
-    }
-  }
-  if (model_file_path.empty()) {
-    std::cerr << "[ERROR] No valid model file found in " << model_dir
-              << std::endl;
-    exit(1);
-  }
-  config.SetModel(model_file_path, param_file_path);
-  if (this->use_gpu_) {
-    config.EnableUseGpu(this->gpu_mem_, this->gpu_id_);
-    if (this->use_tensorrt_) {
-      auto precision = paddle_infer::Config::Precision::kFloat32;
-      if (this->precision_ == "fp16") {
-        precision = paddle_infer::Config::Precision::kHalf;
-      }
-      if (this->precision_ == "int8") {
-        precision = paddle_infer::Config::Precision::kInt8;
-      }
-      config.EnableTensorRtEngine(1 << 30, 1, 20, precision, false, false);
-      if (!Utility::PathExists("./trt_det_shape.txt")) {
-        config.CollectShapeRangeInfo("./trt_det_shape.txt");
-      } else {
-        config.EnableTunedTensorRtDynamicShape("./trt_det_shape.txt", true);
-      }
-    }
-  } else {
-    config.DisableGpu();
-    if (this->use_mkldnn_) {
-      config.EnableMKLDNN();
-      // cache 10 different shapes for mkldnn to avoid memory leak
-      config.SetMkldnnCacheCapacity(10);
-    } else {
-      config.DisableMKLDNN();
-    }
-    config.SetCpuMathLibraryNumThreads(this->cpu_math_library_num_threads_);
-    if (json_model) {
-      config.EnableNewIR();
-      config.EnableNewExecutor();
-    }
-  }
-  // use zero_copy_run as default
-  config.SwitchUseFeedFetchOps(false);
-  // true for multiple input
-  config.SwitchSpecifyInputNames(true);
-
-  config.SwitchIrOptim(true);
-
-  config.EnableMemoryOptim();
-  // config.DisableGlogInfo();
-  std::cout << "[INFO] Using Detector Model: " << model_file_path
-            << ", param: " << param_file_path << std::endl;
-  this->predictor_ = paddle_infer::CreatePredictor(config);
+  InferenceOptions options;
+  options.model_dir = model_dir;
+  options.model_name = "Detector";
+  options.use_gpu = this->use_gpu_;
+  options.gpu_id = this->gpu_id_;
+  options.gpu_mem = this->gpu_mem_;
+  options.cpu_math_library_num_threads = this->cpu_math_library_num_threads_;
+  options.use_mkldnn = this->use_mkldnn_;
+  // cache 10 different shapes for mkldnn to avoid memory leak
+  options.mkldnn_cache_capacity = 10;
+  options.use_tensorrt = this->use_tensorrt_;
+  options.precision = this->precision_;
+  options.trt_workspace_size = 1 << 30;
+  options.trt_max_batch_size = 1;
+  options.trt_min_subgraph_size = 20;
+  options.trt_shape_file = "./trt_det_shape.txt";
+  this->backend_ = CreateInferenceBackend(this->backend_type_, options);
 }
 
-void DBDetector::Run(const cv::Mat &img,
-                     std::vector<std::vector<std::vector<int>>> &boxes,
+bool DBDetector::Run(const cv::Mat &img,
+                     std::vector<Quad> &boxes,
                      std::vector<double> &times) noexcept {
+  return this->Run(img, boxes, times, this->limit_side_len_);
+}
+
+bool DBDetector::Run(const cv::Mat &img,
+                     std::vector<Quad> &boxes,
+                     std::vector<double> &times, int limit_side_len) noexcept {
+  boxes.clear();
   float ratio_h{};
   float ratio_w{};
 
-  cv::Mat srcimg;
-  cv::Mat resize_img;
-  img.copyTo(srcimg);
-
   auto preprocess_start = std::chrono::steady_clock::now();
-  this->resize_op_.Run(img, resize_img, this->limit_type_,
-                       this->limit_side_len_, ratio_h, ratio_w,
-                       this->use_tensorrt_);
-
-  this->normalize_op_.Run(resize_img, this->mean_, this->scale_,
-                          this->is_scale_);
-
-  std::vector<float> input(1 * 3 * resize_img.rows * resize_img.cols, 0.0f);
-  this->permute_op_.Run(resize_img, input.data());
+  this->resize_op_.Run(img, this->resize_img_, this->limit_type_,
+                       limit_side_len, ratio_h, ratio_w, this->use_tensorrt_);
+  const cv::Mat &resize_img = this->resize_img_;
+
+  // normalize + HWC->CHW straight into the reused input tensor
+  float *input = this->input_buffer_.resize(size_t(3) * resize_img.rows *
+                                            resize_img.cols);
+  this->normalize_permute_op_.Run(resize_img, this->mean_, this->scale_,
+                                  this->is_scale_, input, resize_img.cols);
   auto preprocess_end = std::chrono::steady_clock::now();
 
   // Inference.
-  auto input_names = this->predictor_->GetInputNames();
-  auto input_t = this->predictor_->GetInputHandle(input_names[0]);
-  input_t->Reshape({1, 3, resize_img.rows, resize_img.cols});
+  this->backend_->Reshape({1, 3, resize_img.rows, resize_img.cols});
   auto inference_start = std::chrono::steady_clock::now();
-  input_t->CopyFromCpu(input.data());
+  this->backend_->CopyFromCpu(input);
 
-  this->predictor_->Run();
+  if (!this->backend_->Run()) {
+    return false;
+  }
 
-  std::vector<float> out_data;
-  auto output_names = this->predictor_->GetOutputNames();
-  auto output_t = this->predictor_->GetOutputHandle(output_names[0]);
-  std::vector<int> output_shape = output_t->shape();
-  int out_num = std::accumulate(output_shape.begin(), output_shape.end(), 1,
-                                std::multiplies<int>());
+  // expects the 1 x 1 x H x W probability map
+  std::vector<int> output_shape = this->backend_->OutputShape();
+  if (output_shape.size() != 4) {
+    return false;
+  }
+  size_t out_num = std::accumulate(output_shape.begin(), output_shape.end(),
+                                   size_t(1), std::multiplies<size_t>());
 
-  out_data.resize(out_num);
-  output_t->CopyToCpu(out_data.data());
+  float *out_data = this->output_buffer_.resize(out_num);
+  this->backend_->CopyToCpu(out_data);
   auto inference_end = std::chrono::steady_clock::now();
 
   auto postprocess_start = std::chrono::steady_clock::now();
@@ -137,16 +90,15 @@ void DBDetector::Run(const cv::Mat &img,
   int n3 = output_shape[3];
   int n = n2 * n3;
 
-  std::vector<float> pred(n, 0.0);
-  std::vector<unsigned char> cbuf(n, ' ');
-
+  // the first output plane is the probability map, no copy needed
+  this->cbuf_map_.create(n2, n3, CV_8UC1);
+  unsigned char *cbuf = this->cbuf_map_.ptr<unsigned char>();
   for (int i = 0; i < n; ++i) {
-    pred[i] = float(out_data[i]);
     cbuf[i] = (unsigned char)((out_data[i]) * 255);
   }
 
-  cv::Mat cbuf_map(n2, n3, CV_8UC1, (unsigned char *)cbuf.data());
-  cv::Mat pred_map(n2, n3, CV_32F, (float *)pred.data());
+  const cv::Mat &cbuf_map = this->cbuf_map_;
+  cv::Mat pred_map(n2, n3, CV_32F, out_data);
 
   const double threshold = this->det_db_thresh_ * 255;
   const double maxvalue = 255;
@@ -162,7 +114,7 @@ void DBDetector::Run(const cv::Mat &img,
       pred_map, bit_map, this->det_db_box_thresh_, this->det_db_unclip_ratio_,
       this->det_db_score_mode_));
 
-  post_processor_.FilterTagDetRes(boxes, ratio_h, ratio_w, srcimg);
+  post_processor_.FilterTagDetRes(boxes, ratio_h, ratio_w, img);
   auto postprocess_end = std::chrono::steady_clock::now();
 
   std::chrono::duration<float> preprocess_diff =
@@ -173,6 +125,7 @@ void DBDetector::Run(const cv::Mat &img,
   std::chrono::duration<float> postprocess_diff =
       postprocess_end - postprocess_start;
   times.emplace_back(postprocess_diff.count() * 1000);
+  return true;
 }
 
 } // namespace PaddleOCR
@@ -140,10 +140,11 @@ void OCRIPCClient::disconnect() {
     }
 }
 
-std::string OCRIPCClient::recognizeImage(const std::string& image_path) {
-    Json::Value request;
-    request["command"] = "recognize";
-      // 根据文件大小智能选择传输方式
+/**
+ * @brief 按文件大小选择 Base64 或路径方式附加图像
+ */
+static void attachImage(Json::Value& request, const std::string& image_path) {
+    // 根据文件大小智能选择传输方式
     size_t file_size = getFileSize(image_path);
     // 考虑Base64编码开销(+33%)和JSON开销，限制在600KB以内确保能放入1MB缓冲区
     const size_t THRESHOLD = 600 * 1024; // 600KB
@@ -172,6 +173,75 @@ std::string OCRIPCClient::recognizeImage(const std::string& image_path) {
         // 大文件或无法获取文件大小：使用路径传输
         request["image_path"] = image_path;
     }
+}
+
+static Json::Value roisToJson(const std::vector<std::array<int, 4>>& rois) {
+    Json::Value array(Json::arrayValue);
+    for (const auto& roi : rois) {
+        Json::Value item(Json::arrayValue);
+        for (int value : roi) {
+            item.append(value);
+        }
+        array.append(item);
+    }
+    return array;
+}
+
+std::string OCRIPCClient::recognizeImage(const std::string& image_path, const std::string& template_name,
+                                         const std::vector<std::array<int, 4>>& rois) {
+    Json::Value request;
+    request["command"] = "recognize";
+    if (!template_name.empty()) {
+        request["template"] = template_name;
+    }
+    if (!rois.empty()) {
+        request["rois"] = roisToJson(rois);
+    }
+    return sendImageRequest(request, image_path);
+}
+
+std::string OCRIPCClient::detectText(const std::string& image_path, const std::vector<std::array<int, 4>>& rois) {
+    Json::Value request;
+    request["command"] = "detect";
+    if (!rois.empty()) {
+        request["rois"] = roisToJson(rois);
+    }
+    return sendImageRequest(request, image_path);
+}
+
+std::string OCRIPCClient::recognizeRegions(const std::string& image_path,
+                                           const std::vector<std::array<int, 8>>& regions) {
+    Json::Value request;
+    request["command"] = "recognize_regions";
+    Json::Value array(Json::arrayValue);
+    for (const auto& region : regions) {
+        Json::Value quad(Json::arrayValue);
+        for (int k = 0; k < 4; ++k) {
+            Json::Value point(Json::arrayValue);
+            point.append(region[2 * k]);
+            point.append(region[2 * k + 1]);
+            quad.append(point);
+        }
+        array.append(quad);
+    }
+    request["regions"] = array;
+    return sendImageRequest(request, image_path);
+}
+
+std::string OCRIPCClient::sendImageRequest(Json::Value& request, const std::string& image_path) {
+    if (deadline_ms_ > 0) {
+        request["deadline_ms"] = deadline_ms_;
+    }
+    if (!cancel_id_.empty()) {
+        request["cancel_id"] = cancel_id_;
+    }
+    if (!priority_.empty()) {
+        request["priority"] = priority_;
+    }
+    if (!client_id_.empty()) {
+        request["client_id"] = client_id_;
+    }
+    attachImage(request, image_path);
     
     Json::StreamWriterBuilder builder;
     return sendRequest(Json::writeString(builder, request));
@@ -230,6 +300,15 @@ std::string OCRIPCClient::sendShutdownCommand() {
     return sendRequest(request_json);
 }
 
+std::string OCRIPCClient::cancelRequests(const std::string& cancel_id) {
+    Json::Value request;
+    request["command"] = "cancel";
+    request["cancel_id"] = cancel_id;
+    
+    Json::StreamWriterBuilder builder;
+    return sendRequest(Json::writeString(builder, request));
+}
+
 std::string OCRIPCClient::getServiceStatus() {
     Json::Value request;
     request["command"] = "status";
@@ -1,9 +1,17 @@
 #include "paddle_ocr/ocr_ipc_service.h"
+#include "paddle_ocr/rec_batch_planner.h"
+#include "paddle_ocr/cpu_features.h"
+#include "paddle_ocr/buffer_pool.h"
+#include "paddle_ocr/ipc_request.h"
+#include "paddle_ocr/result_cache.h"
+#include "paddle_ocr/rec_cache.h"
 #include <json/json.h>
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <cstring>
 #include <algorithm>
+#include <cmath>
 #include <filesystem>
 #include <future>
 #include <chrono>
@@ -13,40 +21,47 @@
 
 namespace PaddleOCR {
 
-std::vector<uchar> OCRIPCService::base64Decode(const std::string& encoded) {
+bool OCRIPCService::base64Decode(std::string_view encoded, std::vector<uchar>& decoded) {
     if (encoded.empty()) {
-        return {};
+        return false;
     }
     
-    // 计算解码后的最大长度 (大约是输入长度的 3/4)
+    // 计算解码后的最大长度 (大约是输入长度的 3/4)；缓冲区只增不减，稳态下不再分配
     size_t max_out_len = (encoded.size() * 3) / 4 + 1;
+    if (decoded.size() < max_out_len) {
+        decoded.resize(max_out_len);
+    }
     
-    // 分配输出缓冲区
-    std::vector<uchar> decoded(max_out_len);
-    
-    // 执行解码
+    // 直接从接收缓冲区中的视图解码
     size_t actual_out_len = 0;
-    int result = base64_decode(encoded.c_str(), encoded.size(), 
+    int result = base64_decode(encoded.data(), encoded.size(), 
                               reinterpret_cast<char*>(decoded.data()), &actual_out_len, 0);
     
     if (result == 1) {  // 成功
         decoded.resize(actual_out_len);
-        return decoded;
+        return true;
     }
     
-    return {}; // 解码失败
+    return false; // 解码失败
 }
 
-cv::Mat OCRIPCService::base64ToMat(const std::string& base64_string) {
-    std::vector<uchar> data = base64Decode(base64_string);
-    return cv::imdecode(data, cv::IMREAD_COLOR);
+cv::Mat OCRIPCService::base64ToMat(std::string_view base64_string) {
+    // 每个客户端线程复用一块解码缓冲区
+    thread_local std::vector<uchar> data;
+    if (!base64Decode(base64_string, data)) {
+        return cv::Mat();
+    }
+    return cv::imdecode(cv::Mat(1, static_cast<int>(data.size()), CV_8UC1, data.data()), cv::IMREAD_COLOR);
 }
 
 // OCRIPCService 实现
 OCRIPCService::OCRIPCService(const std::string& model_dir, const std::string& pipe_name, 
-                           int gpu_workers, int cpu_workers)
+                           int gpu_workers, int cpu_workers, const OCRWorkerConfig& worker_config)
     : model_dir_(model_dir), pipe_name_(pipe_name),  
-      gpu_workers_(gpu_workers), cpu_workers_(cpu_workers), running_(false), request_counter_(0), 
+      gpu_workers_(gpu_workers), cpu_workers_(cpu_workers), reduced_decode_(worker_config.reduced_decode),
+      admission_(worker_config.admission), scheduling_(worker_config.scheduling), hedging_(worker_config.hedging),
+      cascade_(worker_config.cascade),
+      running_(false), request_counter_(0), 
       total_requests_(0), successful_requests_(0), total_processing_time_(0.0) {
     
     
@@ -54,14 +69,29 @@ OCRIPCService::OCRIPCService(const std::string& model_dir, const std::string& pi
     std::cout << "  Model Directory: " << model_dir_ << std::endl;
     std::cout << "  Pipe Name: " << pipe_name_ << std::endl;
     
+    if (!worker_config.templates_path.empty()) {
+        std::string template_error;
+        if (!templates_.load(worker_config.templates_path, template_error)) {
+            throw std::runtime_error(template_error);
+        }
+        std::cout << "  Layout Templates: " << templates_.size() << std::endl;
+    }
+    
+    if (worker_config.result_cache.enabled) {
+        result_cache_ = std::make_unique<ResultCache>(worker_config.result_cache, [this]() { removeCancelledRequests(); });
+        std::cout << "  Result Cache: " << worker_config.result_cache.max_entries << " entries, "
+                  << (worker_config.result_cache.max_bytes >> 20) << "MB, TTL "
+                  << worker_config.result_cache.ttl_seconds << "s" << std::endl;
+    }
+    
     // 初始化worker
     if (gpu_workers_ > 0) {
         // 使用指定的GPU Worker数量
-        gpu_worker_pool_ = std::make_unique<GPUWorkerPool>(model_dir_, gpu_workers_);
+        gpu_worker_pool_ = std::make_unique<GPUWorkerPool>(model_dir_, gpu_workers_, worker_config);
         std::cout << "  Mode: GPU (" << gpu_workers_ << " Workers)" << std::endl;
     } else {
         // 使用指定的CPU Worker数量
-        cpu_worker_pool_ = std::make_unique<CPUWorkerPool>(model_dir_, cpu_workers_);
+        cpu_worker_pool_ = std::make_unique<CPUWorkerPool>(model_dir_, cpu_workers_, worker_config);
         std::cout << "  Mode: CPU (" << cpu_workers_ << " Workers)" << std::endl;
     }
 }
@@ -238,23 +268,9 @@ void OCRIPCService::handleClientConnection(HANDLE pipe_handle) {
                 continue;
             }
             
-            std::string request(buffer);
-            std::string response = processIPCRequest(request);
-            
-            // 检查是否是shutdown命令
+            // 单次原地解析，image_data 以视图形式直接从接收缓冲区解码
             bool is_shutdown_command = false;
-            try {
-                Json::Value request_json;
-                Json::CharReaderBuilder builder;
-                std::istringstream stream(request);
-                std::string errors;
-                if (Json::parseFromStream(builder, stream, &request_json, &errors)) {
-                    std::string command = request_json.get("command", "").asString();
-                    is_shutdown_command = (command == "shutdown");
-                }
-            } catch (...) {
-                // 忽略解析错误
-            }
+            std::string response = processIPCRequest(buffer, bytes_read, is_shutdown_command, pipe_handle);
             
             DWORD bytes_written;
             if (!WriteFile(pipe_handle, response.c_str(), response.length(), &bytes_written, NULL)) {
@@ -307,14 +323,15 @@ void OCRIPCService::handleClientConnection(HANDLE pipe_handle) {
     std::cout << "[Thread-" << client_thread_id << "] Client connection cleanup completed" << std::endl;
 }
 
-std::string OCRIPCService::processIPCRequest(const std::string& request_json) {
+std::string OCRIPCService::processIPCRequest(char* data, size_t size, bool& is_shutdown, HANDLE client_pipe) {
+    is_shutdown = false;
     try {
-        Json::Value request;
-        Json::CharReaderBuilder builder;
-        std::istringstream stream(request_json);
-        std::string errors;
+        // 与原先 std::string(buffer) 一致，遇到 NUL 即视为结束
+        size = strnlen(data, size);
         
-        if (!Json::parseFromStream(builder, stream, &request, &errors)) {
+        IPCRequest request;
+        std::string errors;
+        if (!request.parseInSitu(data, size, errors)) {
             Json::Value error_response;
             error_response["success"] = false;
             error_response["error"] = "Invalid JSON: " + errors;
@@ -322,49 +339,108 @@ std::string OCRIPCService::processIPCRequest(const std::string& request_json) {
             return Json::writeString(writer_builder, error_response);
         }
         
-        std::string command = request.get("command", "").asString();        
-        if (command == "recognize") {
-            cv::Mat image;
-            std::string error_msg;
-            
+        std::string_view command = request.command();
+        if (command == "recognize" || command == "detect" || command == "recognize_regions") {
             // 检查传输方式：路径、Base64数据或字节数组
-            std::string image_path = request.get("image_path", "").asString();
-            std::string image_base64 = request.get("image_data", "").asString();
+            std::string_view image_path = request.getString("image_path");
+            std::string_view image_base64 = request.getString("image_data");
             
+            RequestOptions options;
+            std::string option_error = parseRequestOptions(request, options);
+            if (!option_error.empty()) {
+                Json::Value error_response;
+                error_response["success"] = false;
+                error_response["error"] = option_error;
+                Json::StreamWriterBuilder writer_builder;
+                return Json::writeString(writer_builder, error_response);
+            }
+            
+            // 路径方式先映射文件，缓存键按文件内容计算
+            std::shared_ptr<MappedFile> file;
+            std::string_view content = image_base64;
             if (!image_path.empty()) {
-                // 方式1: 使用文件路径
-                image = cv::imread(image_path);
-                if (image.empty()) {
-                    error_msg = "Failed to load image from path: " + image_path;
+                std::string open_error;
+                file = MappedFile::open(std::string(image_path), open_error);
+                if (!file) {
+                    Json::Value error_response;
+                    error_response["success"] = false;
+                    error_response["error"] = "Failed to load image from path: " + std::string(image_path);
+                    Json::StreamWriterBuilder writer_builder;
+                    return Json::writeString(writer_builder, error_response);
                 }
+                content = std::string_view(reinterpret_cast<const char*>(file->data()), file->size());
             }
-            else if (!image_base64.empty()) {
-                // 方式2: 使用Base64编码数据
-                try {
-                    image = base64ToMat(image_base64);
-                    if (image.empty()) {
-                        error_msg = "Failed to decode base64 image data";
-                    }
-                } catch (const std::exception& e) {
-                    error_msg = "Base64 decode error: " + std::string(e.what());
-                }
+            
+            options.cancel_token = std::make_shared<CancellationToken>();
+            if (options.client_id.empty()) {
+                // 未指定 client_id 时同一连接上的请求视为同一客户端
+                options.client_id = "pipe:" + std::to_string(reinterpret_cast<uintptr_t>(client_pipe));
             }
-            else {
-                error_msg = "Missing image_path or image_data";
+            std::string_view cancel_id = request.getString("cancel_id");
+            if (!cancel_id.empty()) {
+                registerCancelId(cancel_id, options.cancel_token);
             }
             
-            // 如果有错误，返回错误响应
-            if (!error_msg.empty()) {
+            if (result_cache_ && !content.empty()) {
+                // 相同图像命中缓存或合并到正在进行的计算；命令、模板和区域参数不同的结果互不复用
+                std::string variant(command);
+                for (std::string_view key : {"template", "rois", "regions"}) {
+                    variant += '\n';
+                    variant += request.raw(key);
+                }
+                auto start_time = std::chrono::steady_clock::now();
+                // 计算可能由多个调用方共享，使用缓存给出的取消标记；本请求断开、被取消或超过自己的
+                // 截止时间只让本请求停止等待，所有等待者都放弃后缓存才取消计算
+                std::shared_ptr<CancellationToken> cancel_token = options.cancel_token;
+                auto deadline = options.deadline;
+                auto submit = [&](std::shared_ptr<CancellationToken> compute_token) {
+                    RequestOptions compute_options = options;
+                    compute_options.cancel_token = std::move(compute_token);
+                    return submitImage(file, image_path, image_base64, std::move(compute_options));
+                };
+                auto abandoned = [&]() {
+                    if (clientDisconnected(client_pipe)) {
+                        std::cout << "Client disconnected while waiting, leaving shared computation" << std::endl;
+                        cancel_token->cancel();
+                    }
+                    return cancel_token->isCancelled() || std::chrono::steady_clock::now() > deadline;
+                };
+                bool shared = false;
+                std::optional<std::string> cached = result_cache_->getOrCompute(
+                    ResultCache::makeKey(content, variant), submit, abandoned, &shared);
+                if (!cached) {
+                    // 与 Worker 出队时丢弃请求的响应一致
+                    JsonWriter writer;
+                    OCRWorker::writeErrorJson(request_counter_.fetch_add(1),
+                                              cancel_token->isCancelled() ? RequestCancelled().what()
+                                                                          : "Deadline exceeded before processing",
+                                              -1, writer);
+                    return writer.str();
+                }
+                std::string response = std::move(*cached);
+                if (shared) {
+                    // 命中或合并的响应属于首次计算的请求，换成本请求的 request_id 和实际耗时
+                    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+                    response = ResultCache::rebind(response, request_counter_.fetch_add(1), elapsed_ms);
+                }
+                return response;
+            }
+            return recognizeImage(std::move(file), image_path, image_base64, std::move(options), client_pipe);
+        }
+        else if (command == "cancel") {
+            std::string_view cancel_id = request.getString("cancel_id");
+            if (cancel_id.empty()) {
                 Json::Value error_response;
                 error_response["success"] = false;
-                error_response["error"] = error_msg;
+                error_response["error"] = "cancel requires cancel_id";
                 Json::StreamWriterBuilder writer_builder;
                 return Json::writeString(writer_builder, error_response);
             }
-            
-            // 统一处理cv::Mat格式的图像
-            auto future = processOCRRequest(image);
-            return future.get();
+            Json::Value cancel_response;
+            cancel_response["success"] = true;
+            cancel_response["cancelled"] = cancelRequests(cancel_id);
+            Json::StreamWriterBuilder writer_builder;
+            return Json::writeString(writer_builder, cancel_response);
         }
         else if (command == "status") {
             Json::Value status_response;
@@ -374,6 +450,7 @@ std::string OCRIPCService::processIPCRequest(const std::string& request_json) {
             return Json::writeString(writer_builder, status_response);
         }
         else if (command == "shutdown") {
+            is_shutdown = true;
             Json::Value shutdown_response;
             shutdown_response["success"] = true;
             shutdown_response["message"] = "Shutdown command received, stopping service...";
@@ -408,7 +485,7 @@ std::string OCRIPCService::processIPCRequest(const std::string& request_json) {
         else {
             Json::Value error_response;
             error_response["success"] = false;
-            error_response["error"] = "Unknown command: " + command;
+            error_response["error"] = "Unknown command: " + std::string(command);
             Json::StreamWriterBuilder writer_builder;
             return Json::writeString(writer_builder, error_response);
         }
@@ -422,16 +499,228 @@ std::string OCRIPCService::processIPCRequest(const std::string& request_json) {
     }
 }
 
-std::future<std::string> OCRIPCService::processOCRRequest(const cv::Mat& image) {
+// 客户端给出的坐标上限，远大于任何图像边长；转换为 int 以及 x + width 都不会溢出
+static constexpr double kMaxCoordinate = 1 << 20;
+
+static bool isCoordinate(double value) {
+    return std::isfinite(value) && std::abs(value) <= kMaxCoordinate;
+}
+
+// 客户端截止时间上限 (24 小时)，换算为 steady_clock 时长不会溢出
+static constexpr double kMaxDeadlineMs = 24.0 * 3600.0 * 1000.0;
+
+std::string OCRIPCService::parseRequestOptions(const IPCRequest& request, RequestOptions& options) const {
+    // 截止时间从收到请求起算，包含解码和排队
+    double deadline_ms = admission_.default_deadline_ms;
+    if (request.has("deadline_ms") &&
+        (!request.getNumber("deadline_ms", deadline_ms) || !(deadline_ms > 0.0 && deadline_ms <= kMaxDeadlineMs))) {
+        return "Invalid deadline_ms: expected a positive number of milliseconds, at most 24 hours";
+    }
+    if (deadline_ms > 0.0) {
+        options.deadline = std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double, std::milli>(deadline_ms));
+    }
+    
+    std::string_view priority = request.getString("priority");
+    if (!priority.empty()) {
+        options.priority_class = scheduling_.findClass(priority);
+        if (options.priority_class < 0) {
+            return "Unknown priority: " + std::string(priority);
+        }
+    }
+    options.client_id = std::string(request.getString("client_id"));
+    
+    std::string_view command = request.command();
+    if (command == "detect") {
+        options.task = OCRTask::Detect;
+    } else if (command == "recognize_regions") {
+        options.task = OCRTask::RecognizeRegions;
+    }
+    
+    // 指定版面模板时跳过检测
+    std::string_view template_name = request.getString("template");
+    if (!template_name.empty()) {
+        if (options.task != OCRTask::Recognize) {
+            return "template is only supported by recognize";
+        }
+        options.layout = templates_.find(template_name);
+        if (!options.layout) {
+            return "Unknown template: " + std::string(template_name);
+        }
+    }
+    
+    std::vector<double> values;
+    if (request.has("rois")) {
+        if (options.task == OCRTask::RecognizeRegions) {
+            return "rois is not supported by recognize_regions";
+        }
+        if (!request.getNumberArrays("rois", 4, values)) {
+            return "Invalid rois: expected [[x, y, width, height], ...]";
+        }
+        for (size_t i = 0; i < values.size(); i += 4) {
+            if (!std::all_of(values.begin() + i, values.begin() + i + 4, isCoordinate) ||
+                values[i + 2] < 0.0 || values[i + 3] < 0.0) {
+                return "Invalid rois: expected [[x, y, width, height], ...]";
+            }
+            options.rois.emplace_back(static_cast<int>(values[i]), static_cast<int>(values[i + 1]),
+                                      static_cast<int>(values[i + 2]), static_cast<int>(values[i + 3]));
+        }
+    }
+    
+    if (options.task == OCRTask::RecognizeRegions) {
+        if (!request.getNumberArrays("regions", 8, values) || values.empty() ||
+            !std::all_of(values.begin(), values.end(), isCoordinate)) {
+            return "Invalid regions: expected [[[x, y], [x, y], [x, y], [x, y]], ...]";
+        }
+        for (size_t i = 0; i < values.size(); i += 8) {
+            Quad box;
+            for (int k = 0; k < 4; ++k) {
+                box[k] = cv::Point(static_cast<int>(values[i + 2 * k]), static_cast<int>(values[i + 2 * k + 1]));
+            }
+            options.regions.push_back(box);
+        }
+    }
+    return std::string();
+}
+
+std::string OCRIPCService::recognizeImage(std::shared_ptr<MappedFile> file, std::string_view image_path,
+                                          std::string_view image_base64, RequestOptions options,
+                                          HANDLE client_pipe) {
+    std::shared_ptr<CancellationToken> cancel_token = options.cancel_token;
+    auto future = submitImage(std::move(file), image_path, image_base64, std::move(options));
+    if (!cancel_token) {
+        return future.get();
+    }
+    return waitForResult(future, *cancel_token, client_pipe);
+}
+
+std::future<std::string> OCRIPCService::submitImage(std::shared_ptr<MappedFile> file, std::string_view image_path,
+                                                    std::string_view image_base64, RequestOptions options) {
+    cv::Mat image;
+    std::string error_msg;
+    std::shared_ptr<const ReducedImageSource> reduced_source;
+    
+    if (file) {
+        // 方式1: 使用文件路径，从映射区解码，大尺寸 JPEG 可缩小解码
+        // 调用方给出的 rois/regions 是原图坐标，只有完整识别才缩小解码
+        ReducedDecodeConfig decode_config = reduced_decode_;
+        decode_config.enabled = decode_config.enabled && options.task == OCRTask::Recognize && options.rois.empty();
+        ImageLoader::decode(std::move(file), std::string(image_path), decode_config, image, reduced_source, error_msg);
+    }
+    else if (!image_base64.empty()) {
+        // 方式2: 使用Base64编码数据
+        try {
+            image = base64ToMat(image_base64);
+            if (image.empty()) {
+                error_msg = "Failed to decode base64 image data";
+            }
+        } catch (const std::exception& e) {
+            error_msg = "Base64 decode error: " + std::string(e.what());
+        }
+    }
+    else {
+        error_msg = "Missing image_path or image_data";
+    }
+    
+    // 如果有错误，返回错误响应
+    if (!error_msg.empty()) {
+        Json::Value error_response;
+        error_response["success"] = false;
+        error_response["error"] = error_msg;
+        Json::StreamWriterBuilder writer_builder;
+        std::promise<std::string> error_promise;
+        error_promise.set_value(Json::writeString(writer_builder, error_response));
+        return error_promise.get_future();
+    }
+    
+    // 统一处理cv::Mat格式的图像，解码结果直接移交worker
+    return processOCRRequest(std::move(image), std::move(reduced_source), std::move(options));
+}
+
+bool OCRIPCService::clientDisconnected(HANDLE client_pipe) {
+    // 客户端同步等待响应，期间不会再写入；管道断开时 PeekNamedPipe 失败
+    DWORD available = 0;
+    return client_pipe != INVALID_HANDLE_VALUE && !PeekNamedPipe(client_pipe, NULL, 0, NULL, &available, NULL);
+}
+
+std::string OCRIPCService::waitForResult(std::future<std::string>& future, CancellationToken& cancel_token,
+                                         HANDLE client_pipe) {
+    const auto poll_interval = std::chrono::milliseconds(20);
+    while (future.wait_for(poll_interval) != std::future_status::ready) {
+        if (cancel_token.isCancelled()) {
+            continue;
+        }
+        if (clientDisconnected(client_pipe)) {
+            std::cout << "Client disconnected while waiting, cancelling request" << std::endl;
+            cancel_token.cancel();
+            removeCancelledRequests();
+        }
+    }
+    return future.get();
+}
+
+void OCRIPCService::registerCancelId(std::string_view cancel_id,
+                                     const std::shared_ptr<CancellationToken>& cancel_token) {
+    std::lock_guard<std::mutex> lock(cancel_ids_mutex_);
+    // 顺带清理已结束请求的登记
+    for (auto it = cancel_ids_.begin(); it != cancel_ids_.end();) {
+        it = it->second.expired() ? cancel_ids_.erase(it) : std::next(it);
+    }
+    cancel_ids_.emplace(std::string(cancel_id), cancel_token);
+}
+
+int OCRIPCService::cancelRequests(std::string_view cancel_id) {
+    int cancelled = 0;
+    {
+        std::lock_guard<std::mutex> lock(cancel_ids_mutex_);
+        auto range = cancel_ids_.equal_range(std::string(cancel_id));
+        for (auto it = range.first; it != range.second; ++it) {
+            if (auto cancel_token = it->second.lock()) {
+                if (!cancel_token->isCancelled()) {
+                    cancel_token->cancel();
+                    ++cancelled;
+                }
+            }
+        }
+        cancel_ids_.erase(range.first, range.second);
+    }
+    if (cancelled > 0) {
+        removeCancelledRequests();
+    }
+    return cancelled;
+}
+
+void OCRIPCService::removeCancelledRequests() {
+    if (cpu_worker_pool_) {
+        cpu_worker_pool_->removeCancelled();
+    }
+    if (gpu_worker_pool_) {
+        gpu_worker_pool_->removeCancelled();
+    }
+}
+
+std::future<std::string> OCRIPCService::processOCRRequest(cv::Mat&& image,
+                                                          std::shared_ptr<const ReducedImageSource> reduced_source,
+                                                          RequestOptions options) {
     int request_id = request_counter_.fetch_add(1);
-    auto request = std::make_shared<OCRRequest>(request_id, image);
+    auto request = std::make_shared<OCRRequest>(request_id, std::move(image));
+    request->reduced_source = std::move(reduced_source);
+    request->task = options.task;
+    request->layout = std::move(options.layout);
+    request->rois = std::move(options.rois);
+    request->regions = std::move(options.regions);
+    request->deadline = options.deadline;
+    request->cancel_token = std::move(options.cancel_token);
+    request->priority_class = options.priority_class;
+    request->client_id = std::move(options.client_id);
     
     total_requests_.fetch_add(1);
     
     if (gpu_workers_ > 0) {
-        return gpu_worker_pool_->submitRequest(request);
+        return gpu_worker_pool_->submitRequest(std::move(request));
     } else {
-        return cpu_worker_pool_->submitRequest(request);
+        return cpu_worker_pool_->submitRequest(std::move(request));
     }
 }
 
@@ -443,6 +732,189 @@ std::string OCRIPCService::getStatusInfo() const {
     status["average_processing_time_ms"] = total_requests_.load() > 0 ? 
         total_processing_time_.load() / total_requests_.load() : 0.0;
     
+    // 各模型实际推理精度 (auto/bf16/int8 可能按硬件或模型文件回退)
+    Json::Value precision(Json::objectValue);
+    if (cpu_worker_pool_) {
+        precision["cpu"]["det"] = cpu_worker_pool_->getDetPrecision();
+        precision["cpu"]["rec"] = cpu_worker_pool_->getRecPrecision();
+    }
+    if (gpu_worker_pool_) {
+        precision["gpu"]["det"] = gpu_worker_pool_->getDetPrecision();
+        precision["gpu"]["rec"] = gpu_worker_pool_->getRecPrecision();
+    }
+    status["precision"] = precision;
+    status["cpu_features"] = CPUFeatures::detect().summary();
+    
+    // 识别批次填充统计：padding_waste_ratio 为填充列占输入张量列数的比例，
+    // saved_columns 为相对固定批次切分节省的列数 (识别计算量与列数成正比)
+    RecBatchStatsSnapshot rec_stats = RecBatchPlanner::stats();
+    Json::Value rec_batching;
+    rec_batching["batches"] = static_cast<Json::Int64>(rec_stats.batches);
+    rec_batching["images"] = static_cast<Json::Int64>(rec_stats.images);
+    rec_batching["useful_columns"] = static_cast<Json::Int64>(rec_stats.useful_columns);
+    rec_batching["padded_columns"] = static_cast<Json::Int64>(rec_stats.padded_columns);
+    rec_batching["saved_columns"] = static_cast<Json::Int64>(rec_stats.fixed_chunk_columns - rec_stats.padded_columns);
+    rec_batching["padding_waste_ratio"] = rec_stats.padded_columns > 0 ?
+        1.0 - static_cast<double>(rec_stats.useful_columns) / rec_stats.padded_columns : 0.0;
+    status["rec_batching"] = rec_batching;
+    
+    // 中间缓冲区内存池：hit_ratio 为未触达系统堆的 Mat 分配比例
+    BufferPoolStatsSnapshot pool_stats = PooledMatAllocator::stats();
+    Json::Value buffer_pool;
+    buffer_pool["enabled"] = PooledMatAllocator::installed();
+    buffer_pool["allocations"] = static_cast<Json::Int64>(pool_stats.allocations);
+    buffer_pool["pool_hits"] = static_cast<Json::Int64>(pool_stats.pool_hits);
+    buffer_pool["hit_ratio"] = pool_stats.allocations > 0 ?
+        static_cast<double>(pool_stats.pool_hits) / pool_stats.allocations : 0.0;
+    buffer_pool["cached_bytes"] = static_cast<Json::Int64>(pool_stats.cached_bytes);
+    buffer_pool["depot_cached_bytes"] = static_cast<Json::Int64>(pool_stats.depot_bytes);
+    buffer_pool["peak_live_bytes"] = static_cast<Json::Int64>(pool_stats.peak_live_bytes);
+    status["buffer_pool"] = buffer_pool;
+    
+    // 结果缓存命中率
+    Json::Value result_cache;
+    result_cache["enabled"] = result_cache_ != nullptr;
+    if (result_cache_) {
+        ResultCacheStats cache_stats = result_cache_->stats();
+        long long lookups = cache_stats.hits + cache_stats.misses + cache_stats.coalesced;
+        result_cache["entries"] = static_cast<Json::UInt64>(cache_stats.entries);
+        result_cache["bytes"] = static_cast<Json::UInt64>(cache_stats.bytes);
+        result_cache["hits"] = static_cast<Json::Int64>(cache_stats.hits);
+        result_cache["misses"] = static_cast<Json::Int64>(cache_stats.misses);
+        result_cache["coalesced"] = static_cast<Json::Int64>(cache_stats.coalesced);
+        result_cache["evictions"] = static_cast<Json::Int64>(cache_stats.evictions);
+        result_cache["expirations"] = static_cast<Json::Int64>(cache_stats.expirations);
+        result_cache["hit_ratio"] = lookups > 0 ?
+            static_cast<double>(cache_stats.hits + cache_stats.coalesced) / lookups : 0.0;
+    }
+    status["result_cache"] = result_cache;
+    
+    // 识别缓存命中率
+    RecognitionCache& recognition_cache = RecognitionCache::instance();
+    RecCacheStats rec_stats = recognition_cache.stats();
+    Json::Value rec_cache;
+    rec_cache["enabled"] = recognition_cache.enabled();
+    rec_cache["entries"] = static_cast<Json::UInt64>(rec_stats.entries);
+    rec_cache["bytes"] = static_cast<Json::UInt64>(rec_stats.bytes);
+    rec_cache["lookups"] = static_cast<Json::Int64>(rec_stats.lookups);
+    rec_cache["hits"] = static_cast<Json::Int64>(rec_stats.hits);
+    rec_cache["rejected"] = static_cast<Json::Int64>(rec_stats.rejected);
+    rec_cache["evictions"] = static_cast<Json::Int64>(rec_stats.evictions);
+    rec_cache["hit_ratio"] = rec_stats.lookups > 0 ?
+        static_cast<double>(rec_stats.hits) / rec_stats.lookups : 0.0;
+    status["rec_cache"] = rec_cache;
+    
+    // 准入控制：rejected 为入队前拒绝，expired 为出队时已超时丢弃，cancelled 为客户端断开或 cancel 命令取消
+    AdmissionStats admission_stats;
+    if (cpu_worker_pool_) {
+        admission_stats = cpu_worker_pool_->getAdmissionStats();
+    }
+    if (gpu_worker_pool_) {
+        AdmissionStats gpu_stats = gpu_worker_pool_->getAdmissionStats();
+        admission_stats.rejected += gpu_stats.rejected;
+        admission_stats.expired += gpu_stats.expired;
+        admission_stats.cancelled += gpu_stats.cancelled;
+    }
+    Json::Value admission;
+    admission["max_queue_depth"] = admission_.max_queue_depth;
+    admission["default_deadline_ms"] = admission_.default_deadline_ms;
+    admission["rejected"] = static_cast<Json::Int64>(admission_stats.rejected);
+    admission["expired"] = static_cast<Json::Int64>(admission_stats.expired);
+    admission["cancelled"] = static_cast<Json::Int64>(admission_stats.cancelled);
+    status["admission"] = admission;
+    
+    // 级联模式：accepted 为采用快速通道结果，fallbacks 为回退到常规检测
+    CascadeStats cascade_stats;
+    if (cpu_worker_pool_) {
+        cascade_stats = cpu_worker_pool_->getCascadeStats();
+    }
+    if (gpu_worker_pool_) {
+        CascadeStats gpu_stats = gpu_worker_pool_->getCascadeStats();
+        cascade_stats.accepted += gpu_stats.accepted;
+        cascade_stats.fallbacks += gpu_stats.fallbacks;
+    }
+    Json::Value cascade;
+    cascade["enabled"] = cascade_.enabled;
+    cascade["fast_side_len"] = cascade_.fast_side_len;
+    cascade["accepted"] = static_cast<Json::Int64>(cascade_stats.accepted);
+    cascade["fallbacks"] = static_cast<Json::Int64>(cascade_stats.fallbacks);
+    status["cascade"] = cascade;
+    
+    // 缩小解码：redecodes 为因文字过矮而重新解码的请求数
+    Json::Value reduced_decode;
+    reduced_decode["enabled"] = reduced_decode_.enabled;
+    reduced_decode["min_text_height"] = reduced_decode_.min_text_height;
+    reduced_decode["redecodes"] = static_cast<Json::Int64>(
+        (cpu_worker_pool_ ? cpu_worker_pool_->getRedecodeCount() : 0) +
+        (gpu_worker_pool_ ? gpu_worker_pool_->getRedecodeCount() : 0));
+    status["reduced_decode"] = reduced_decode;
+    
+    // 各优先级类别的排队与延迟 (p50/p99 为最近请求从提交到完成的毫秒数)
+    Json::Value scheduler(Json::arrayValue);
+    std::vector<PriorityClassStats> class_stats = gpu_worker_pool_ ? gpu_worker_pool_->getSchedulerStats()
+                                                                   : cpu_worker_pool_->getSchedulerStats();
+    for (const auto& stats : class_stats) {
+        Json::Value item;
+        item["name"] = stats.name;
+        item["weight"] = stats.weight;
+        item["max_queue_depth"] = stats.max_queue_depth;
+        item["queued"] = static_cast<Json::UInt64>(stats.queued);
+        item["dispatched"] = static_cast<Json::Int64>(stats.dispatched);
+        item["rejected"] = static_cast<Json::Int64>(stats.rejected);
+        item["completed"] = static_cast<Json::Int64>(stats.completed);
+        item["p50_ms"] = stats.p50_ms;
+        item["p99_ms"] = stats.p99_ms;
+        scheduler.append(item);
+    }
+    status["scheduler"] = scheduler;
+    
+    // 类别内按预测耗时优先分派小请求时使用的代价模型
+    CostModelStats cost_stats = gpu_worker_pool_ ? gpu_worker_pool_->getCostModelStats()
+                                                 : cpu_worker_pool_->getCostModelStats();
+    Json::Value cost_model;
+    cost_model["shortest_job_first"] = scheduling_.shortest_job_first;
+    cost_model["samples"] = static_cast<Json::Int64>(cost_stats.samples);
+    cost_model["base_ms"] = cost_stats.base_ms;
+    cost_model["ms_per_megapixel"] = cost_stats.ms_per_megapixel;
+    cost_model["ms_per_box"] = cost_stats.ms_per_box;
+    cost_model["boxes_per_megapixel"] = cost_stats.boxes_per_megapixel;
+    cost_model["mean_abs_error_ms"] = cost_stats.mean_abs_error_ms;
+    status["cost_model"] = cost_model;
+    
+    // 对冲率 = 对冲次数 / 分派的请求数，胜率 = 对冲副本先完成的比例
+    HedgingStats hedge_stats = gpu_worker_pool_ ? gpu_worker_pool_->getHedgingStats()
+                                                : cpu_worker_pool_->getHedgingStats();
+    Json::Value hedging;
+    hedging["percentile"] = hedging_.percentile;
+    hedging["launched"] = static_cast<Json::Int64>(hedge_stats.launched);
+    hedging["wins"] = static_cast<Json::Int64>(hedge_stats.wins);
+    hedging["hedge_rate"] = hedge_stats.dispatched > 0 ? double(hedge_stats.launched) / hedge_stats.dispatched : 0.0;
+    hedging["win_rate"] = hedge_stats.launched > 0 ? double(hedge_stats.wins) / hedge_stats.launched : 0.0;
+    status["hedging"] = hedging;
+    
+    // 各Worker分派时输入形状仍在其最近处理过的形状中的比例，近似推理引擎的 primitive 缓存命中率
+    std::vector<WorkerShapeStats> shape_stats = gpu_worker_pool_ ? gpu_worker_pool_->getShapeStats()
+                                                                 : cpu_worker_pool_->getShapeStats();
+    Json::Value shape_cache;
+    shape_cache["affinity"] = scheduling_.shape_affinity;
+    Json::Value shape_workers(Json::arrayValue);
+    for (const auto& stats : shape_stats) {
+        Json::Value item;
+        item["worker_id"] = stats.worker_id;
+        item["requests"] = static_cast<Json::Int64>(stats.requests);
+        item["hits"] = static_cast<Json::Int64>(stats.hits);
+        item["hit_rate"] = stats.hit_rate;
+        shape_workers.append(item);
+    }
+    shape_cache["workers"] = shape_workers;
+    status["shape_cache"] = shape_cache;
+    
+    Json::Value templates(Json::arrayValue);
+    for (const auto& name : templates_.names()) {
+        templates.append(name);
+    }
+    status["templates"] = templates;
+    
     Json::StreamWriterBuilder builder;
     return Json::writeString(builder, status);
 }
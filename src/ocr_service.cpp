@@ -4,6 +4,7 @@
  * 
  * 这个文件现在只是一个包含文件，所有实现都已经分离到各自的源文件中：
  * - ocr_worker.cpp - OCRWorker类实现
+ * - worker_pool.cpp - WorkerPool类实现 (准入、调度、对冲)
  * - gpu_worker_pool.cpp - GPUWorkerPool类实现  
  * - cpu_worker_pool.cpp - CPUWorkerPool类实现
  * - ocr_ipc_service.cpp - OCRIPCService类实现
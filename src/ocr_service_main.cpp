@@ -1,4 +1,5 @@
 #include "paddle_ocr/ocr_service.h"
+#include "paddle_ocr/cpu_features.h"
 #include <iostream>
 #include <signal.h>
 #include <thread>
@@ -66,6 +67,33 @@ void printUsage() {
     std::wcout << L"  --pipe-name <name>    命名管道名称 (默认: \\\\.\\pipe\\ocr_service)\n";
     std::wcout << L"  --gpu-workers <num>   GPU Worker数量 (默认: 0)\n";
     std::wcout << L"  --cpu-workers <num>   CPU Worker数量 (默认: 1)\n";
+    std::wcout << L"  --tiled-det           长图/大图分块检测，分块分发给空闲Worker并行执行\n";
+    std::wcout << L"  --tile-side <px>      分块最大边长 (默认: 1280)\n";
+    std::wcout << L"  --tile-overlap <px>   分块重叠像素 (默认: 160)\n";
+    std::wcout << L"  --precision <auto|fp32|bf16|int8> CPU检测/识别推理精度 (默认: auto，支持AVX512-BF16/AMX时用bf16，否则fp32；int8需先运行 scripts/quantize_models.py)\n";
+    std::wcout << L"  --det-backend <name>  检测模型推理后端: paddle | onnxruntime | mock[:<ms>[:<ms/MP>]] (默认: paddle)\n";
+    std::wcout << L"  --cls-backend <name>  分类模型推理后端 (默认: paddle)\n";
+    std::wcout << L"  --rec-backend <name>  识别模型推理后端 (默认: paddle)\n";
+    std::wcout << L"  --cascade             级联模式：低分辨率快速识别，仅低置信度区域在原图上复检\n";
+    std::wcout << L"  --cascade-side <px>   快速检测的边长上限 (默认: 320)\n";
+    std::wcout << L"  --cascade-threshold <score> 触发原图复检的识别置信度 (默认: 0.85)\n";
+    std::wcout << L"  --no-buffer-pool      禁用中间缓冲区内存池 (用于对比测试)\n";
+    std::wcout << L"  --reduced-decode      image_path 大尺寸JPEG缩小解码 (1/2~1/8)，仅过小的文字从原图重新识别\n";
+    std::wcout << L"  --reduced-decode-side <px> 缩小解码后最长边下限 (默认: 960)\n";
+    std::wcout << L"  --result-cache        按图像内容缓存识别结果，相同图像的并发请求只计算一次 (全部调用方断开或取消后才中止)\n";
+    std::wcout << L"  --result-cache-size <num> 最多缓存的结果数 (默认: 1024)\n";
+    std::wcout << L"  --result-cache-mb <mb> 缓存结果总大小上限 (默认: 64)\n";
+    std::wcout << L"  --result-cache-ttl <sec> 缓存结果有效期，0表示不过期 (默认: 300)\n";
+    std::wcout << L"  --rec-cache           缓存重复文字区域 (模板标签等) 的识别结果\n";
+    std::wcout << L"  --rec-cache-mb <mb>   识别缓存内存上限 (默认: 8)\n";
+    std::wcout << L"  --templates <file>    版面模板文件 (JSON)，请求以 template 字段选用，跳过检测\n";
+    std::wcout << L"  --max-queue <n>       每个Worker的排队上限，超出时立即拒绝 (默认: 16，0 为不限)\n";
+    std::wcout << L"  --default-deadline <ms> 请求未携带 deadline_ms 时的截止时间 (默认: 0，不限)\n";
+    std::wcout << L"  --priority-classes <name:weight[:depth],...> 优先级类别及权重，第一个为默认类别 (默认: interactive:8,bulk:1)\n";
+    std::wcout << L"  --no-sjf              关闭按预测耗时优先分派小请求\n";
+    std::wcout << L"  --sjf-aging <x>       每等待 1ms 调度代价减少的毫秒数，防止大请求饿死 (默认: 0.5)\n";
+    std::wcout << L"  --hedge-percentile <p> 处理时间超过近期第 p 百分位且有空闲Worker时对冲执行 (默认: 0，关闭)\n";
+    std::wcout << L"  --no-shape-affinity   不按输入形状优先选择预热过的Worker\n";
     std::wcout << L"  --help                显示此帮助信息\n";
     std::wcout << L"\n示例:\n";
     std::wcout << L"  ocr_service --model-dir ./models --pipe-name \\\\.\\pipe\\ocr_service\n";
@@ -84,6 +112,7 @@ int main(int argc, char* argv[]) {
     std::string pipe_name = "\\\\.\\pipe\\ocr_service";
     int gpu_workers = 0;  // 默认0个GPU Worker, 使用CPU处理
     int cpu_workers = 1;  // 默认1个CPU Worker
+    PaddleOCR::OCRWorkerConfig worker_config;
     
     // 解析命令行参数
     for (int i = 1; i < argc; ++i) {
@@ -103,6 +132,101 @@ int main(int argc, char* argv[]) {
         }
         else if (arg == "--cpu-workers" && i + 1 < argc) {
             cpu_workers = std::stoi(argv[++i]);
+        }
+        else if (arg == "--tiled-det") {
+            worker_config.tiled_det.enabled = true;
+        }
+        else if (arg == "--tile-side" && i + 1 < argc) {
+            worker_config.tiled_det.tile_side = std::stoi(argv[++i]);
+        }
+        else if (arg == "--tile-overlap" && i + 1 < argc) {
+            worker_config.tiled_det.overlap = std::stoi(argv[++i]);
+        }
+        else if (arg == "--precision" && i + 1 < argc) {
+            worker_config.cpu_precision = argv[++i];
+            if (worker_config.cpu_precision != "auto" && worker_config.cpu_precision != "fp32" &&
+                worker_config.cpu_precision != "bf16" && worker_config.cpu_precision != "int8") {
+                std::wcerr << L"Unsupported precision: " << std::wstring(worker_config.cpu_precision.begin(), worker_config.cpu_precision.end()) << std::endl;
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--det-backend" && i + 1 < argc) {
+            worker_config.det_backend = argv[++i];
+        }
+        else if (arg == "--cls-backend" && i + 1 < argc) {
+            worker_config.cls_backend = argv[++i];
+        }
+        else if (arg == "--rec-backend" && i + 1 < argc) {
+            worker_config.rec_backend = argv[++i];
+        }
+        else if (arg == "--cascade") {
+            worker_config.cascade.enabled = true;
+        }
+        else if (arg == "--cascade-side" && i + 1 < argc) {
+            worker_config.cascade.fast_side_len = std::stoi(argv[++i]);
+        }
+        else if (arg == "--cascade-threshold" && i + 1 < argc) {
+            worker_config.cascade.rec_threshold = std::stof(argv[++i]);
+        }
+        else if (arg == "--no-buffer-pool") {
+            worker_config.buffer_pool = false;
+        }
+        else if (arg == "--reduced-decode") {
+            worker_config.reduced_decode.enabled = true;
+        }
+        else if (arg == "--reduced-decode-side" && i + 1 < argc) {
+            worker_config.reduced_decode.min_side = std::stoi(argv[++i]);
+        }
+        else if (arg == "--result-cache") {
+            worker_config.result_cache.enabled = true;
+        }
+        else if (arg == "--result-cache-size" && i + 1 < argc) {
+            worker_config.result_cache.max_entries = static_cast<size_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--result-cache-mb" && i + 1 < argc) {
+            worker_config.result_cache.max_bytes = static_cast<size_t>(std::stoul(argv[++i])) << 20;
+        }
+        else if (arg == "--result-cache-ttl" && i + 1 < argc) {
+            worker_config.result_cache.ttl_seconds = std::stoi(argv[++i]);
+        }
+        else if (arg == "--rec-cache") {
+            worker_config.rec_cache.enabled = true;
+        }
+        else if (arg == "--rec-cache-mb" && i + 1 < argc) {
+            worker_config.rec_cache.max_bytes = static_cast<size_t>(std::stoul(argv[++i])) << 20;
+        }
+        else if (arg == "--templates" && i + 1 < argc) {
+            worker_config.templates_path = argv[++i];
+        }
+        else if (arg == "--max-queue" && i + 1 < argc) {
+            worker_config.admission.max_queue_depth = std::stoi(argv[++i]);
+        }
+        else if (arg == "--default-deadline" && i + 1 < argc) {
+            worker_config.admission.default_deadline_ms = std::stoi(argv[++i]);
+        }
+        else if (arg == "--priority-classes" && i + 1 < argc) {
+            std::string spec_error;
+            if (!PaddleOCR::SchedulerConfig::parse(argv[++i], worker_config.scheduling, spec_error)) {
+                std::wcerr << std::wstring(spec_error.begin(), spec_error.end()) << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--no-sjf") {
+            worker_config.scheduling.shortest_job_first = false;
+        }
+        else if (arg == "--sjf-aging" && i + 1 < argc) {
+            worker_config.scheduling.aging = std::stod(argv[++i]);
+        }
+        else if (arg == "--no-shape-affinity") {
+            worker_config.scheduling.shape_affinity = false;
+        }
+        else if (arg == "--hedge-percentile" && i + 1 < argc) {
+            worker_config.hedging.percentile = std::stod(argv[++i]);
+            if (worker_config.hedging.percentile < 0.0 || worker_config.hedging.percentile > 100.0) {
+                std::wcerr << L"--hedge-percentile must be between 0 and 100" << std::endl;
+                return 1;
+            }
         }        else {
             std::wcerr << L"Unknown argument: " << std::wstring(arg.begin(), arg.end()) << std::endl;
             printUsage();
@@ -113,6 +237,37 @@ int main(int argc, char* argv[]) {
     std::wcout << L"Pipe Name: " << std::wstring(pipe_name.begin(), pipe_name.end()) << std::endl;
     std::wcout << L"GPU Workers: " << gpu_workers << std::endl;
     std::wcout << L"CPU Workers: " << cpu_workers << std::endl;
+    std::wcout << L"Tiled Detection: " << (worker_config.tiled_det.enabled ? L"ON" : L"OFF") << std::endl;
+    std::string cpu_summary = PaddleOCR::CPUFeatures::detect().summary();
+    std::string resolved_precision = PaddleOCR::CPUFeatures::resolvePrecision(worker_config.cpu_precision);
+    std::wcout << L"CPU: " << std::wstring(cpu_summary.begin(), cpu_summary.end()) << std::endl;
+    std::wcout << L"CPU Precision: " << std::wstring(worker_config.cpu_precision.begin(), worker_config.cpu_precision.end())
+               << L" -> " << std::wstring(resolved_precision.begin(), resolved_precision.end()) << std::endl;
+    std::wcout << L"Backends: det=" << std::wstring(worker_config.det_backend.begin(), worker_config.det_backend.end())
+               << L", cls=" << std::wstring(worker_config.cls_backend.begin(), worker_config.cls_backend.end())
+               << L", rec=" << std::wstring(worker_config.rec_backend.begin(), worker_config.rec_backend.end()) << std::endl;
+    std::wcout << L"Cascade Mode: " << (worker_config.cascade.enabled ? L"ON" : L"OFF") << std::endl;
+    std::wcout << L"Buffer Pool: " << (worker_config.buffer_pool ? L"ON" : L"OFF") << std::endl;
+    std::wcout << L"Reduced Decode: " << (worker_config.reduced_decode.enabled ? L"ON" : L"OFF") << std::endl;
+    std::wcout << L"Result Cache: " << (worker_config.result_cache.enabled ? L"ON" : L"OFF") << std::endl;
+    std::wcout << L"Rec Cache: " << (worker_config.rec_cache.enabled ? L"ON" : L"OFF") << std::endl;
+    if (!worker_config.templates_path.empty()) {
+        std::wcout << L"Templates: " << std::wstring(worker_config.templates_path.begin(), worker_config.templates_path.end()) << std::endl;
+    }
+    std::wcout << L"Max Queue Depth: " << worker_config.admission.max_queue_depth << std::endl;
+    std::wcout << L"Priority Classes:";
+    for (const auto& priority_class : worker_config.scheduling.classes) {
+        std::wcout << L" " << std::wstring(priority_class.name.begin(), priority_class.name.end())
+                   << L"(" << priority_class.weight << L")";
+    }
+    std::wcout << std::endl;
+    std::wcout << L"Shortest Job First: " << (worker_config.scheduling.shortest_job_first ? L"ON" : L"OFF") << std::endl;
+    std::wcout << L"Shape Affinity: " << (worker_config.scheduling.shape_affinity ? L"ON" : L"OFF") << std::endl;
+    if (worker_config.hedging.percentile > 0.0) {
+        std::wcout << L"Hedging: p" << worker_config.hedging.percentile << std::endl;
+    } else {
+        std::wcout << L"Hedging: OFF" << std::endl;
+    }
     std::wcout << L"==============================" << std::endl;
       try {
         // 设置控制台处理程序
@@ -121,7 +276,7 @@ int main(int argc, char* argv[]) {
         }
         
         // 创建并启动服务
-        g_service = std::make_unique<PaddleOCR::OCRIPCService>(model_dir, pipe_name, gpu_workers, cpu_workers);
+        g_service = std::make_unique<PaddleOCR::OCRIPCService>(model_dir, pipe_name, gpu_workers, cpu_workers, worker_config);
         
         if (!g_service->start()) {
             std::wcerr << L"Failed to start OCR service" << std::endl;
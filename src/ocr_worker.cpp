@@ -1,17 +1,70 @@
 #include "paddle_ocr/ocr_worker.h"
-#include <json/json.h>
+#include "paddle_ocr/cpu_features.h"
+#include "paddle_ocr/buffer_pool.h"
 #include <iostream>
 #include <chrono>
 #include <thread>
 #include <sstream>
+#include <algorithm>
+#include <iterator>
+#include <cstdlib>
 
 namespace PaddleOCR {
 
+namespace {
+constexpr double kCascadeDetFloor = 4.0;  // DB 后处理丢弃短边小于 3 像素的框，快速通道的文字高度下限留 1 像素余量
+constexpr double kCascadeReuseIoU = 0.7;  // 回退时常规检测框与快速通道文字框外接矩形的 IoU 达到该值即沿用识别结果
+}
+
+bool OCRRequest::setResult(const std::string& json) {
+    OCRRequest& owner = hedge_of ? *hedge_of : *this;
+    if (owner.result_set.exchange(true)) {
+        return false;
+    }
+    owner.result_promise.set_value(json);
+    delivered = true;
+    return true;
+}
+
+std::shared_ptr<OCRRequest> makeHedgeRequest(const std::shared_ptr<OCRRequest>& primary) {
+    // cv::Mat 拷贝只增加引用计数，两份请求都只读图像
+    auto hedge = std::make_shared<OCRRequest>(primary->request_id, cv::Mat(primary->image_data));
+    hedge->reduced_source = primary->reduced_source;
+    hedge->layout = primary->layout;
+    hedge->task = primary->task;
+    hedge->rois = primary->rois;
+    hedge->regions = primary->regions;
+    hedge->deadline = primary->deadline;
+    hedge->cancel_token = std::make_shared<CancellationToken>(primary->cancel_token);
+    hedge->priority_class = primary->priority_class;
+    hedge->client_id = primary->client_id;
+    hedge->submit_time = primary->submit_time;
+    hedge->predicted_ms = primary->predicted_ms;
+    hedge->shape_key = primary->shape_key;
+    hedge->hedge_of = primary;
+    return hedge;
+}
+
 // OCRWorker 实现
-OCRWorker::OCRWorker(int worker_id, const std::string& model_dir, bool use_gpu, int gpu_id, bool enable_cls)
-    : worker_id_(worker_id), use_gpu_(use_gpu), gpu_id_(gpu_id), enable_cls_(enable_cls), running_(false), is_idle_(true) {
+OCRWorker::OCRWorker(int worker_id, const std::string& model_dir, bool use_gpu, int gpu_id, bool enable_cls,
+                     const OCRWorkerConfig& config)
+    : worker_id_(worker_id), use_gpu_(use_gpu), gpu_id_(gpu_id), enable_cls_(enable_cls), config_(config),
+      running_(false), is_idle_(true) {
     
     try {
+        // 中间 Mat 走线程本地内存池，稳态请求不再访问系统堆
+        if (config_.buffer_pool) {
+            PooledMatAllocator::install();
+        }
+        if (config_.rec_cache.enabled) {
+            RecognitionCache::instance().configure(config_.rec_cache);
+        }
+        
+        // auto/bf16 按CPU能力解析为实际精度，GPU Worker 不受影响
+        if (!use_gpu) {
+            config_.cpu_precision = CPUFeatures::resolvePrecision(config_.cpu_precision);
+        }
+        
         // CPU线程数优化：减少每个worker的线程占用，提高多worker并发效率
         int det_threads = use_gpu ? 1 : 2;   // 检测器线程数：GPU=1, CPU=2（降低4->2）
         int cls_threads = use_gpu ? 1 : 1;   // 分类器线程数：GPU=1, CPU=1（降低2->1）  
@@ -31,7 +84,8 @@ OCRWorker::OCRWorker(int worker_id, const std::string& model_dir, bool use_gpu,
             1.8,                    // det_db_unclip_ratio: 减少扩展比例，小程序文字边界清晰 (2.0->1.8)
             "fast",                 // det_db_score_mode: 快速模式适合规整文字
             false,                  // use_polygon: 小程序截图不需要多边形检测
-            use_gpu, "fp32"
+            use_gpu, use_gpu ? "fp32" : config_.cpu_precision,
+            config_.det_backend
         );
         
         // 初始化分类器（仅在启用时）- 微信小程序通常不需要方向分类
@@ -44,7 +98,8 @@ OCRWorker::OCRWorker(int worker_id, const std::string& model_dir, bool use_gpu,
                 !use_gpu,            // use_mkldnn
                 0.98,                // cls_thresh: 进一步提高阈值，小程序方向极其确定 (0.95->0.98)
                 use_gpu, "fp32", 
-                8                    // cls_batch_num: 增加批处理，小程序处理更快 (6->8)
+                8,                   // cls_batch_num: 增加批处理，小程序处理更快 (6->8)
+                config_.cls_backend
             );
         }
         
@@ -56,10 +111,11 @@ OCRWorker::OCRWorker(int worker_id, const std::string& model_dir, bool use_gpu,
             rec_threads,            // cpu_math_library_num_threads: 优化多worker并发
             !use_gpu,               // use_mkldnn
             model_dir + "/rec/ppocr_keys_v1.txt",
-            use_gpu, "fp32",
+            use_gpu, use_gpu ? "fp32" : config_.cpu_precision,
             16,                     // rec_batch_num: 大幅增加批处理，小程序适合高并发 (12->16)
             28,                     // rec_img_h: 进一步降低高度，小程序文字通常较小 (32->28)
-            192                     // rec_img_w: 进一步降低宽度，小程序文字简单 (224->192)
+            192,                    // rec_img_w: 进一步降低宽度，小程序文字简单 (224->192)
+            config_.rec_backend
         );
         
         int total_memory = 0;
@@ -88,6 +144,18 @@ OCRWorker::OCRWorker(int worker_id, const std::string& model_dir, bool use_gpu,
                       << ", Peak Threads: " << peak_threads 
                       << " (det:" << det_threads << "→cls:" << cls_threads << "→rec:" << rec_threads << "+main:1)";
         }
+        std::cout << ", Backend: det=" << detector_->backend_name()
+                  << "/rec=" << recognizer_->backend_name();
+        if (!use_gpu) {
+            std::cout << ", Precision: det=" << detector_->effective_precision()
+                      << "/rec=" << recognizer_->effective_precision();
+        }
+        if (config_.tiled_det.enabled) {
+            std::cout << ", Tiled Det: " << config_.tiled_det.tile_side << "px/" << config_.tiled_det.overlap << "px overlap";
+        }
+        if (config_.cascade.enabled) {
+            std::cout << ", Cascade: " << config_.cascade.fast_side_len << "px@" << config_.cascade.rec_threshold;
+        }
         std::cout << ", Optimized for: WeChat Mini-Program Screenshots)" << std::endl;
     }
     catch (const std::exception& e) {
@@ -123,93 +191,292 @@ void OCRWorker::stop() {
 }
 
 void OCRWorker::addRequest(std::shared_ptr<OCRRequest> request) {
+    pending_requests_.fetch_add(1);
     {
         std::lock_guard<std::mutex> lock(queue_mutex_);
-        request_queue_.push(request);
+        request_queue_.push_back(std::move(request));
     }
     cv_.notify_one();
 }
 
+void OCRWorker::addTileTask(std::shared_ptr<DetTileTask> task) {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        tile_queue_.push(task);
+    }
+    cv_.notify_one();
+}
+
+void OCRWorker::removeCancelled(std::vector<std::shared_ptr<OCRRequest>>& removed) {
+    size_t first = removed.size();
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        auto it = std::stable_partition(request_queue_.begin(), request_queue_.end(),
+            [](const std::shared_ptr<OCRRequest>& request) {
+                return !request->cancel_token || !request->cancel_token->isCancelled();
+            });
+        std::move(it, request_queue_.end(), std::back_inserter(removed));
+        request_queue_.erase(it, request_queue_.end());
+    }
+    
+    // 在锁外给出响应，result_writer_ 属于 Worker 线程，这里单独构建；对冲中落败的一方不计为取消
+    JsonWriter writer;
+    for (size_t i = first; i < removed.size(); ++i) {
+        writeErrorJson(removed[i]->request_id, RequestCancelled().what(), worker_id_, writer);
+        if (removed[i]->setResult(writer.str())) {
+            cancelled_requests_.fetch_add(1);
+        }
+        pending_requests_.fetch_sub(1);
+    }
+}
+
+int64_t OCRWorker::shapeKey(const OCRRequest& request) const {
+    const cv::Mat& image = request.image_data;
+    if (image.empty()) {
+        return 0;
+    }
+    
+    // 跳过检测的请求：最宽的文字框决定最大的识别批宽度
+    if (request.task == OCRTask::RecognizeRegions || (request.task == OCRTask::Recognize && request.layout)) {
+        float max_ratio = 0.0f;
+        if (request.task == OCRTask::RecognizeRegions) {
+            for (const Quad& quad : request.regions) {
+                double width = std::max(cv::norm(quad[1] - quad[0]), cv::norm(quad[2] - quad[3]));
+                double height = std::max(cv::norm(quad[3] - quad[0]), cv::norm(quad[2] - quad[1]));
+                if (height > 0.0) {
+                    max_ratio = std::max(max_ratio, static_cast<float>(width / height));
+                }
+            }
+        } else {
+            for (const auto& field : request.layout->fields) {
+                float height = field.region.height * image.rows;
+                if (height > 0.0f) {
+                    max_ratio = std::max(max_ratio, field.region.width * image.cols / height);
+                }
+            }
+        }
+        return max_ratio > 0.0f ? ShapeAffinity::recKey(recognizer_->batch_width(max_ratio)) : 0;
+    }
+    
+    // 检测：区域检测按第一个区域计算，分块检测的分块尺寸不固定
+    cv::Size size = image.size();
+    if (!request.rois.empty()) {
+        size = (request.rois.front() & cv::Rect(0, 0, image.cols, image.rows)).size();
+        if (size.empty()) {
+            return 0;
+        }
+    }
+    if (DetTilePlanner::shouldTile(size, config_.tiled_det, detector_->limit_side_len())) {
+        return 0;
+    }
+    int limit_side_len = detector_->limit_side_len();
+    if (config_.cascade.enabled && request.task == OCRTask::Recognize && request.rois.empty()) {
+        // 级联模式先以快速通道的边长检测
+        limit_side_len = std::min(limit_side_len, config_.cascade.fast_side_len);
+    }
+    cv::Size input = detector_->input_size(size, limit_side_len);
+    return ShapeAffinity::detKey(input.height, input.width);
+}
+
+void OCRWorker::throwIfCancelled() const {
+    if (active_cancel_ && active_cancel_->isCancelled()) {
+        throw RequestCancelled();
+    }
+}
+
 void OCRWorker::workerLoop() {
     while (running_) {
         std::shared_ptr<OCRRequest> request;
+        std::shared_ptr<DetTileTask> tile_task;
         
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
-            cv_.wait(lock, [this] { return !request_queue_.empty() || !running_; });
+            cv_.wait(lock, [this] { return !request_queue_.empty() || !tile_queue_.empty() || !running_; });
             
             if (!running_) break;
             
-            if (!request_queue_.empty()) {
-                request = request_queue_.front();
-                request_queue_.pop();
+            // 分块任务有其他Worker在等待，优先处理
+            if (!tile_queue_.empty()) {
+                tile_task = std::move(tile_queue_.front());
+                tile_queue_.pop();
+                is_idle_ = false;
+            }
+            else if (!request_queue_.empty()) {
+                request = std::move(request_queue_.front());
+                request_queue_.pop_front();
                 is_idle_ = false;
             }
         }
         
+        if (tile_task) {
+            // 发起方可能已自行认领该分块
+            if (tile_task->claim()) {
+                runTileTask(*tile_task);
+            }
+            is_idle_ = true;
+            continue;
+        }
+        
         if (request) {
+            // 调用方已不再等待该结果 (超过截止时间或已取消)，不做推理
+            auto start_time = std::chrono::steady_clock::now();
+            const char* drop_reason = nullptr;
+            bool cancelled = false;
+            if (start_time > request->deadline) {
+                drop_reason = "Deadline exceeded before processing";
+            } else if (request->cancel_token && request->cancel_token->isCancelled()) {
+                cancelled = true;
+                drop_reason = "Request cancelled";
+            }
+            if (drop_reason) {
+                writeErrorJson(request->request_id, drop_reason, worker_id_, result_writer_);
+                if (request->setResult(result_writer_.str())) {
+                    (cancelled ? cancelled_requests_ : expired_requests_).fetch_add(1);
+                }
+                pending_requests_.fetch_sub(1);
+                is_idle_ = true;
+                if (completion_callback_) {
+                    completion_callback_(*request);
+                }
+                continue;
+            }
+            
+            active_cancel_ = request->cancel_token.get();
+            bool aborted = false;
+            int box_count = -1;
             try {
                 auto result = processRequest(*request);
-                
-                // 构建结果字符串
-                Json::Value json_result;
-                json_result["request_id"] = result.request_id;
-                json_result["width"] = result.width;
-                json_result["height"] = result.height;
-                json_result["success"] = result.success;
-                json_result["processing_time_ms"] = result.processing_time_ms;
-                json_result["worker_id"] = worker_id_;
-                
                 if (result.success) {
-                    Json::Value words_array(Json::arrayValue);
-                    for (const auto& word : result.words) {
-                        Json::Value word_map(Json::objectValue);
-                        word_map["text"] = word.text;
-                        word_map["confidence"] = word.confidence;
-                        Json::Value box_array(Json::arrayValue);
-                        for (const auto& point : word.box) {
-                            Json::Value point_array(Json::arrayValue);
-                            point_array.append(point[0]);
-                            point_array.append(point[1]);
-                            box_array.append(point_array);
-                        }
-                        word_map["box"] = box_array;
-                        words_array.append(word_map);
-                    }
-                    json_result["words"] = words_array;                    
-                } else {
-                    json_result["error"] = result.error_message;
+                    box_count = static_cast<int>(result.words.size());
                 }
                 
-                Json::StreamWriterBuilder builder;
-                builder["indentation"] = "";
-                builder["enableYAMLCompatibility"] = false;
-                builder["dropNullPlaceholders"] = false;
-                builder["useSpecialFloats"] = false;
-                builder["emitUTF8"] = true;
-                request->result_promise.set_value(Json::writeString(builder, json_result));
+                // 构建结果字符串
+                writeResultJson(result, worker_id_, result_writer_);
+                request->setResult(result_writer_.str());
+            }
+            catch (const RequestCancelled& e) {
+                aborted = true;
+                writeErrorJson(request->request_id, e.what(), worker_id_, result_writer_);
+                if (request->setResult(result_writer_.str())) {
+                    cancelled_requests_.fetch_add(1);
+                }
             }
             catch (const std::exception& e) {
-                Json::Value error_result;
-                error_result["request_id"] = request->request_id;
-                error_result["success"] = false;
-                error_result["error"] = e.what();
-                error_result["worker_id"] = worker_id_;
-                
-                Json::StreamWriterBuilder builder;
-                builder["indentation"] = "";
-                builder["enableYAMLCompatibility"] = false;
-                builder["dropNullPlaceholders"] = false;
-                builder["useSpecialFloats"] = false;
-                builder["emitUTF8"] = true;
-                request->result_promise.set_value(Json::writeString(builder, error_result));
+                writeErrorJson(request->request_id, e.what(), worker_id_, result_writer_);
+                request->setResult(result_writer_.str());
             }
             
+            active_cancel_ = nullptr;
+            
+            // 只有本线程写入，不需要比较交换；中途中止的请求不代表正常耗时
+            if (!aborted) {
+                double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+                double average = avg_service_ms_.load();
+                avg_service_ms_.store(average > 0.0 ? average * 0.8 + elapsed_ms * 0.2 : elapsed_ms);
+                request->service_ms = elapsed_ms;
+                request->box_count = box_count;
+            }
+            pending_requests_.fetch_sub(1);
             is_idle_ = true;
+            if (completion_callback_) {
+                completion_callback_(*request);
+            }
         }
     }
 }
 
+void OCRWorker::writeResultJson(const OCRResult& result, int worker_id, JsonWriter& writer) {
+    // 键按 JsonCpp 的字典序输出
+    writer.clear();
+    writer.beginObject();
+    if (result.success && result.boxes_only) {
+        writer.key("boxes");
+        writer.beginArray();
+        for (const auto& word : result.words) {
+            writer.beginArray();
+            for (const auto& point : word.box) {
+                writer.beginArray();
+                writer.value(point.x);
+                writer.value(point.y);
+                writer.endArray();
+            }
+            writer.endArray();
+        }
+        writer.endArray();
+    }
+    if (!result.success) {
+        writer.key("error");
+        writer.value(std::string_view(result.error_message));
+    }
+    writer.key("height");
+    writer.value(result.height);
+    writer.key("processing_time_ms");
+    writer.value(result.processing_time_ms);
+    writer.key("request_id");
+    writer.value(result.request_id);
+    writer.key("success");
+    writer.value(result.success);
+    writer.key("width");
+    writer.value(result.width);
+    if (result.success && !result.boxes_only) {
+        writer.key("words");
+        writer.beginArray();
+        for (const auto& word : result.words) {
+            writer.beginObject();
+            writer.key("box");
+            writer.beginArray();
+            for (const auto& point : word.box) {
+                writer.beginArray();
+                writer.value(point.x);
+                writer.value(point.y);
+                writer.endArray();
+            }
+            writer.endArray();
+            writer.key("confidence");
+            writer.value(static_cast<double>(word.confidence));
+            if (!word.field.empty()) {
+                writer.key("field");
+                writer.value(std::string_view(word.field));
+            }
+            writer.key("text");
+            writer.value(std::string_view(word.text));
+            writer.endObject();
+        }
+        writer.endArray();
+    }
+    writer.key("worker_id");
+    writer.value(worker_id);
+    writer.endObject();
+}
+
+void OCRWorker::writeErrorJson(int request_id, const std::string& error, int worker_id, JsonWriter& writer) {
+    writer.clear();
+    writer.beginObject();
+    writer.key("error");
+    writer.value(std::string_view(error));
+    writer.key("request_id");
+    writer.value(request_id);
+    writer.key("success");
+    writer.value(false);
+    writer.key("worker_id");
+    writer.value(worker_id);
+    writer.endObject();
+}
+
+void OCRWorker::writeRejectJson(int request_id, const std::string& error, int retry_after_ms, JsonWriter& writer) {
+    writer.clear();
+    writer.beginObject();
+    writer.key("error");
+    writer.value(std::string_view(error));
+    writer.key("request_id");
+    writer.value(request_id);
+    writer.key("retry_after_ms");
+    writer.value(retry_after_ms);
+    writer.key("success");
+    writer.value(false);
+    writer.endObject();
+}
+
 OCRResult OCRWorker::processRequest(const OCRRequest& request) {
     auto start_time = std::chrono::high_resolution_clock::now();
     
@@ -217,7 +484,7 @@ OCRResult OCRWorker::processRequest(const OCRRequest& request) {
     result.request_id = request.request_id;
     result.success = false;
       try {
-        cv::Mat image = request.image_data;
+        const cv::Mat& image = request.image_data;
         
         // 验证图像数据
         if (image.empty()) {
@@ -227,87 +494,505 @@ OCRResult OCRWorker::processRequest(const OCRRequest& request) {
         result.width = image.cols;
         result.height = image.rows;
         
-        // 文本检测
-        std::vector<std::vector<std::vector<int>>> det_boxes;
-        std::vector<double> det_times;
-        detector_->Run(image, det_boxes, det_times);
+        if (request.task == OCRTask::RecognizeRegions) {
+            // 调用方给定文字框，只运行识别
+            recognizeRegions(image, request.regions, result.words);
+        } else if (request.task == OCRTask::Detect) {
+            // 只运行检测，文字框放在 words 中由 writeResultJson 输出为 boxes
+            std::vector<Quad> det_boxes;
+            if (request.rois.empty()) {
+                detectFull(image, det_boxes);
+            } else {
+                detectRois(image, request.rois, det_boxes);
+            }
+            for (const auto& box : det_boxes) {
+                WordResult word;
+                word.box = box;
+                word.confidence = 0.0f;
+                result.words.push_back(word);
+            }
+            result.boxes_only = true;
+        } else if (request.layout) {
+            // 版面模板跳过检测
+            recognizeLayout(image, *request.layout, result.words);
+        } else if (!request.rois.empty()) {
+            // 只在调用方关心的区域内检测
+            std::vector<Quad> det_boxes;
+            detectRois(image, request.rois, det_boxes);
+            recognizeBoxes(image, det_boxes, result.words);
+        } else if (!config_.cascade.enabled || !runCascade(image, result.words)) {
+            // 级联模式：快速通道结果可信时直接返回，否则走常规单次流程
+            std::vector<Quad> det_boxes;
+            detectFull(image, det_boxes);
+            result.words.clear();
+            recognizeBoxes(image, det_boxes, result.words);
+        }
+        // 只有整图识别会缩小解码；检测不输出识别结果，不必在原图上重新识别
+        if (request.reduced_source && request.task == OCRTask::Recognize) {
+            result.width = request.reduced_source->original_size.width;
+            result.height = request.reduced_source->original_size.height;
+            restoreFullResolution(*request.reduced_source, result.words);
+        }
+        result.success = true;
         
-        if (det_boxes.empty()) {
-            result.success = true;
-            result.words = {};
-            auto end_time = std::chrono::high_resolution_clock::now();
-            result.processing_time_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
-            return result;
+        auto end_time = std::chrono::high_resolution_clock::now();
+        result.processing_time_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+    }
+    catch (const RequestCancelled&) {
+        throw;
+    }
+    catch (const std::exception& e) {
+        result.error_message = e.what();
+    }
+    
+    return result;
+}
+
+void OCRWorker::detectFull(const cv::Mat& image, std::vector<Quad>& boxes) {
+    std::vector<double> det_times;
+    if (DetTilePlanner::shouldTile(image.size(), config_.tiled_det, detector_->limit_side_len())) {
+        detectTiled(image, boxes);
+    } else {
+        if (!detector_->Run(image, boxes, det_times)) {
+            throw std::runtime_error("Text detection inference failed");
+        }
+    }
+}
+
+void OCRWorker::recognizeBoxes(const cv::Mat& image, const std::vector<Quad>& boxes,
+                               std::vector<WordResult>& words) {
+    // 检测之后、裁剪和识别之前
+    throwIfCancelled();
+    
+    // 按检测框做透视变换裁剪，直接输出识别器输入高度；启用分类器时保留原始高度供分类使用
+    std::vector<cv::Mat> crops;
+    int target_h = enable_cls_ ? 0 : recognizer_->rec_img_h();
+    crop_op_.Run(image, boxes, target_h, crops);
+    
+    // kept_boxes 与 text_images 一一对应，跳过退化的框
+    std::vector<cv::Mat> text_images;
+    std::vector<const Quad*> kept_boxes;
+    for (size_t i = 0; i < crops.size(); ++i) {
+        if (!crops[i].empty()) {
+            text_images.push_back(std::move(crops[i]));
+            kept_boxes.push_back(&boxes[i]);
+        }
+    }
+    
+    if (text_images.empty()) {
+        return;
+    }
+    
+    // 文本方向分类（可选）
+    if (enable_cls_ && classifier_) {
+        std::vector<int> cls_labels(text_images.size());
+        std::vector<float> cls_scores(text_images.size());
+        std::vector<double> cls_times;
+        if (!classifier_->Run(text_images, cls_labels, cls_scores, cls_times)) {
+            throw std::runtime_error("Text direction classification inference failed");
         }
         
-        // 提取文本区域图像
-        std::vector<cv::Mat> text_images;
-        for (const auto& box : det_boxes) {
-            // 创建ROI
-            std::vector<cv::Point2f> points;
-            for (const auto& point : box) {
-                points.emplace_back(point[0], point[1]);
+        // 根据分类结果旋转图像
+        for (size_t i = 0; i < text_images.size() && i < cls_labels.size(); ++i) {
+            if (cls_labels[i] == 1) {  // 需要旋转180度
+                cv::rotate(text_images[i], text_images[i], cv::ROTATE_180);
             }
-            
-            // 计算边界矩形
-            cv::Rect bbox = cv::boundingRect(points);
-            bbox &= cv::Rect(0, 0, image.cols, image.rows);  // 确保在图像范围内
-            
-            if (bbox.width > 0 && bbox.height > 0) {
-                text_images.push_back(image(bbox));
+        }
+    }
+    // 如果不启用分类器，跳过文本方向检测，直接进行识别
+    
+    std::vector<std::string> rec_texts(text_images.size());
+    std::vector<float> rec_scores(text_images.size());
+    
+    // 识别缓存：模板上重复出现的标签直接取缓存结果，只把未命中的区域送入识别器
+    RecognitionCache* rec_cache = config_.rec_cache.enabled ? &RecognitionCache::instance() : nullptr;
+    std::vector<RecognitionCache::Fingerprint> fingerprints;
+    std::vector<size_t> miss_indices;
+    if (rec_cache) {
+        fingerprints.reserve(text_images.size());
+        for (size_t i = 0; i < text_images.size(); ++i) {
+            fingerprints.push_back(RecognitionCache::fingerprint(text_images[i]));
+            if (!rec_cache->lookup(fingerprints[i], rec_texts[i], rec_scores[i])) {
+                miss_indices.push_back(i);
             }
         }
-        
-        if (text_images.empty()) {
-            result.success = true;
-            result.words = {};
-            auto end_time = std::chrono::high_resolution_clock::now();
-            result.processing_time_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
-            return result;
+    }
+    
+    // 文本识别
+    std::vector<double> rec_times;
+    if (!rec_cache) {
+        if (!recognizer_->Run(text_images, rec_texts, rec_scores, rec_times, active_cancel_)) {
+            throw std::runtime_error("Text recognition inference failed");
+        }
+        throwIfCancelled();
+    } else if (!miss_indices.empty()) {
+        std::vector<cv::Mat> miss_images;
+        miss_images.reserve(miss_indices.size());
+        for (size_t index : miss_indices) {
+            miss_images.push_back(text_images[index]);
         }
+        std::vector<std::string> miss_texts(miss_images.size());
+        std::vector<float> miss_scores(miss_images.size());
+        if (!recognizer_->Run(miss_images, miss_texts, miss_scores, rec_times, active_cancel_)) {
+            throw std::runtime_error("Text recognition inference failed");
+        }
+        throwIfCancelled();  // 中止时未识别的区域为空结果，不能写入缓存
         
-        // 文本方向分类（可选）
-        if (enable_cls_ && classifier_) {
-            std::vector<int> cls_labels(text_images.size());
-            std::vector<float> cls_scores(text_images.size());
-            std::vector<double> cls_times;
-            classifier_->Run(text_images, cls_labels, cls_scores, cls_times);
-            
-            // 根据分类结果旋转图像
-            for (size_t i = 0; i < text_images.size() && i < cls_labels.size(); ++i) {
-                if (cls_labels[i] == 1) {  // 需要旋转180度
-                    cv::rotate(text_images[i], text_images[i], cv::ROTATE_180);
+        for (size_t j = 0; j < miss_indices.size(); ++j) {
+            size_t index = miss_indices[j];
+            rec_texts[index] = std::move(miss_texts[j]);
+            rec_scores[index] = miss_scores[j];
+            rec_cache->insert(std::move(fingerprints[index]), rec_texts[index], rec_scores[index]);
+        }
+    }
+    
+    for (size_t i = 0; i < rec_texts.size(); i++) {
+        WordResult word;
+        word.text = rec_texts[i];
+        word.confidence = rec_scores[i];
+        word.box = *kept_boxes[i];
+        words.push_back(word);
+    }
+}
+
+bool OCRWorker::runCascade(const cv::Mat& image, std::vector<WordResult>& words) {
+    const CascadeConfig& cascade = config_.cascade;
+    
+    // 快速通道的检测边长不小于常规边长时没有收益；需要分块的长图也不走级联
+    if (cascade.fast_side_len >= detector_->limit_side_len() ||
+        DetTilePlanner::shouldTile(image.size(), config_.tiled_det, detector_->limit_side_len())) {
+        return false;
+    }
+    
+    // 第一遍：低分辨率检测，识别仍然从原图裁剪
+    std::vector<Quad> fast_boxes;
+    std::vector<double> det_times;
+    if (!detector_->Run(image, fast_boxes, det_times, cascade.fast_side_len)) {
+        throw std::runtime_error("Text detection inference failed");
+    }
+    if (fast_boxes.empty()) {
+        // 低分辨率下小字可能整体漏检，无法判断是否为空图
+        cascade_fallbacks_.fetch_add(1);
+        return false;
+    }
+    
+    // 漏检的文字无法复检：min_text_height 是常规流程输入中可靠检出的文字高度，按两遍的缩放比
+    // 换算到快速通道 (即对应原图中相同高度的文字)，但不低于检测器本身的下限。最小的文字已接近
+    // 该高度，或文字框覆盖面积过小时，更小或更淡的文字可能整体漏检
+    cv::Size fast_input = detector_->input_size(image.size(), cascade.fast_side_len);
+    cv::Size full_input = detector_->input_size(image.size(), detector_->limit_side_len());
+    double scale = static_cast<double>(fast_input.height) / image.rows;
+    double full_scale = static_cast<double>(full_input.height) / image.rows;
+    double min_height = std::max<double>(kCascadeDetFloor, cascade.min_text_height * scale / full_scale);
+    double box_area = 0.0;
+    for (const auto& box : fast_boxes) {
+        double height = std::min(cv::norm(box[3] - box[0]), cv::norm(box[2] - box[1]));
+        if (height * scale < min_height) {
+            cascade_fallbacks_.fetch_add(1);
+            return false;
+        }
+        box_area += cv::contourArea(box);
+    }
+    if (box_area < cascade.min_coverage * image.total()) {
+        cascade_fallbacks_.fetch_add(1);
+        return false;
+    }
+    
+    std::vector<WordResult> fast_words;
+    recognizeBoxes(image, fast_boxes, fast_words);
+    if (fast_words.empty()) {
+        // 文字框全部退化，没有可用的结果
+        cascade_fallbacks_.fetch_add(1);
+        return false;
+    }
+    
+    std::vector<size_t> low_confidence;
+    for (size_t i = 0; i < fast_words.size(); ++i) {
+        if (fast_words[i].confidence < cascade.rec_threshold) {
+            low_confidence.push_back(i);
+        }
+    }
+    if (low_confidence.size() > fast_words.size() * cascade.max_refine_ratio) {
+        // 回退到常规检测，但与快速通道高置信度结果重合的文字框沿用已有的识别结果
+        cascade_fallbacks_.fetch_add(1);
+        std::vector<Quad> det_boxes;
+        detectFull(image, det_boxes);
+        std::vector<Quad> unmatched;
+        words.clear();
+        for (const auto& box : det_boxes) {
+            cv::Rect rect = cv::boundingRect(box);
+            const WordResult* reused = nullptr;
+            for (const auto& word : fast_words) {
+                if (word.confidence < cascade.rec_threshold) {
+                    continue;
+                }
+                cv::Rect fast_rect = cv::boundingRect(word.box);
+                double overlap = (rect & fast_rect).area();
+                if (overlap >= kCascadeReuseIoU * (rect.area() + fast_rect.area() - overlap)) {
+                    reused = &word;
+                    break;
                 }
             }
+            if (reused) {
+                words.push_back(*reused);
+                words.back().box = box;
+            } else {
+                unmatched.push_back(box);
+            }
+        }
+        recognizeBoxes(image, unmatched, words);
+        return true;
+    }
+    cascade_accepted_.fetch_add(1);
+    
+    // 第二遍：低置信度区域在原图上按原始分辨率重新检测和识别
+    std::vector<bool> replaced(fast_words.size(), false);
+    std::vector<WordResult> refined_words;
+    for (size_t index : low_confidence) {
+        cv::Rect bbox = cv::boundingRect(fast_words[index].box) & cv::Rect(0, 0, image.cols, image.rows);
+        if (bbox.width <= 0 || bbox.height <= 0) {
+            continue;
         }
-        // 如果不启用分类器，跳过文本方向检测，直接进行识别
         
-        // 文本识别
-        std::vector<std::string> rec_texts(text_images.size());
-        std::vector<float> rec_scores(text_images.size());
-        std::vector<double> rec_times;
-        recognizer_->Run(text_images, rec_texts, rec_scores, rec_times);
+        int pad = std::max(1, static_cast<int>(bbox.height * cascade.roi_expand));
+        cv::Rect roi(bbox.x - pad, bbox.y - pad, bbox.width + 2 * pad, bbox.height + 2 * pad);
+        roi &= cv::Rect(0, 0, image.cols, image.rows);
         
-        // 设置结果
-        result.success = true;
-        for (size_t i = 0; i < rec_texts.size(); i++)
-        {
-            WordResult word;
-            word.text = rec_texts[i];
-            word.confidence = rec_scores[i];
-            word.box = det_boxes[i];
-            result.words.push_back(word);
+        std::vector<Quad> roi_boxes;
+        if (!detector_->Run(image(roi), roi_boxes, det_times, std::max(roi.width, roi.height))) {
+            throw std::runtime_error("Text detection inference failed");
         }
         
+        // 只保留中心落在原框内的复检结果，扩展区域里的相邻文字由快速通道负责
+        std::vector<Quad> kept;
+        for (auto& box : roi_boxes) {
+            int cx = 0, cy = 0;
+            for (auto& point : box) {
+                point += roi.tl();
+                cx += point.x;
+                cy += point.y;
+            }
+            cx /= static_cast<int>(box.size());
+            cy /= static_cast<int>(box.size());
+            if (bbox.contains(cv::Point(cx, cy))) {
+                kept.push_back(box);
+            }
+        }
+        if (kept.empty()) {
+            continue;
+        }
         
-        auto end_time = std::chrono::high_resolution_clock::now();
-        result.processing_time_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+        std::vector<WordResult> roi_words;
+        recognizeBoxes(image, kept, roi_words);
+        if (!roi_words.empty()) {
+            replaced[index] = true;
+            refined_words.insert(refined_words.end(), roi_words.begin(), roi_words.end());
+        }
     }
-    catch (const std::exception& e) {
-        result.error_message = e.what();
+    
+    words.clear();
+    for (size_t i = 0; i < fast_words.size(); ++i) {
+        if (!replaced[i]) {
+            words.push_back(std::move(fast_words[i]));
+        }
     }
+    words.insert(words.end(), refined_words.begin(), refined_words.end());
+    return true;
+}
+
+void OCRWorker::recognizeLayout(const cv::Mat& image, const LayoutTemplate& layout, std::vector<WordResult>& words) {
+    // 字段区域代替检测框，无文字的字段为全零四边形，由 recognizeBoxes 当作退化框跳过
+    std::vector<Quad> boxes = layout.locate(image);
+    size_t first = words.size();
+    recognizeBoxes(image, boxes, words);
     
-    return result;
+    // 按框坐标对齐字段名
+    size_t next = 0;
+    for (size_t i = first; i < words.size(); ++i) {
+        while (next < boxes.size() && boxes[next] != words[i].box) {
+            ++next;
+        }
+        if (next == boxes.size()) {
+            break;
+        }
+        words[i].field = layout.fields[next].name;
+        ++next;
+    }
+}
+
+void OCRWorker::recognizeRegions(const cv::Mat& image, const std::vector<Quad>& regions,
+                                 std::vector<WordResult>& words) {
+    // 调用方的坐标夹到图像内，越界的框不会放大裁剪尺寸
+    std::vector<Quad> boxes = regions;
+    for (auto& box : boxes) {
+        for (auto& point : box) {
+            point.x = std::clamp(point.x, 0, image.cols - 1);
+            point.y = std::clamp(point.y, 0, image.rows - 1);
+        }
+    }
+    std::vector<WordResult> recognized;
+    recognizeBoxes(image, boxes, recognized);
+    
+    // recognizeBoxes 会跳过退化的框，按框坐标对齐，退化的框输出空文本，保证与请求一一对应
+    size_t next = 0;
+    for (const auto& box : boxes) {
+        if (next < recognized.size() && recognized[next].box == box) {
+            words.push_back(std::move(recognized[next++]));
+        } else {
+            WordResult word;
+            word.box = box;
+            word.confidence = 0.0f;
+            words.push_back(word);
+        }
+    }
+}
+
+void OCRWorker::detectRois(const cv::Mat& image, const std::vector<cv::Rect>& rois, std::vector<Quad>& boxes) {
+    // 各区域分别检测 (区域视图不拷贝像素)，框坐标平移回整图；区域重叠时框可能重复
+    const cv::Rect bounds(0, 0, image.cols, image.rows);
+    for (const auto& rect : rois) {
+        cv::Rect roi = rect & bounds;
+        if (roi.width <= 0 || roi.height <= 0) {
+            continue;
+        }
+        std::vector<Quad> roi_boxes;
+        detectFull(image(roi), roi_boxes);
+        for (auto& box : roi_boxes) {
+            for (auto& point : box) {
+                point += roi.tl();
+            }
+            boxes.push_back(box);
+        }
+    }
+}
+
+void OCRWorker::restoreFullResolution(const ReducedImageSource& source, std::vector<WordResult>& words) {
+    const int scale = source.scale;
+    const cv::Size& size = source.original_size;
+    
+    // 框坐标映射回原图，缩小图上过矮的文字记下来重新解码识别
+    std::vector<size_t> small_words;
+    std::vector<Quad> full_boxes;
+    double min_height = 0.0;
+    for (size_t i = 0; i < words.size(); ++i) {
+        Quad& box = words[i].box;
+        double text_height = std::min(std::min(cv::norm(box[3] - box[0]), cv::norm(box[2] - box[1])),
+                                      std::min(cv::norm(box[1] - box[0]), cv::norm(box[2] - box[3])));
+        for (auto& point : box) {
+            point.x = std::clamp(point.x * scale + scale / 2, 0, size.width - 1);
+            point.y = std::clamp(point.y * scale + scale / 2, 0, size.height - 1);
+        }
+        if (text_height < config_.reduced_decode.min_text_height) {
+            min_height = small_words.empty() ? text_height : std::min(min_height, text_height);
+            small_words.push_back(i);
+            full_boxes.push_back(box);
+        }
+    }
+    if (small_words.empty()) {
+        return;
+    }
+    
+    // 只解码到最矮的文字达到识别高度所需的倍数，大多数情况下 1/2 即可，不必解码整张原图
+    int reduction = source.redecodeScale(min_height, config_.reduced_decode.min_text_height);
+    cv::Mat redecoded = source.decodeAt(reduction);
+    cv::Size expected((size.width + reduction - 1) / reduction, (size.height + reduction - 1) / reduction);
+    if (redecoded.empty() || std::abs(redecoded.cols - expected.width) > 1 ||
+        std::abs(redecoded.rows - expected.height) > 1) {
+        return;
+    }
+    redecodes_.fetch_add(1);
+    std::vector<Quad> redecoded_boxes;
+    redecoded_boxes.reserve(full_boxes.size());
+    for (const auto& box : full_boxes) {
+        Quad scaled = box;
+        for (auto& point : scaled) {
+            point.x = std::min(point.x / reduction, redecoded.cols - 1);
+            point.y = std::min(point.y / reduction, redecoded.rows - 1);
+        }
+        redecoded_boxes.push_back(scaled);
+    }
+    std::vector<WordResult> refined;
+    recognizeBoxes(redecoded, redecoded_boxes, refined);
+    
+    // recognizeBoxes 会跳过退化的框，按框坐标对齐
+    size_t next = 0;
+    for (const auto& word : refined) {
+        while (next < small_words.size() && redecoded_boxes[next] != word.box) {
+            ++next;
+        }
+        if (next == small_words.size()) {
+            break;
+        }
+        words[small_words[next]].text = word.text;
+        words[small_words[next]].confidence = word.confidence;
+        ++next;
+    }
+}
+
+void OCRWorker::runTileTask(DetTileTask& task) {
+    // 分块可能在其他Worker的线程上执行，异常交给发起方，不能逃出本线程
+    try {
+        std::vector<double> det_times;
+        if (!detector_->Run(task.tile, task.boxes, det_times, task.limit_side_len)) {
+            throw std::runtime_error("Text detection inference failed");
+        }
+        task.done.set_value();
+    } catch (...) {
+        task.done.set_exception(std::current_exception());
+    }
+}
+
+void OCRWorker::detectTiled(const cv::Mat& image, std::vector<Quad>& boxes) {
+    std::vector<cv::Rect> tiles = DetTilePlanner::planTiles(image.size(), config_.tiled_det);
+    
+    std::vector<std::shared_ptr<DetTileTask>> tasks;
+    std::vector<std::future<void>> futures;
+    tasks.reserve(tiles.size());
+    futures.reserve(tiles.size());
+    for (const auto& rect : tiles) {
+        auto task = std::make_shared<DetTileTask>();
+        task->tile = image(rect);
+        task->limit_side_len = std::max(rect.width, rect.height);
+        futures.push_back(task->done.get_future());
+        tasks.push_back(std::move(task));
+    }
+    
+    // 第一块留给自己，其余分块轮流分发给当前空闲的Worker
+    std::vector<OCRWorker*> idle_peers;
+    for (OCRWorker* peer : peers_) {
+        if (peer != this && peer->isIdle()) {
+            idle_peers.push_back(peer);
+        }
+    }
+    if (!idle_peers.empty()) {
+        for (size_t i = 1; i < tasks.size(); ++i) {
+            idle_peers[(i - 1) % idle_peers.size()]->addTileTask(tasks[i]);
+        }
+    }
+    
+    // 本线程执行所有尚未被其他Worker认领的分块，避免等待繁忙的Worker
+    for (auto& task : tasks) {
+        if (active_cancel_ && active_cancel_->isCancelled()) {
+            // 认领剩余分块，其他Worker也不再检测
+            for (auto& rest : tasks) {
+                rest->claim();
+            }
+            throwIfCancelled();
+        }
+        if (task->claim()) {
+            runTileTask(*task);
+        }
+    }
+    for (auto& future : futures) {
+        future.get();  // 任一分块检测失败时抛出
+    }
+    
+    std::vector<std::vector<Quad>> tile_boxes;
+    tile_boxes.reserve(tasks.size());
+    for (auto& task : tasks) {
+        tile_boxes.push_back(std::move(task->boxes));
+    }
+    boxes = DetTilePlanner::mergeTileBoxes(tile_boxes, tiles);
 }
 
 std::string OCRWorker::getWorkerRecommendation(bool use_gpu, bool enable_cls) {
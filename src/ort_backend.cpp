@@ -0,0 +1,169 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// ONNX Runtime CPU backend. Only built with PADDLE_OCR_WITH_ORT defined and
+// onnxruntime include/lib on the compiler path. Models are exported with
+// paddle2onnx to <model_dir>/inference.onnx next to the Paddle files.
+
+#ifdef PADDLE_OCR_WITH_ORT
+
+#include <paddle_ocr/inference_backend.h>
+#include <paddle_ocr/utility.h>
+#include <onnxruntime_cxx_api.h>
+
+#include <cstring>
+#include <iostream>
+#include <numeric>
+
+namespace PaddleOCR {
+
+namespace {
+
+Ort::Env &OrtEnv() noexcept {
+  static Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "paddle_ocr");
+  return env;
+}
+
+class OrtBackend : public InferenceBackend {
+public:
+  explicit OrtBackend(std::shared_ptr<Ort::Session> session) noexcept
+      : session_(std::move(session)) {
+    Ort::AllocatorWithDefaultOptions allocator;
+    this->input_name_ =
+        this->session_->GetInputNameAllocated(0, allocator).get();
+    this->output_name_ =
+        this->session_->GetOutputNameAllocated(0, allocator).get();
+  }
+
+  void Reshape(const std::vector<int> &shape) noexcept override {
+    this->input_shape_.assign(shape.begin(), shape.end());
+    size_t num = std::accumulate(shape.begin(), shape.end(), size_t(1),
+                                 std::multiplies<size_t>());
+    this->input_.resize(num);
+  }
+
+  void CopyFromCpu(const float *data) noexcept override {
+    std::memcpy(this->input_.data(), data, this->input_.size() * sizeof(float));
+  }
+
+  bool Run() noexcept override {
+    try {
+      auto memory_info =
+          Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+      Ort::Value input = Ort::Value::CreateTensor<float>(
+          memory_info, this->input_.data(), this->input_.size(),
+          this->input_shape_.data(), this->input_shape_.size());
+      const char *input_names[] = {this->input_name_.c_str()};
+      const char *output_names[] = {this->output_name_.c_str()};
+      auto outputs = this->session_->Run(Ort::RunOptions{nullptr},
+                                         input_names, &input, 1,
+                                         output_names, 1);
+      this->output_ = std::move(outputs.front());
+      return true;
+    } catch (const Ort::Exception &e) {
+      std::cerr << "[ERROR] ONNX Runtime run failed: " << e.what()
+                << std::endl;
+      return false;
+    }
+  }
+
+  std::vector<int> OutputShape() noexcept override {
+    std::vector<int> shape;
+    if (this->output_) {
+      for (int64_t dim :
+           this->output_.GetTensorTypeAndShapeInfo().GetShape()) {
+        shape.push_back(int(dim));
+      }
+    }
+    return shape;
+  }
+
+  void CopyToCpu(float *data) noexcept override {
+    if (!this->output_) {
+      return;
+    }
+    size_t num = this->output_.GetTensorTypeAndShapeInfo().GetElementCount();
+    std::memcpy(data, this->output_.GetTensorData<float>(),
+                num * sizeof(float));
+  }
+
+  // Ort::Session::Run is thread safe, clones share the session and only
+  // keep their own input/output buffers
+  std::unique_ptr<InferenceBackend> Clone() noexcept override {
+    return std::make_unique<OrtBackend>(this->session_);
+  }
+
+  std::string Name() const noexcept override { return "onnxruntime"; }
+
+  const std::string &EffectivePrecision() const noexcept override {
+    static const std::string fp32 = "fp32";
+    return fp32;
+  }
+
+private:
+  std::shared_ptr<Ort::Session> session_;
+  std::string input_name_;
+  std::string output_name_;
+  std::vector<int64_t> input_shape_;
+  std::vector<float> input_;
+  Ort::Value output_{nullptr};
+};
+
+} // namespace
+
+std::unique_ptr<InferenceBackend>
+CreateOrtBackend(const InferenceOptions &options) noexcept {
+  std::string model_path;
+  for (const char *name : {"/inference.onnx", "/model.onnx"}) {
+    if (Utility::PathExists(options.model_dir + name)) {
+      model_path = options.model_dir + name;
+      break;
+    }
+  }
+  if (model_path.empty()) {
+    return nullptr;
+  }
+  if (options.use_gpu || options.precision != "fp32") {
+    std::cerr << "[WARNING] ONNX Runtime backend runs fp32 on CPU only, "
+              << options.model_name << " ignores gpu/precision settings"
+              << std::endl;
+  }
+
+  try {
+    Ort::SessionOptions session_options;
+    session_options.SetIntraOpNumThreads(options.cpu_math_library_num_threads);
+    session_options.SetInterOpNumThreads(1);
+    session_options.SetGraphOptimizationLevel(
+        GraphOptimizationLevel::ORT_ENABLE_ALL);
+#ifdef _WIN32
+    std::wstring wide_path(model_path.begin(), model_path.end());
+    auto session = std::make_shared<Ort::Session>(
+        OrtEnv(), wide_path.c_str(), session_options);
+#else
+    auto session = std::make_shared<Ort::Session>(
+        OrtEnv(), model_path.c_str(), session_options);
+#endif
+    std::cout << "[INFO] Using " << options.model_name
+              << " Model: " << model_path << " (onnxruntime)" << std::endl;
+    return std::make_unique<OrtBackend>(std::move(session));
+  } catch (const Ort::Exception &e) {
+    std::cerr << "[ERROR] Failed to load " << model_path << ": " << e.what()
+              << std::endl;
+    return nullptr;
+  }
+}
+
+} // namespace PaddleOCR
+
+#endif // PADDLE_OCR_WITH_ORT
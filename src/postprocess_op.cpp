@@ -15,40 +15,41 @@
 #include <paddle_ocr/clipper.h>
 #include <paddle_ocr/postprocess_op.h>
 
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PADDLE_OCR_CTC_SSE2 1
+#endif
+
 namespace PaddleOCR {
 
-void DBPostProcessor::GetContourArea(const std::vector<std::vector<float>> &box,
-                                     float unclip_ratio,
+void DBPostProcessor::GetContourArea(const MiniBox &box, float unclip_ratio,
                                      float &distance) noexcept {
   int pts_num = 4;
   float area = 0.0f;
   float dist = 0.0f;
   for (int i = 0; i < pts_num; ++i) {
-    area += box[i][0] * box[(i + 1) % pts_num][1] -
-            box[i][1] * box[(i + 1) % pts_num][0];
-    dist += sqrtf((box[i][0] - box[(i + 1) % pts_num][0]) *
-                      (box[i][0] - box[(i + 1) % pts_num][0]) +
-                  (box[i][1] - box[(i + 1) % pts_num][1]) *
-                      (box[i][1] - box[(i + 1) % pts_num][1]));
+    const cv::Point2f &a = box[i];
+    const cv::Point2f &b = box[(i + 1) % pts_num];
+    area += a.x * b.y - a.y * b.x;
+    dist += sqrtf((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y));
   }
   area = fabs(float(area / 2.0));
 
   distance = area * unclip_ratio / dist;
 }
 
-cv::RotatedRect
-DBPostProcessor::UnClip(const std::vector<std::vector<float>> &box,
-                        const float &unclip_ratio) noexcept {
+cv::RotatedRect DBPostProcessor::UnClip(const MiniBox &box,
+                                        const float &unclip_ratio) noexcept {
   float distance = 1.0;
 
   GetContourArea(box, unclip_ratio, distance);
 
   ClipperLib::ClipperOffset offset;
   ClipperLib::Path p;
-  p.emplace_back(int(box[0][0]), int(box[0][1]));
-  p.emplace_back(int(box[1][0]), int(box[1][1]));
-  p.emplace_back(int(box[2][0]), int(box[2][1]));
-  p.emplace_back(int(box[3][0]), int(box[3][1]));
+  for (const cv::Point2f &pt : box) {
+    p.emplace_back(int(pt.x), int(pt.y));
+  }
   offset.AddPath(p, ClipperLib::jtRound, ClipperLib::etClosedPolygon);
 
   ClipperLib::Paths soln;
@@ -84,74 +85,55 @@ float **DBPostProcessor::Mat2Vec(const cv::Mat &mat) noexcept {
   return array;
 }
 
-std::vector<std::vector<int>> DBPostProcessor::OrderPointsClockwise(
-    const std::vector<std::vector<int>> &pts) noexcept {
-  std::vector<std::vector<int>> box = pts;
+Quad DBPostProcessor::OrderPointsClockwise(const Quad &pts) noexcept {
+  Quad box = pts;
   std::sort(box.begin(), box.end(), XsortInt);
 
-  std::vector<std::vector<int>> leftmost = {box[0], box[1]};
-  std::vector<std::vector<int>> rightmost = {box[2], box[3]};
+  cv::Point leftmost[2] = {box[0], box[1]};
+  cv::Point rightmost[2] = {box[2], box[3]};
 
-  if (leftmost[0][1] > leftmost[1][1])
+  if (leftmost[0].y > leftmost[1].y)
     std::swap(leftmost[0], leftmost[1]);
 
-  if (rightmost[0][1] > rightmost[1][1])
+  if (rightmost[0].y > rightmost[1].y)
     std::swap(rightmost[0], rightmost[1]);
 
-  std::vector<std::vector<int>> rect = {leftmost[0], rightmost[0], rightmost[1],
-                                        leftmost[1]};
-  return rect;
-}
-
-std::vector<std::vector<float>>
-DBPostProcessor::Mat2Vector(const cv::Mat &mat) noexcept {
-  std::vector<std::vector<float>> img_vec;
-
-  for (int i = 0; i < mat.rows; ++i) {
-    std::vector<float> tmp;
-    for (int j = 0; j < mat.cols; ++j) {
-      tmp.emplace_back(mat.at<float>(i, j));
-    }
-    img_vec.emplace_back(std::move(tmp));
-  }
-  return img_vec;
+  return {leftmost[0], rightmost[0], rightmost[1], leftmost[1]};
 }
 
-bool DBPostProcessor::XsortFp32(const std::vector<float> &a,
-                                const std::vector<float> &b) noexcept {
-  if (a[0] != b[0])
-    return a[0] < b[0];
+bool DBPostProcessor::XsortFp32(const cv::Point2f &a,
+                                const cv::Point2f &b) noexcept {
+  if (a.x != b.x)
+    return a.x < b.x;
   return false;
 }
 
-bool DBPostProcessor::XsortInt(const std::vector<int> &a,
-                               const std::vector<int> &b) noexcept {
-  if (a[0] != b[0])
-    return a[0] < b[0];
+bool DBPostProcessor::XsortInt(const cv::Point &a,
+                               const cv::Point &b) noexcept {
+  if (a.x != b.x)
+    return a.x < b.x;
   return false;
 }
 
-std::vector<std::vector<float>>
+DBPostProcessor::MiniBox
 DBPostProcessor::GetMiniBoxes(const cv::RotatedRect &box,
                               float &ssid) noexcept {
   ssid = std::max(box.size.width, box.size.height);
 
-  cv::Mat points;
-  cv::boxPoints(box, points);
-
-  auto array = Mat2Vector(points);
+  MiniBox array;
+  box.points(array.data());
   std::sort(array.begin(), array.end(), XsortFp32);
 
-  std::vector<float> idx1 = array[0], idx2 = array[1], idx3 = array[2],
-                     idx4 = array[3];
-  if (array[3][1] <= array[2][1]) {
+  cv::Point2f idx1 = array[0], idx2 = array[1], idx3 = array[2],
+              idx4 = array[3];
+  if (array[3].y <= array[2].y) {
     idx2 = array[3];
     idx3 = array[2];
   } else {
     idx2 = array[2];
     idx3 = array[3];
   }
-  if (array[1][1] <= array[0][1]) {
+  if (array[1].y <= array[0].y) {
     idx1 = array[1];
     idx4 = array[0];
   } else {
@@ -159,12 +141,7 @@ DBPostProcessor::GetMiniBoxes(const cv::RotatedRect &box,
     idx4 = array[1];
   }
 
-  array[0] = idx1;
-  array[1] = idx2;
-  array[2] = idx3;
-  array[3] = idx4;
-
-  return array;
+  return {idx1, idx2, idx3, idx4};
 }
 
 float DBPostProcessor::PolygonScoreAcc(const std::vector<cv::Point> &contour,
@@ -204,24 +181,21 @@ float DBPostProcessor::PolygonScoreAcc(const std::vector<cv::Point> &contour,
 
   cv::fillPoly(mask, ppt, npt, 1, cv::Scalar(1));
 
-  cv::Mat croppedImg;
-  pred(cv::Rect(xmin, ymin, xmax - xmin + 1, ymax - ymin + 1))
-      .copyTo(croppedImg);
-  float score = cv::mean(croppedImg, mask)[0];
+  float score = cv::mean(
+      pred(cv::Rect(xmin, ymin, xmax - xmin + 1, ymax - ymin + 1)), mask)[0];
 
   delete[] rook_point;
   return score;
 }
 
-float DBPostProcessor::BoxScoreFast(
-    const std::vector<std::vector<float>> &box_array,
-    const cv::Mat &pred) noexcept {
+float DBPostProcessor::BoxScoreFast(const MiniBox &box_array,
+                                    const cv::Mat &pred) noexcept {
   const auto &array = box_array;
   int width = pred.cols;
   int height = pred.rows;
 
-  float box_x[4] = {array[0][0], array[1][0], array[2][0], array[3][0]};
-  float box_y[4] = {array[0][1], array[1][1], array[2][1], array[3][1]};
+  float box_x[4] = {array[0].x, array[1].x, array[2].x, array[3].x};
+  float box_y[4] = {array[0].y, array[1].y, array[2].y, array[3].y};
 
   int xmin = clamp(int(std::floor(*(std::min_element(box_x, box_x + 4)))), 0,
                    width - 1);
@@ -236,23 +210,21 @@ float DBPostProcessor::BoxScoreFast(
   mask = cv::Mat::zeros(ymax - ymin + 1, xmax - xmin + 1, CV_8UC1);
 
   cv::Point root_point[4];
-  root_point[0] = cv::Point(int(array[0][0]) - xmin, int(array[0][1]) - ymin);
-  root_point[1] = cv::Point(int(array[1][0]) - xmin, int(array[1][1]) - ymin);
-  root_point[2] = cv::Point(int(array[2][0]) - xmin, int(array[2][1]) - ymin);
-  root_point[3] = cv::Point(int(array[3][0]) - xmin, int(array[3][1]) - ymin);
+  for (int i = 0; i < 4; ++i) {
+    root_point[i] = cv::Point(int(array[i].x) - xmin, int(array[i].y) - ymin);
+  }
   const cv::Point *ppt[1] = {root_point};
   int npt[] = {4};
   cv::fillPoly(mask, ppt, npt, 1, cv::Scalar(1));
 
-  cv::Mat croppedImg;
-  pred(cv::Rect(xmin, ymin, xmax - xmin + 1, ymax - ymin + 1))
-      .copyTo(croppedImg);
-
-  auto score = cv::mean(croppedImg, mask)[0];
+  // score straight on the ROI view of the probability map
+  auto score =
+      cv::mean(pred(cv::Rect(xmin, ymin, xmax - xmin + 1, ymax - ymin + 1)),
+               mask)[0];
   return score;
 }
 
-std::vector<std::vector<std::vector<int>>> DBPostProcessor::BoxesFromBitmap(
+std::vector<Quad> DBPostProcessor::BoxesFromBitmap(
     const cv::Mat &pred, const cv::Mat &bitmap, const float &box_thresh,
     const float &det_db_unclip_ratio,
     const std::string &det_db_score_mode) noexcept {
@@ -271,7 +243,8 @@ std::vector<std::vector<std::vector<int>>> DBPostProcessor::BoxesFromBitmap(
   int num_contours =
       contours.size() >= max_candidates ? max_candidates : contours.size();
 
-  std::vector<std::vector<std::vector<int>>> boxes;
+  std::vector<Quad> boxes;
+  boxes.reserve(num_contours);
 
   for (int _i = 0; _i < num_contours; ++_i) {
     if (contours[_i].size() <= 2) {
@@ -279,10 +252,7 @@ std::vector<std::vector<std::vector<int>>> DBPostProcessor::BoxesFromBitmap(
     }
     float ssid;
     cv::RotatedRect box = cv::minAreaRect(contours[_i]);
-    auto array = GetMiniBoxes(box, ssid);
-
-    auto box_for_unclip = array;
-    // end get_mini_box
+    MiniBox array = GetMiniBoxes(box, ssid);
 
     if (ssid < min_size) {
       continue;
@@ -299,66 +269,175 @@ std::vector<std::vector<std::vector<int>>> DBPostProcessor::BoxesFromBitmap(
       continue;
 
     // start for unclip
-    cv::RotatedRect points = UnClip(box_for_unclip, det_db_unclip_ratio);
+    cv::RotatedRect points = UnClip(array, det_db_unclip_ratio);
     if (points.size.height < 1.001 && points.size.width < 1.001) {
       continue;
     }
     // end for unclip
 
-    cv::RotatedRect clipbox = points;
-    auto cliparray = GetMiniBoxes(clipbox, ssid);
+    MiniBox cliparray = GetMiniBoxes(points, ssid);
 
     if (ssid < min_size + 2)
       continue;
 
     int dest_width = pred.cols;
     int dest_height = pred.rows;
-    std::vector<std::vector<int>> intcliparray;
+    Quad intcliparray;
 
     for (int num_pt = 0; num_pt < 4; ++num_pt) {
-      std::vector<int> a{int(clampf(roundf(cliparray[num_pt][0] / float(width) *
-                                           float(dest_width)),
-                                    0, float(dest_width))),
-                         int(clampf(roundf(cliparray[num_pt][1] /
-                                           float(height) * float(dest_height)),
-                                    0, float(dest_height)))};
-      intcliparray.emplace_back(std::move(a));
+      intcliparray[num_pt] = cv::Point(
+          int(clampf(roundf(cliparray[num_pt].x / float(width) *
+                            float(dest_width)),
+                     0, float(dest_width))),
+          int(clampf(roundf(cliparray[num_pt].y / float(height) *
+                            float(dest_height)),
+                     0, float(dest_height))));
     }
-    boxes.emplace_back(std::move(intcliparray));
+    boxes.push_back(intcliparray);
 
   } // end for
   return boxes;
 }
 
-void DBPostProcessor::FilterTagDetRes(
-    std::vector<std::vector<std::vector<int>>> &boxes, float ratio_h,
-    float ratio_w, const cv::Mat &srcimg) noexcept {
+void DBPostProcessor::FilterTagDetRes(std::vector<Quad> &boxes, float ratio_h,
+                                      float ratio_w,
+                                      const cv::Mat &srcimg) noexcept {
   int oriimg_h = srcimg.rows;
   int oriimg_w = srcimg.cols;
 
-  std::vector<std::vector<std::vector<int>>> root_points;
+  // order, rescale and drop tiny boxes in place
+  size_t kept = 0;
   for (size_t n = 0; n < boxes.size(); ++n) {
-    boxes[n] = OrderPointsClockwise(boxes[n]);
-    for (size_t m = 0; m < boxes[0].size(); ++m) {
-      boxes[n][m][0] /= ratio_w;
-      boxes[n][m][1] /= ratio_h;
-
-      boxes[n][m][0] = int(_min(_max(boxes[n][m][0], 0), oriimg_w - 1));
-      boxes[n][m][1] = int(_min(_max(boxes[n][m][1], 0), oriimg_h - 1));
+    Quad box = OrderPointsClockwise(boxes[n]);
+    for (cv::Point &pt : box) {
+      // same float divide + truncation as the former int /= float
+      pt.x = int(pt.x / ratio_w);
+      pt.y = int(pt.y / ratio_h);
+
+      pt.x = _min(_max(pt.x, 0), oriimg_w - 1);
+      pt.y = _min(_max(pt.y, 0), oriimg_h - 1);
     }
-  }
 
-  for (size_t n = 0; n < boxes.size(); ++n) {
     int rect_width, rect_height;
-    rect_width = int(sqrt(pow(boxes[n][0][0] - boxes[n][1][0], 2) +
-                          pow(boxes[n][0][1] - boxes[n][1][1], 2)));
-    rect_height = int(sqrt(pow(boxes[n][0][0] - boxes[n][3][0], 2) +
-                           pow(boxes[n][0][1] - boxes[n][3][1], 2)));
+    rect_width = int(sqrt(pow(box[0].x - box[1].x, 2) +
+                          pow(box[0].y - box[1].y, 2)));
+    rect_height = int(sqrt(pow(box[0].x - box[3].x, 2) +
+                           pow(box[0].y - box[3].y, 2)));
     if (rect_width <= 4 || rect_height <= 4)
       continue;
-    root_points.emplace_back(boxes[n]);
+    boxes[kept++] = box;
+  }
+  boxes.resize(kept);
+}
+
+void CTCGreedyDecoder::init(
+    const std::vector<std::string> &label_list) noexcept {
+  this->label_bytes_.clear();
+  this->label_offsets_.clear();
+  this->max_label_len_ = 0;
+  this->label_offsets_.reserve(label_list.size() + 1);
+  for (const auto &label : label_list) {
+    this->label_offsets_.push_back(uint32_t(this->label_bytes_.size()));
+    this->label_bytes_ += label;
+    this->max_label_len_ = std::max(this->max_label_len_, label.size());
+  }
+  this->label_offsets_.push_back(uint32_t(this->label_bytes_.size()));
+}
+
+int CTCGreedyDecoder::ArgMax(const float *row, int n,
+                             float &max_value) noexcept {
+  if (n <= 0) {
+    max_value = 0.f;
+    return 0;
+  }
+  int i = 0;
+  int best_idx = 0;
+  float best = row[0];
+#ifdef PADDLE_OCR_CTC_SSE2
+  if (n >= 8) {
+    // per-lane running max and index; strict greater keeps the first index
+    __m128 vmax = _mm_loadu_ps(row);
+    __m128i vidx = _mm_setr_epi32(0, 1, 2, 3);
+    __m128i vcur = vidx;
+    const __m128i four = _mm_set1_epi32(4);
+    for (i = 4; i + 4 <= n; i += 4) {
+      vcur = _mm_add_epi32(vcur, four);
+      __m128 v = _mm_loadu_ps(row + i);
+      __m128 gt = _mm_cmpgt_ps(v, vmax);
+      __m128i gti = _mm_castps_si128(gt);
+      vmax = _mm_or_ps(_mm_and_ps(gt, v), _mm_andnot_ps(gt, vmax));
+      vidx = _mm_or_si128(_mm_and_si128(gti, vcur),
+                          _mm_andnot_si128(gti, vidx));
+    }
+    alignas(16) float lane_max[4];
+    alignas(16) int lane_idx[4];
+    _mm_store_ps(lane_max, vmax);
+    _mm_store_si128(reinterpret_cast<__m128i *>(lane_idx), vidx);
+    best = lane_max[0];
+    best_idx = lane_idx[0];
+    for (int k = 1; k < 4; ++k) {
+      if (lane_max[k] > best ||
+          (lane_max[k] == best && lane_idx[k] < best_idx)) {
+        best = lane_max[k];
+        best_idx = lane_idx[k];
+      }
+    }
+  }
+#endif
+  for (; i < n; ++i) {
+    if (row[i] > best) {
+      best = row[i];
+      best_idx = i;
+    }
+  }
+  max_value = best;
+  return best_idx;
+}
+
+bool CTCGreedyDecoder::Run(const float *probs, int time_steps,
+                           int num_classes, std::string &text, float &score,
+                           std::vector<float> *char_scores,
+                           std::vector<int> *char_positions) const noexcept {
+  text.clear();
+  text.reserve(size_t(time_steps) * this->max_label_len_);
+  if (char_scores) {
+    char_scores->clear();
+  }
+  if (char_positions) {
+    char_positions->clear();
+  }
+
+  int last_index = 0;
+  float score_sum = 0.f;
+  int count = 0;
+  int num_labels = int(this->label_offsets_.size()) - 1;
+  for (int n = 0; n < time_steps; ++n) {
+    float max_value;
+    int argmax_idx =
+        ArgMax(probs + size_t(n) * num_classes, num_classes, max_value);
+    if (argmax_idx > 0 && !(n > 0 && argmax_idx == last_index)) {
+      score_sum += max_value;
+      count += 1;
+      if (argmax_idx < num_labels) {
+        text.append(this->label_bytes_,
+                    this->label_offsets_[argmax_idx],
+                    this->label_offsets_[argmax_idx + 1] -
+                        this->label_offsets_[argmax_idx]);
+      }
+      if (char_scores) {
+        char_scores->push_back(max_value);
+      }
+      if (char_positions) {
+        char_positions->push_back(n);
+      }
+    }
+    last_index = argmax_idx;
+  }
+  if (count == 0) {
+    return false;
   }
-  boxes = std::move(root_points);
+  score = score_sum / count;
+  return !std::isnan(score);
 }
 
 void TablePostProcessor::init(const std::string &label_path,
@@ -14,6 +14,10 @@
 
 #include <paddle_ocr/preprocess_op.h>
 
+#include <algorithm>
+#include <cmath>
+#include <opencv2/core/utility.hpp>
+
 namespace PaddleOCR {
 
 void Permute::Run(const cv::Mat &im, float *data) noexcept {
@@ -54,12 +58,114 @@ void Normalize::Run(cv::Mat &im, const std::vector<float> &mean,
   cv::merge(bgr_channels, im);
 }
 
+void NormalizePermute::Run(const cv::Mat &im, const std::vector<float> &mean,
+                            const std::vector<float> &scale,
+                            const bool is_scale, float *data,
+                            int dst_w) noexcept {
+  int rh = im.rows;
+  int rw = std::min(im.cols, dst_w);
+  int rc = im.channels();
+  float e = is_scale ? 1.0f / 255.0f : 1.0f;
+
+  // 8-bit input: one lookup table per channel replaces convert/split/merge
+  if (this->lut_.size() != size_t(rc) * 256 || this->lut_mean_ != mean ||
+      this->lut_scale_ != scale || this->lut_is_scale_ != is_scale) {
+    this->lut_.resize(size_t(rc) * 256);
+    for (int c = 0; c < rc; ++c) {
+      for (int v = 0; v < 256; ++v) {
+        this->lut_[c * 256 + v] = (v * e - mean[c]) * scale[c];
+      }
+    }
+    this->lut_mean_ = mean;
+    this->lut_scale_ = scale;
+    this->lut_is_scale_ = is_scale;
+  }
+
+  for (int c = 0; c < rc; ++c) {
+    const float *table = &this->lut_[c * 256];
+    float *plane = data + c * rh * dst_w;
+    for (int y = 0; y < rh; ++y) {
+      const uchar *src = im.ptr<uchar>(y) + c;
+      float *dst = plane + y * dst_w;
+      for (int x = 0; x < rw; ++x) {
+        dst[x] = table[src[x * rc]];
+      }
+      std::fill(dst + rw, dst + dst_w, table[0]);
+    }
+  }
+}
+
+void RecPerspectiveCrop::Run(const cv::Mat &srcimage,
+                             const std::vector<Quad> &boxes, int target_h,
+                             std::vector<cv::Mat> &crops) noexcept {
+  crops.assign(boxes.size(), cv::Mat());
+  const cv::Rect image_rect(0, 0, srcimage.cols, srcimage.rows);
+
+  cv::parallel_for_(cv::Range(0, int(boxes.size())), [&](const cv::Range &r) {
+    for (int i = r.start; i < r.end; ++i) {
+      const Quad &box = boxes[i];
+      cv::Point2f pts[4];
+      for (int k = 0; k < 4; ++k) {
+        pts[k] = cv::Point2f(float(box[k].x), float(box[k].y));
+      }
+
+      float crop_w = float(cv::norm(pts[0] - pts[1]));
+      float crop_h = float(cv::norm(pts[0] - pts[3]));
+      if (crop_w < 1.f || crop_h < 1.f) {
+        continue;
+      }
+      // vertical text: start from the top-right corner so the warp itself
+      // does the transpose + flip of GetRotateCropImage
+      if (crop_h >= crop_w * 1.5f) {
+        cv::Point2f rotated[4] = {pts[1], pts[2], pts[3], pts[0]};
+        std::copy(rotated, rotated + 4, pts);
+        std::swap(crop_w, crop_h);
+      }
+
+      int out_h = target_h > 0 ? target_h : int(crop_h);
+      int out_w = target_h > 0
+                      ? std::max(1, int(std::round(crop_w * target_h / crop_h)))
+                      : int(crop_w);
+      if (out_h <= 0 || out_w <= 0) {
+        continue;
+      }
+
+      cv::Rect roi = cv::boundingRect(std::vector<cv::Point2f>(pts, pts + 4));
+      roi &= image_rect;
+      if (roi.width <= 0 || roi.height <= 0) {
+        continue;
+      }
+      for (auto &pt : pts) {
+        pt.x -= roi.x;
+        pt.y -= roi.y;
+      }
+
+      const cv::Point2f pts_std[4] = {{0.f, 0.f},
+                                      {float(out_w), 0.f},
+                                      {float(out_w), float(out_h)},
+                                      {0.f, float(out_h)}};
+      cv::Mat M = cv::getPerspectiveTransform(pts, pts_std);
+      cv::warpPerspective(srcimage(roi), crops[i], M, cv::Size(out_w, out_h),
+                          cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+    }
+  });
+}
+
 void ResizeImgType0::Run(const cv::Mat &img, cv::Mat &resize_img,
                          const std::string &limit_type, int limit_side_len,
                          float &ratio_h, float &ratio_w,
                          bool use_tensorrt) noexcept {
-  int w = img.cols;
-  int h = img.rows;
+  cv::Size target = TargetSize(img.size(), limit_type, limit_side_len);
+  cv::resize(img, resize_img, target);
+  ratio_h = float(target.height) / float(img.rows);
+  ratio_w = float(target.width) / float(img.cols);
+}
+
+cv::Size ResizeImgType0::TargetSize(const cv::Size &size,
+                                    const std::string &limit_type,
+                                    int limit_side_len) noexcept {
+  int w = size.width;
+  int h = size.height;
   float ratio = 1.f;
   if (limit_type == "min") {
     int min_wh = std::min(h, w);
@@ -86,10 +192,7 @@ void ResizeImgType0::Run(const cv::Mat &img, cv::Mat &resize_img,
 
   resize_h = std::max(int(round(float(resize_h) / 32) * 32), 32);
   resize_w = std::max(int(round(float(resize_w) / 32) * 32), 32);
-
-  cv::resize(img, resize_img, cv::Size(resize_w, resize_h));
-  ratio_h = float(resize_h) / float(h);
-  ratio_w = float(resize_w) / float(w);
+  return cv::Size(resize_w, resize_h);
 }
 
 void CrnnResizeImg::Run(const cv::Mat &img, cv::Mat &resize_img, float wh_ratio,
@@ -0,0 +1,93 @@
+#include "paddle_ocr/rec_batch_planner.h"
+#include <algorithm>
+#include <limits>
+
+namespace PaddleOCR {
+
+std::atomic<long long> RecBatchPlanner::total_batches_{0};
+std::atomic<long long> RecBatchPlanner::total_images_{0};
+std::atomic<long long> RecBatchPlanner::useful_columns_{0};
+std::atomic<long long> RecBatchPlanner::padded_columns_{0};
+std::atomic<long long> RecBatchPlanner::fixed_chunk_columns_{0};
+
+int RecBatchPlanner::bucketWidth(int width, int min_width, int width_bucket) {
+    int bucketed = width;
+    if (width_bucket > 1) {
+        bucketed = (width + width_bucket - 1) / width_bucket * width_bucket;
+    }
+    return std::max(bucketed, min_width);
+}
+
+std::vector<RecBatch> RecBatchPlanner::plan(const std::vector<int>& sorted_widths, int min_width,
+                                            const RecBatchPlannerConfig& config) {
+    size_t n = sorted_widths.size();
+    std::vector<RecBatch> batches;
+    if (n == 0) {
+        return batches;
+    }
+    size_t max_batch = static_cast<size_t>(std::max(1, config.max_batch));
+
+    // cost[j]: 前 j 张图的最小代价；宽度升序，批 [i, j) 的宽度由 j-1 决定
+    const long long inf = std::numeric_limits<long long>::max();
+    std::vector<long long> cost(n + 1, inf);
+    std::vector<size_t> split(n + 1, 0);
+    cost[0] = 0;
+    for (size_t j = 1; j <= n; ++j) {
+        int width = bucketWidth(sorted_widths[j - 1], min_width, config.width_bucket);
+        // 超过宽度上限的图像只能单独成批
+        size_t limit = width > config.max_batch_width ? 1 : std::min(max_batch, j);
+        for (size_t count = 1; count <= limit; ++count) {
+            size_t i = j - count;
+            long long candidate = cost[i] + static_cast<long long>(count) * width + config.batch_overhead;
+            if (candidate < cost[j]) {
+                cost[j] = candidate;
+                split[j] = i;
+            }
+        }
+    }
+
+    for (size_t j = n; j > 0; j = split[j]) {
+        size_t i = split[j];
+        batches.push_back({i, j, bucketWidth(sorted_widths[j - 1], min_width, config.width_bucket)});
+    }
+    std::reverse(batches.begin(), batches.end());
+    return batches;
+}
+
+void RecBatchPlanner::record(const std::vector<int>& sorted_widths, const std::vector<RecBatch>& batches,
+                             int min_width, const RecBatchPlannerConfig& config) {
+    long long useful = 0;
+    long long padded = 0;
+    for (const auto& batch : batches) {
+        for (size_t k = batch.begin; k < batch.end; ++k) {
+            useful += std::min(sorted_widths[k], batch.width);
+        }
+        padded += static_cast<long long>(batch.end - batch.begin) * batch.width;
+    }
+
+    // 对照：旧的固定 max_batch 切分，每批填充到批内最宽图像
+    long long fixed = 0;
+    size_t max_batch = static_cast<size_t>(std::max(1, config.max_batch));
+    for (size_t begin = 0; begin < sorted_widths.size(); begin += max_batch) {
+        size_t end = std::min(sorted_widths.size(), begin + max_batch);
+        fixed += static_cast<long long>(end - begin) * std::max(min_width, sorted_widths[end - 1]);
+    }
+
+    total_batches_.fetch_add(static_cast<long long>(batches.size()));
+    total_images_.fetch_add(static_cast<long long>(sorted_widths.size()));
+    useful_columns_.fetch_add(useful);
+    padded_columns_.fetch_add(padded);
+    fixed_chunk_columns_.fetch_add(fixed);
+}
+
+RecBatchStatsSnapshot RecBatchPlanner::stats() {
+    RecBatchStatsSnapshot snapshot;
+    snapshot.batches = total_batches_.load();
+    snapshot.images = total_images_.load();
+    snapshot.useful_columns = useful_columns_.load();
+    snapshot.padded_columns = padded_columns_.load();
+    snapshot.fixed_chunk_columns = fixed_chunk_columns_.load();
+    return snapshot;
+}
+
+} // namespace PaddleOCR
@@ -0,0 +1,232 @@
+#include "paddle_ocr/rec_cache.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace PaddleOCR {
+
+namespace {
+
+constexpr int kMinThumbWidth = 4;
+constexpr int kMaxThumbWidth = 512;
+constexpr int kOutlierDiff = 128;  // 缩略图像素差超过一半灰度记为差异像素
+constexpr int kCharWindow = RecognitionCache::kThumbHeight / 2;  // 约一个窄字符的缩略图列数
+constexpr float kAspectTolerance = 1.0f;  // 宽高比之差折合的缩略图列数上限
+
+/**
+ * @brief 墨迹投影计数不少于该值的行/列才计入外接框，忽略零星噪点
+ */
+constexpr int kMinInkPerLine = 2;
+
+} // namespace
+
+RecognitionCache& RecognitionCache::instance() {
+    static RecognitionCache* cache = new RecognitionCache();
+    return *cache;
+}
+
+void RecognitionCache::configure(const RecCacheConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!config.enabled) {
+        return;
+    }
+    config_ = config;
+    enabled_ = true;
+    while (bytes_ > config_.max_bytes && !lru_.empty()) {
+        ++stats_.evictions;
+        eraseLocked(std::prev(lru_.end()));
+    }
+}
+
+bool RecognitionCache::enabled() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return enabled_;
+}
+
+RecognitionCache::Fingerprint RecognitionCache::fingerprint(const cv::Mat& crop) {
+    Fingerprint result;
+    if (crop.empty()) {
+        return result;
+    }
+
+    cv::Mat gray;
+    if (crop.channels() == 3) {
+        cv::cvtColor(crop, gray, cv::COLOR_BGR2GRAY);
+    } else {
+        gray = crop;
+    }
+
+    // 墨迹取少数类，深色字浅色底和浅色字深色底得到相同的二值图
+    cv::Mat ink;
+    cv::threshold(gray, ink, 0, 255, cv::THRESH_BINARY_INV | cv::THRESH_OTSU);
+    if (cv::countNonZero(ink) * 2 > static_cast<int>(ink.total())) {
+        cv::bitwise_not(ink, ink);
+    }
+
+    cv::Mat col_sum, row_sum;
+    cv::reduce(ink, col_sum, 0, cv::REDUCE_SUM, CV_32S);
+    cv::reduce(ink, row_sum, 1, cv::REDUCE_SUM, CV_32S);
+    auto bounds = [](const cv::Mat& sums, int& first, int& last) {
+        const int* p = sums.ptr<int>();
+        int n = static_cast<int>(sums.total());
+        first = 0;
+        last = n - 1;
+        while (first < n && p[first] < kMinInkPerLine * 255) ++first;
+        while (last > first && p[last] < kMinInkPerLine * 255) --last;
+        return first < n;
+    };
+    int x0, x1, y0, y1;
+    if (!bounds(col_sum, x0, x1) || !bounds(row_sum, y0, y1)) {
+        return result;
+    }
+
+    cv::Rect box(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+    int width = static_cast<int>(std::lround(double(kThumbHeight) * box.width / box.height / 4.0)) * 4;
+    if (width > kMaxThumbWidth) {
+        return result;  // 压缩后单个字符只剩几列，差异会被淹没
+    }
+    width = std::max(width, kMinThumbWidth);
+
+    cv::Mat thumb;
+    cv::resize(ink(box), thumb, cv::Size(width, kThumbHeight), 0, 0, cv::INTER_AREA);
+    result.width = width;
+    result.aspect = static_cast<float>(box.width) / box.height;
+    result.thumb.assign(thumb.data, thumb.data + thumb.total());
+    return result;
+}
+
+bool RecognitionCache::matchLocked(const Entry& entry, const Fingerprint& fingerprint) const {
+    if (std::abs(entry.fingerprint.aspect - fingerprint.aspect) * kThumbHeight > kAspectTolerance) {
+        return false;
+    }
+
+    // 按列统计差异像素，一个字符宽的滑动窗口内不超过 max_outliers，总数按字符格 (kThumbHeight 见方) 数放大
+    const int width = fingerprint.width;
+    const uchar* a = entry.fingerprint.thumb.data();
+    const uchar* b = fingerprint.thumb.data();
+    std::vector<int> column_outliers(width, 0);
+    int total = 0;
+    const int max_total = config_.max_outliers * std::max(1, width / kThumbHeight);
+    for (int y = 0; y < kThumbHeight; ++y) {
+        for (int x = 0; x < width; ++x) {
+            size_t i = static_cast<size_t>(y) * width + x;
+            if (std::abs(int(a[i]) - int(b[i])) > kOutlierDiff) {
+                ++column_outliers[x];
+                if (++total > max_total) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    int window = 0;
+    for (int x = 0; x < width; ++x) {
+        window += column_outliers[x];
+        if (x >= kCharWindow) {
+            window -= column_outliers[x - kCharWindow];
+        }
+        if (window > config_.max_outliers) {
+            return false;
+        }
+    }
+    return true;
+}
+
+RecognitionCache::EntryIt RecognitionCache::findLocked(const Fingerprint& fingerprint) {
+    auto bucket = buckets_.find(fingerprint.width);
+    if (bucket != buckets_.end()) {
+        for (EntryIt it : bucket->second) {
+            if (matchLocked(*it, fingerprint)) {
+                return it;
+            }
+        }
+    }
+    return lru_.end();
+}
+
+bool RecognitionCache::lookup(const Fingerprint& fingerprint, std::string& text, float& score) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!enabled_ || fingerprint.width == 0) {
+        return false;
+    }
+    ++stats_.lookups;
+    EntryIt it = findLocked(fingerprint);
+    if (it == lru_.end()) {
+        if (buckets_.count(fingerprint.width)) {
+            ++stats_.rejected;
+        }
+        return false;
+    }
+
+    lru_.splice(lru_.begin(), lru_, it);
+    text = it->text;
+    score = it->score;
+    ++stats_.hits;
+    return true;
+}
+
+void RecognitionCache::insert(Fingerprint&& fingerprint, const std::string& text, float score) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!enabled_ || fingerprint.width == 0 || score < config_.min_score || text.empty()) {
+        return;
+    }
+    EntryIt existing = findLocked(fingerprint);
+    if (existing != lru_.end()) {
+        eraseLocked(existing);
+    }
+
+    Entry entry;
+    entry.fingerprint = std::move(fingerprint);
+    entry.text = text;
+    entry.score = score;
+    size_t entry_bytes = entry.bytes();
+    if (entry_bytes > config_.max_bytes) {
+        return;
+    }
+    int width = entry.fingerprint.width;
+    lru_.push_front(std::move(entry));
+    buckets_[width].push_back(lru_.begin());
+    bytes_ += entry_bytes;
+    ++stats_.inserts;
+
+    while (bytes_ > config_.max_bytes && !lru_.empty()) {
+        ++stats_.evictions;
+        eraseLocked(std::prev(lru_.end()));
+    }
+}
+
+void RecognitionCache::eraseLocked(EntryIt it) {
+    auto bucket = buckets_.find(it->fingerprint.width);
+    if (bucket != buckets_.end()) {
+        std::vector<EntryIt>& entries = bucket->second;
+        auto pos = std::find(entries.begin(), entries.end(), it);
+        if (pos != entries.end()) {
+            *pos = entries.back();
+            entries.pop_back();
+        }
+        if (entries.empty()) {
+            buckets_.erase(bucket);
+        }
+    }
+    bytes_ -= it->bytes();
+    lru_.erase(it);
+}
+
+RecCacheStats RecognitionCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    RecCacheStats snapshot = stats_;
+    snapshot.entries = lru_.size();
+    snapshot.bytes = bytes_;
+    return snapshot;
+}
+
+void RecognitionCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    buckets_.clear();
+    bytes_ = 0;
+    stats_ = RecCacheStats();
+}
+
+} // namespace PaddleOCR
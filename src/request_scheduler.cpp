@@ -0,0 +1,461 @@
+#include "paddle_ocr/request_scheduler.h"
+#include "paddle_ocr/ocr_worker.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <sstream>
+
+namespace PaddleOCR {
+
+int SchedulerConfig::findClass(std::string_view name) const {
+    for (size_t i = 0; i < classes.size(); ++i) {
+        if (classes[i].name == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+bool SchedulerConfig::parse(const std::string& spec, SchedulerConfig& config, std::string& error) {
+    std::vector<PriorityClassConfig> classes;
+    std::istringstream items(spec);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        PriorityClassConfig priority_class;
+        std::istringstream parts(item);
+        std::string weight, depth;
+        std::getline(parts, priority_class.name, ':');
+        std::getline(parts, weight, ':');
+        std::getline(parts, depth, ':');
+        try {
+            priority_class.weight = weight.empty() ? 1 : std::stoi(weight);
+            priority_class.max_queue_depth = depth.empty() ? 0 : std::stoi(depth);
+        } catch (const std::exception&) {
+            priority_class.weight = 0;
+        }
+        if (priority_class.name.empty() || priority_class.weight <= 0 || priority_class.max_queue_depth < 0) {
+            error = "Invalid priority class \"" + item + "\", expected name:weight[:max_queue_depth]";
+            return false;
+        }
+        for (const auto& existing : classes) {
+            if (existing.name == priority_class.name) {
+                error = "Duplicate priority class: " + priority_class.name;
+                return false;
+            }
+        }
+        classes.push_back(std::move(priority_class));
+    }
+    if (classes.empty()) {
+        error = "At least one priority class is required";
+        return false;
+    }
+    config.classes = std::move(classes);
+    return true;
+}
+
+CostModel::Features CostModel::featuresOf(const OCRRequest& request, bool observed) const {
+    Features features;
+    if (request.task == OCRTask::RecognizeRegions) {
+        features.boxes = static_cast<double>(request.regions.size());
+        return features;
+    }
+    if (request.task == OCRTask::Recognize && request.layout) {
+        features.boxes = static_cast<double>(request.layout->fields.size());
+        return features;
+    }
+    
+    double area = 0.0;
+    if (request.rois.empty()) {
+        area = static_cast<double>(request.image_data.total());
+    } else {
+        for (const auto& roi : request.rois) {
+            area += static_cast<double>(roi.area());
+        }
+    }
+    features.megapixels = area / 1e6;
+    if (request.task == OCRTask::Recognize) {
+        double density = area_sum_ > 0.0 ? box_sum_ / area_sum_ : 0.0;
+        features.boxes = observed ? static_cast<double>(request.box_count) : features.megapixels * density;
+    }
+    return features;
+}
+
+double CostModel::predict(const OCRRequest& request) const {
+    if (!ready()) {
+        return samples_ > 0 ? mean_ms_ : kDefaultCostMs;
+    }
+    Features features = featuresOf(request, false);
+    double cost = coef_[0] + coef_[1] * features.megapixels + coef_[2] * features.boxes;
+    return std::max(1.0, cost);
+}
+
+/**
+ * @brief 部分主元高斯消元求解 3×3 线性方程组，结果写入 b
+ */
+static bool solve3(double a[3][3], double b[3]) {
+    for (int col = 0; col < 3; ++col) {
+        int pivot = col;
+        for (int row = col + 1; row < 3; ++row) {
+            if (std::abs(a[row][col]) > std::abs(a[pivot][col])) {
+                pivot = row;
+            }
+        }
+        if (std::abs(a[pivot][col]) < 1e-12) {
+            return false;
+        }
+        std::swap(a[col], a[pivot]);
+        std::swap(b[col], b[pivot]);
+        for (int row = col + 1; row < 3; ++row) {
+            double factor = a[row][col] / a[col][col];
+            for (int k = col; k < 3; ++k) {
+                a[row][k] -= factor * a[col][k];
+            }
+            b[row] -= factor * b[col];
+        }
+    }
+    for (int row = 2; row >= 0; --row) {
+        for (int k = row + 1; k < 3; ++k) {
+            b[row] -= a[row][k] * b[k];
+        }
+        b[row] /= a[row][row];
+    }
+    return true;
+}
+
+void CostModel::update(const OCRRequest& request) {
+    if (ready()) {
+        abs_error_ms_ = abs_error_ms_ * 0.9 + std::abs(request.predicted_ms - request.service_ms) * 0.1;
+    }
+    
+    Features features = featuresOf(request, true);
+    if (request.task == OCRTask::Recognize && !request.layout) {
+        box_sum_ = box_sum_ * kDecay + features.boxes;
+        area_sum_ = area_sum_ * kDecay + features.megapixels;
+    }
+    
+    const double x[3] = {1.0, features.megapixels, features.boxes};
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            xtx_[i][j] = xtx_[i][j] * kDecay + x[i] * x[j];
+        }
+        xty_[i] = xty_[i] * kDecay + x[i] * request.service_ms;
+    }
+    mean_ms_ = samples_ > 0 ? mean_ms_ * 0.9 + request.service_ms * 0.1 : request.service_ms;
+    ++samples_;
+    
+    // 岭回归：请求尺寸都相同时某些方向没有信息，加一点正则保证可解
+    double a[3][3];
+    double b[3];
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            a[i][j] = xtx_[i][j] + (i == j ? 1e-2 : 0.0);
+        }
+        b[i] = xty_[i];
+    }
+    if (solve3(a, b)) {
+        std::copy(b, b + 3, coef_);
+    }
+}
+
+CostModelStats CostModel::stats() const {
+    CostModelStats stats;
+    stats.samples = samples_;
+    stats.base_ms = coef_[0];
+    stats.ms_per_megapixel = coef_[1];
+    stats.ms_per_box = coef_[2];
+    stats.boxes_per_megapixel = area_sum_ > 0.0 ? box_sum_ / area_sum_ : 0.0;
+    stats.mean_abs_error_ms = abs_error_ms_;
+    return stats;
+}
+
+void HedgePolicy::record(const OCRRequest& request) {
+    if (request.service_ms <= 0.0 || request.predicted_ms <= 0.0) {
+        return;
+    }
+    double ratio = request.service_ms / request.predicted_ms;
+    if (ratios_.size() < kWindow) {
+        ratios_.push_back(ratio);
+    } else {
+        ratios_[next_] = ratio;
+        next_ = (next_ + 1) % kWindow;
+    }
+    ++samples_;
+    
+    std::vector<double> sorted = ratios_;
+    size_t rank = static_cast<size_t>(config_.percentile / 100.0 * static_cast<double>(sorted.size() - 1));
+    std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(rank), sorted.end());
+    quantile_ = sorted[rank];
+}
+
+double HedgePolicy::thresholdMs(const OCRRequest& request) const {
+    if (!enabled() || samples_ < config_.min_samples) {
+        return -1.0;
+    }
+    return std::max(1.0, request.predicted_ms * quantile_);
+}
+
+// 高位区分检测与识别，两类形状分别计入各自的缓存容量
+static constexpr int kShapeKindShift = 40;
+
+static int shapeKind(int64_t key) {
+    return static_cast<int>(key >> kShapeKindShift);
+}
+
+ShapeAffinity::ShapeAffinity(size_t workers, size_t capacity)
+    : workers_(workers), capacity_(std::max<size_t>(capacity, 1)) {
+}
+
+int64_t ShapeAffinity::detKey(int height, int width) {
+    return (int64_t(1) << kShapeKindShift) | (int64_t(height) << 20) | int64_t(width);
+}
+
+int64_t ShapeAffinity::recKey(int width) {
+    return (int64_t(2) << kShapeKindShift) | int64_t(width);
+}
+
+size_t ShapeAffinity::choose(int64_t shape_key, const std::vector<size_t>& idle) const {
+    size_t best = 0;
+    uint64_t best_stamp = 0;
+    if (shape_key == 0) {
+        return best;
+    }
+    for (size_t i = 0; i < idle.size(); ++i) {
+        for (const Entry& entry : workers_[idle[i]].recent) {
+            if (entry.key == shape_key && entry.stamp > best_stamp) {
+                best = i;
+                best_stamp = entry.stamp;
+            }
+        }
+    }
+    return best;
+}
+
+void ShapeAffinity::record(size_t worker, int64_t shape_key) {
+    if (shape_key == 0) {
+        return;
+    }
+    WorkerState& state = workers_[worker];
+    ++state.requests;
+    auto it = std::find_if(state.recent.begin(), state.recent.end(),
+                           [&](const Entry& entry) { return entry.key == shape_key; });
+    if (it != state.recent.end()) {
+        ++state.hits;
+        it->stamp = ++clock_;
+        return;
+    }
+    
+    // 同类形状已满时淘汰最久未用的
+    int kind = shapeKind(shape_key);
+    size_t same_kind = 0;
+    auto oldest = state.recent.end();
+    for (auto entry = state.recent.begin(); entry != state.recent.end(); ++entry) {
+        if (shapeKind(entry->key) == kind) {
+            ++same_kind;
+            if (oldest == state.recent.end() || entry->stamp < oldest->stamp) {
+                oldest = entry;
+            }
+        }
+    }
+    if (same_kind >= capacity_) {
+        state.recent.erase(oldest);
+    }
+    state.recent.push_back({shape_key, ++clock_});
+}
+
+std::vector<WorkerShapeStats> ShapeAffinity::stats() const {
+    std::vector<WorkerShapeStats> result;
+    result.reserve(workers_.size());
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        WorkerShapeStats stats;
+        stats.worker_id = static_cast<int>(i);
+        stats.requests = workers_[i].requests;
+        stats.hits = workers_[i].hits;
+        stats.hit_rate = stats.requests > 0 ? double(stats.hits) / double(stats.requests) : 0.0;
+        result.push_back(stats);
+    }
+    return result;
+}
+
+RequestScheduler::RequestScheduler(const SchedulerConfig& config, int default_queue_depth)
+    : shortest_job_first_(config.shortest_job_first), aging_(config.shortest_job_first ? config.aging : 0.0) {
+    classes_.resize(config.classes.size());
+    for (size_t i = 0; i < classes_.size(); ++i) {
+        classes_[i].config = config.classes[i];
+        if (classes_[i].config.max_queue_depth == 0) {
+            classes_[i].config.max_queue_depth = default_queue_depth;
+        }
+    }
+}
+
+RequestScheduler::ClassState& RequestScheduler::classAt(int priority_class) {
+    size_t index = static_cast<size_t>(priority_class);
+    return classes_[index < classes_.size() ? index : 0];
+}
+
+const RequestScheduler::ClassState& RequestScheduler::classAt(int priority_class) const {
+    size_t index = static_cast<size_t>(priority_class);
+    return classes_[index < classes_.size() ? index : 0];
+}
+
+bool RequestScheduler::full(int priority_class) const {
+    const ClassState& state = classAt(priority_class);
+    return state.config.max_queue_depth > 0 && state.queued >= static_cast<size_t>(state.config.max_queue_depth);
+}
+
+size_t RequestScheduler::queuedAhead(int priority_class) const {
+    const ClassState& own = classAt(priority_class);
+    size_t ahead = own.queued;
+    for (const ClassState& other : classes_) {
+        if (&other == &own) {
+            continue;
+        }
+        // 新请求轮到之前，其他类别按权重比例大约分派这么多
+        size_t share = (own.queued + 1) * static_cast<size_t>(other.config.weight) / static_cast<size_t>(own.config.weight);
+        ahead += std::min(other.queued, share);
+    }
+    return ahead;
+}
+
+double RequestScheduler::costOf(const OCRRequest& request) const {
+    return shortest_job_first_ ? request.predicted_ms : 1.0;
+}
+
+double RequestScheduler::agedCost(const OCRRequest& request, std::chrono::steady_clock::time_point now) const {
+    double waited_ms = std::chrono::duration<double, std::milli>(now - request.submit_time).count();
+    return costOf(request) - aging_ * waited_ms;
+}
+
+void RequestScheduler::push(std::shared_ptr<OCRRequest> request) {
+    request->predicted_ms = cost_model_.predict(*request);
+    ClassState& state = classAt(request->priority_class);
+    if (state.queued == 0) {
+        state.vtime = std::max(state.vtime, virtual_time_);
+    }
+    auto inserted = state.flows.try_emplace(request->client_id);
+    Flow& flow = inserted.first->second;
+    if (flow.queue.empty()) {
+        flow.vtime = std::max(flow.vtime, state.flow_vtime);
+    }
+    flow.queue.push_back(std::move(request));
+    ++state.queued;
+    ++queued_;
+}
+
+std::shared_ptr<OCRRequest> RequestScheduler::pop() {
+    ClassState* state = nullptr;
+    for (ClassState& candidate : classes_) {
+        if (candidate.queued > 0 && (!state || candidate.vtime < state->vtime)) {
+            state = &candidate;
+        }
+    }
+    if (!state) {
+        return nullptr;
+    }
+
+    // 每个客户端先选出自己代价最小的请求 (代价相同时先提交的在前)，再比较 虚拟时间 + 代价
+    auto now = std::chrono::steady_clock::now();
+    auto flow_it = state->flows.end();
+    size_t pick = 0;
+    double best_score = 0.0;
+    for (auto it = state->flows.begin(); it != state->flows.end(); ++it) {
+        const auto& queue = it->second.queue;
+        if (queue.empty()) {
+            continue;
+        }
+        size_t head = 0;
+        double head_cost = agedCost(*queue[0], now);
+        for (size_t i = 1; i < queue.size(); ++i) {
+            double cost = agedCost(*queue[i], now);
+            if (cost < head_cost) {
+                head = i;
+                head_cost = cost;
+            }
+        }
+        double score = it->second.vtime + head_cost;
+        if (flow_it == state->flows.end() || score < best_score) {
+            flow_it = it;
+            pick = head;
+            best_score = score;
+        }
+    }
+    Flow& flow = flow_it->second;
+    std::shared_ptr<OCRRequest> request = std::move(flow.queue[pick]);
+    flow.queue.erase(flow.queue.begin() + static_cast<std::ptrdiff_t>(pick));
+
+    // 虚拟时间按未扣除等待的代价推进，公平份额不受老化影响
+    double cost = costOf(*request);
+    virtual_time_ = state->vtime;
+    state->flow_vtime = flow.vtime;
+    state->vtime += cost / state->config.weight;
+    flow.vtime += cost;
+    if (flow.queue.empty()) {
+        state->flows.erase(flow_it);
+    }
+    --state->queued;
+    --queued_;
+    ++state->dispatched;
+    return request;
+}
+
+void RequestScheduler::removeCancelled(std::vector<std::shared_ptr<OCRRequest>>& removed) {
+    for (ClassState& state : classes_) {
+        for (auto it = state.flows.begin(); it != state.flows.end();) {
+            auto& queue = it->second.queue;
+            auto kept_end = std::stable_partition(queue.begin(), queue.end(),
+                [](const std::shared_ptr<OCRRequest>& request) {
+                    return !request->cancel_token || !request->cancel_token->isCancelled();
+                });
+            size_t count = static_cast<size_t>(queue.end() - kept_end);
+            std::move(kept_end, queue.end(), std::back_inserter(removed));
+            queue.erase(kept_end, queue.end());
+            state.queued -= count;
+            queued_ -= count;
+            it = queue.empty() ? state.flows.erase(it) : std::next(it);
+        }
+    }
+}
+
+void RequestScheduler::recordRejected(int priority_class) {
+    ++classAt(priority_class).rejected;
+}
+
+void RequestScheduler::recordCompleted(const OCRRequest& request) {
+    ClassState& state = classAt(request.priority_class);
+    double latency_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - request.submit_time).count();
+    if (state.latencies_ms.size() < kLatencyWindow) {
+        state.latencies_ms.push_back(latency_ms);
+    } else {
+        state.latencies_ms[state.latency_next] = latency_ms;
+        state.latency_next = (state.latency_next + 1) % kLatencyWindow;
+    }
+    ++state.completed;
+    if (request.box_count >= 0 && request.service_ms > 0.0) {
+        cost_model_.update(request);
+    }
+}
+
+std::vector<PriorityClassStats> RequestScheduler::stats() const {
+    std::vector<PriorityClassStats> result;
+    result.reserve(classes_.size());
+    for (const ClassState& state : classes_) {
+        PriorityClassStats stats;
+        stats.name = state.config.name;
+        stats.weight = state.config.weight;
+        stats.max_queue_depth = state.config.max_queue_depth;
+        stats.queued = state.queued;
+        stats.dispatched = state.dispatched;
+        stats.rejected = state.rejected;
+        stats.completed = state.completed;
+        if (!state.latencies_ms.empty()) {
+            std::vector<double> sorted = state.latencies_ms;
+            std::sort(sorted.begin(), sorted.end());
+            stats.p50_ms = sorted[(sorted.size() - 1) / 2];
+            stats.p99_ms = sorted[(sorted.size() - 1) * 99 / 100];
+        }
+        result.push_back(std::move(stats));
+    }
+    return result;
+}
+
+} // namespace PaddleOCR
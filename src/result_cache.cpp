@@ -0,0 +1,313 @@
+#include "paddle_ocr/result_cache.h"
+#include <json/json.h>
+#include <cstring>
+#include <iterator>
+#include <memory>
+
+namespace PaddleOCR {
+
+namespace {
+
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+constexpr auto kWaitPollInterval = std::chrono::milliseconds(20);  // 合并的请求检查是否放弃等待的间隔
+
+inline uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t read64(const unsigned char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t read32(const unsigned char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t xxhRound(uint64_t acc, uint64_t input) {
+    acc += input * kPrime2;
+    acc = rotl(acc, 31);
+    return acc * kPrime1;
+}
+
+inline uint64_t mergeRound(uint64_t acc, uint64_t value) {
+    acc ^= xxhRound(0, value);
+    return acc * kPrime1 + kPrime4;
+}
+
+/**
+ * @brief 响应是否为成功结果；字符串中的引号总被转义，该片段不会出现在文本内容里
+ */
+bool isSuccessResponse(const std::string& response) {
+    return response.find("\"success\":true") != std::string::npos;
+}
+
+} // namespace
+
+uint64_t ResultCache::hash64(const void* data, size_t size, uint64_t seed) {
+    // XXH64 (小端)，Base64 图像数据约 10GB/s，远低于一次识别的耗时
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const unsigned char* end = p + size;
+    uint64_t h;
+    if (size >= 32) {
+        uint64_t v1 = seed + kPrime1 + kPrime2;
+        uint64_t v2 = seed + kPrime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - kPrime1;
+        const unsigned char* limit = end - 32;
+        do {
+            v1 = xxhRound(v1, read64(p));
+            v2 = xxhRound(v2, read64(p + 8));
+            v3 = xxhRound(v3, read64(p + 16));
+            v4 = xxhRound(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = mergeRound(h, v1);
+        h = mergeRound(h, v2);
+        h = mergeRound(h, v3);
+        h = mergeRound(h, v4);
+    } else {
+        h = seed + kPrime5;
+    }
+    h += static_cast<uint64_t>(size);
+
+    while (p + 8 <= end) {
+        h ^= xxhRound(0, read64(p));
+        h = rotl(h, 27) * kPrime1 + kPrime4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<uint64_t>(read32(p)) * kPrime1;
+        h = rotl(h, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    while (p < end) {
+        h ^= static_cast<uint64_t>(*p) * kPrime5;
+        h = rotl(h, 11) * kPrime1;
+        ++p;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+ResultCache::ResultCache(const ResultCacheConfig& config, std::function<void()> on_cancel)
+    : config_(config), on_cancel_(std::move(on_cancel)) {}
+
+ResultCache::Key ResultCache::makeKey(std::string_view content, std::string_view variant) {
+    Key key;
+    key.hash = hash64(content.data(), content.size(), hash64(variant.data(), variant.size()));
+    key.size = content.size();
+    return key;
+}
+
+bool ResultCache::waitFor(const std::shared_future<std::string>& result, const std::function<bool()>& abandoned,
+                          const std::function<void()>& give_up, bool keep_waiting) {
+    bool gave_up = false;
+    while (result.wait_for(kWaitPollInterval) != std::future_status::ready) {
+        if (!gave_up && abandoned && abandoned()) {
+            gave_up = true;
+            give_up();
+            if (!keep_waiting) {
+                break;
+            }
+        }
+    }
+    return gave_up;
+}
+
+void ResultCache::leave(const Key& key, const std::shared_ptr<Flight>& flight) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--flight->waiters > 0) {
+            return;
+        }
+        finishLocked(key, flight);
+    }
+    flight->cancel_token->cancel();
+    if (on_cancel_) {
+        on_cancel_();
+    }
+}
+
+void ResultCache::finishLocked(const Key& key, const std::shared_ptr<Flight>& flight) {
+    auto it = in_flight_.find(key);
+    if (it != in_flight_.end() && it->second == flight) {
+        in_flight_.erase(it);
+    }
+}
+
+std::optional<std::string> ResultCache::computeAlone(const Submit& submit, const std::function<bool()>& abandoned) {
+    auto cancel_token = std::make_shared<CancellationToken>();
+    std::shared_future<std::string> result = submit(cancel_token).share();
+    bool gave_up = waitFor(result, abandoned, [&]() {
+        cancel_token->cancel();
+        if (on_cancel_) {
+            on_cancel_();
+        }
+    }, false);
+    if (gave_up) {
+        return std::nullopt;
+    }
+    return result.get();
+}
+
+std::optional<std::string> ResultCache::getOrCompute(const Key& key, const Submit& submit,
+                                                     const std::function<bool()>& abandoned, bool* shared) {
+    if (shared) {
+        *shared = true;
+    }
+    std::promise<std::string> promise;
+    std::shared_ptr<Flight> flight;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            auto entry = it->second;
+            if (config_.ttl_seconds <= 0 || std::chrono::steady_clock::now() < entry->expires_at) {
+                lru_.splice(lru_.begin(), lru_, entry);
+                ++stats_.hits;
+                return entry->value;
+            }
+            ++stats_.expirations;
+            eraseLocked(entry);
+        }
+
+        auto existing = in_flight_.find(key);
+        if (existing != in_flight_.end()) {
+            flight = existing->second;
+            ++flight->waiters;
+            ++stats_.coalesced;
+            lock.unlock();
+            if (waitFor(flight->result, abandoned, [&]() { leave(key, flight); }, false)) {
+                return std::nullopt;
+            }
+            try {
+                std::string value = flight->result.get();
+                if (isSuccessResponse(value)) {
+                    return value;
+                }
+            } catch (...) {
+            }
+            // 失败可能只与首个请求的截止时间、取消等参数有关，按本请求的参数单独计算
+            lock.lock();
+            ++stats_.misses;
+            lock.unlock();
+            if (shared) {
+                *shared = false;
+            }
+            return computeAlone(submit, abandoned);
+        }
+
+        ++stats_.misses;
+        flight = std::make_shared<Flight>();
+        flight->result = promise.get_future().share();
+        in_flight_.emplace(key, flight);
+    }
+    if (shared) {
+        *shared = false;
+    }
+
+    // 本请求负责计算，完成后广播给合并进来的请求；本请求放弃后仍等到计算结束以便广播
+    bool gave_up = false;
+    try {
+        std::shared_future<std::string> result = submit(flight->cancel_token).share();
+        gave_up = waitFor(result, abandoned, [&]() { leave(key, flight); }, true);
+        std::string value = result.get();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (isSuccessResponse(value)) {
+                insertLocked(key, value);
+            }
+            finishLocked(key, flight);
+        }
+        promise.set_value(value);
+        if (gave_up) {
+            return std::nullopt;
+        }
+        return value;
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            finishLocked(key, flight);
+        }
+        promise.set_exception(std::current_exception());
+        if (gave_up) {
+            return std::nullopt;
+        }
+        throw;
+    }
+}
+
+std::string ResultCache::rebind(const std::string& response, int request_id, double processing_time_ms) {
+    // 只在命中时调用，解析一次响应远比一次识别便宜
+    Json::Value value;
+    Json::CharReaderBuilder reader_builder;
+    std::unique_ptr<Json::CharReader> reader(reader_builder.newCharReader());
+    if (!reader->parse(response.data(), response.data() + response.size(), &value, nullptr) || !value.isObject()) {
+        return response;
+    }
+    if (value.isMember("request_id")) {
+        value["request_id"] = request_id;
+    }
+    if (value.isMember("processing_time_ms")) {
+        value["processing_time_ms"] = processing_time_ms;
+    }
+    value["cached"] = true;
+    Json::StreamWriterBuilder writer_builder;
+    writer_builder["indentation"] = "";  // 与 Worker 的响应格式一致
+    writer_builder["emitUTF8"] = true;
+    return Json::writeString(writer_builder, value);
+}
+
+void ResultCache::insertLocked(const Key& key, const std::string& value) {
+    if (config_.max_entries == 0 || value.size() > config_.max_bytes) {
+        return;
+    }
+    auto existing = index_.find(key);
+    if (existing != index_.end()) {
+        eraseLocked(existing->second);
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.value = value;
+    entry.expires_at = std::chrono::steady_clock::now() + std::chrono::seconds(config_.ttl_seconds);
+    lru_.push_front(std::move(entry));
+    index_[key] = lru_.begin();
+    bytes_ += value.size();
+
+    while (!lru_.empty() && (index_.size() > config_.max_entries || bytes_ > config_.max_bytes)) {
+        ++stats_.evictions;
+        eraseLocked(std::prev(lru_.end()));
+    }
+}
+
+void ResultCache::eraseLocked(std::list<Entry>::iterator it) {
+    bytes_ -= it->value.size();
+    index_.erase(it->key);
+    lru_.erase(it);
+}
+
+ResultCacheStats ResultCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ResultCacheStats snapshot = stats_;
+    snapshot.entries = index_.size();
+    snapshot.bytes = bytes_;
+    return snapshot;
+}
+
+} // namespace PaddleOCR
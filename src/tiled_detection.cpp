@@ -0,0 +1,145 @@
+#include "paddle_ocr/tiled_detection.h"
+#include <algorithm>
+
+namespace PaddleOCR {
+
+namespace {
+
+// 沿一个轴切分：分块长度 tile，相邻分块至少重叠 overlap，最后一块贴齐末端
+std::vector<int> splitAxis(int length, int tile, int overlap) {
+    std::vector<int> starts;
+    if (length <= tile) {
+        starts.push_back(0);
+        return starts;
+    }
+    int stride = std::max(1, tile - overlap);
+    int count = (length - tile + stride - 1) / stride + 1;
+    for (int i = 0; i < count; ++i) {
+        starts.push_back(std::min(i * stride, length - tile));
+    }
+    return starts;
+}
+
+cv::Rect boxBounds(const Quad& box) {
+    int left = box[0].x, right = box[0].x;
+    int top = box[0].y, bottom = box[0].y;
+    for (const auto& point : box) {
+        left = std::min(left, point.x);
+        right = std::max(right, point.x);
+        top = std::min(top, point.y);
+        bottom = std::max(bottom, point.y);
+    }
+    return cv::Rect(left, top, right - left + 1, bottom - top + 1);
+}
+
+Quad rectToBox(const cv::Rect& rect) {
+    int right = rect.x + rect.width - 1;
+    int bottom = rect.y + rect.height - 1;
+    return {cv::Point(rect.x, rect.y), cv::Point(right, rect.y), cv::Point(right, bottom), cv::Point(rect.x, bottom)};
+}
+
+struct MergedBox {
+    Quad box;
+    cv::Rect bounds;
+    int tile_index;
+    bool alive;
+};
+
+} // namespace
+
+bool DetTilePlanner::shouldTile(const cv::Size& size, const TiledDetConfig& config, int limit_side_len) {
+    if (!config.enabled || size.width <= 0 || size.height <= 0) {
+        return false;
+    }
+    int long_side = std::max(size.width, size.height);
+    int short_side = std::min(size.width, size.height);
+    // 整图缩放后损失不大的图像不必分块
+    if (long_side <= std::max(limit_side_len, config.tile_side)) {
+        return false;
+    }
+    if (static_cast<float>(long_side) / short_side >= config.min_aspect_ratio) {
+        return true;
+    }
+    return config.min_pixels > 0 &&
+           static_cast<long long>(size.width) * size.height >= config.min_pixels;
+}
+
+std::vector<cv::Rect> DetTilePlanner::planTiles(const cv::Size& size, const TiledDetConfig& config) {
+    int tile_w = std::min(size.width, config.tile_side);
+    int tile_h = std::min(size.height, config.tile_side);
+    std::vector<int> xs = splitAxis(size.width, tile_w, config.overlap);
+    std::vector<int> ys = splitAxis(size.height, tile_h, config.overlap);
+
+    std::vector<cv::Rect> tiles;
+    tiles.reserve(xs.size() * ys.size());
+    for (int y : ys) {
+        for (int x : xs) {
+            tiles.emplace_back(x, y, tile_w, tile_h);
+        }
+    }
+    return tiles;
+}
+
+std::vector<Quad> DetTilePlanner::mergeTileBoxes(
+    const std::vector<std::vector<Quad>>& tile_boxes,
+    const std::vector<cv::Rect>& tiles) {
+    std::vector<MergedBox> candidates;
+    for (size_t t = 0; t < tile_boxes.size() && t < tiles.size(); ++t) {
+        for (const auto& box : tile_boxes[t]) {
+            MergedBox merged;
+            merged.box = box;
+            for (auto& point : merged.box) {
+                point += tiles[t].tl();
+            }
+            merged.bounds = boxBounds(merged.box);
+            merged.tile_index = static_cast<int>(t);
+            merged.alive = true;
+            candidates.push_back(std::move(merged));
+        }
+    }
+
+    // 只比较来自不同分块的框，同一分块内的检测结果保持原样
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (!candidates[i].alive) continue;
+        for (size_t j = i + 1; j < candidates.size(); ++j) {
+            if (!candidates[j].alive || candidates[j].tile_index == candidates[i].tile_index) continue;
+
+            MergedBox& a = candidates[i];
+            MergedBox& b = candidates[j];
+            cv::Rect inter = a.bounds & b.bounds;
+            if (inter.area() <= 0) continue;
+
+            int min_area = std::min(a.bounds.area(), b.bounds.area());
+            if (inter.area() >= 0.6 * min_area) {
+                // 被接缝截断的框大部分落在完整框内，保留较大者
+                if (b.bounds.area() > a.bounds.area()) {
+                    a.box = b.box;
+                    a.bounds = b.bounds;
+                }
+                b.alive = false;
+                continue;
+            }
+
+            int union_top = std::min(a.bounds.y, b.bounds.y);
+            int union_bottom = std::max(a.bounds.br().y, b.bounds.br().y);
+            float vertical_iou = static_cast<float>(inter.height) / (union_bottom - union_top);
+            if (vertical_iou >= 0.7f) {
+                // 同一行文字被竖向接缝切成两段，合并为外接矩形
+                a.bounds = a.bounds | b.bounds;
+                a.box = rectToBox(a.bounds);
+                b.alive = false;
+            }
+        }
+    }
+
+    std::vector<Quad> boxes;
+    boxes.reserve(candidates.size());
+    for (const auto& candidate : candidates) {
+        if (candidate.alive) {
+            boxes.push_back(candidate.box);
+        }
+    }
+    return boxes;
+}
+
+} // namespace PaddleOCR
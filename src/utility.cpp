@@ -137,8 +137,6 @@ void Utility::GetAllFiles(const char *dir_name,
 cv::Mat
 Utility::GetRotateCropImage(const cv::Mat &srcimage,
                             const std::vector<std::vector<int>> &box) noexcept {
-  cv::Mat image;
-  srcimage.copyTo(image);
   std::vector<std::vector<int>> points = box;
 
   int x_collect[4] = {box[0][0], box[1][0], box[2][0], box[3][0]};
@@ -148,8 +146,8 @@ Utility::GetRotateCropImage(const cv::Mat &srcimage,
   int top = int(*std::min_element(y_collect, y_collect + 4));
   int bottom = int(*std::max_element(y_collect, y_collect + 4));
 
-  cv::Mat img_crop;
-  image(cv::Rect(left, top, right - left, bottom - top)).copyTo(img_crop);
+  // warpPerspective only reads the box region, a view is enough
+  cv::Mat img_crop = srcimage(cv::Rect(left, top, right - left, bottom - top));
 
   for (size_t i = 0; i < points.size(); ++i) {
     points[i][0] -= left;
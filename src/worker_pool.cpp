@@ -0,0 +1,348 @@
+#include "paddle_ocr/worker_pool.h"
+#include <algorithm>
+#include <cmath>
+
+namespace PaddleOCR {
+
+WorkerPool::WorkerPool(const std::string& model_dir, int num_workers, bool use_gpu, const OCRWorkerConfig& config)
+    : next_worker_index_(0), scheduler_(config.scheduling, config.admission.max_queue_depth * num_workers),
+      hedge_policy_(config.hedging), shape_affinity_(num_workers, 10),
+      prefer_warm_workers_(config.scheduling.shape_affinity) {
+    workers_.reserve(num_workers);
+    for (int i = 0; i < num_workers; ++i) {
+        workers_.emplace_back(std::make_unique<OCRWorker>(i, model_dir, use_gpu, 0, false, config));
+    }
+    
+    // 分块检测时Worker之间互相分发分块
+    std::vector<OCRWorker*> peers;
+    for (auto& worker : workers_) {
+        peers.push_back(worker.get());
+    }
+    for (auto& worker : workers_) {
+        worker->setPeers(peers);
+        worker->setCompletionCallback([this](const OCRRequest& request) { onRequestCompleted(request); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    stop();
+}
+
+void WorkerPool::start() {
+    for (auto& worker : workers_) {
+        worker->start();
+    }
+    // 只有一个Worker时没有可对冲的空闲Worker
+    if (hedge_policy_.enabled() && workers_.size() > 1 && !hedge_thread_.joinable()) {
+        hedge_running_ = true;
+        hedge_thread_ = std::thread(&WorkerPool::hedgeLoop, this);
+    }
+}
+
+void WorkerPool::stop() {
+    if (hedge_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(workers_mutex_);
+            hedge_running_ = false;
+        }
+        hedge_cv_.notify_one();
+        hedge_thread_.join();
+    }
+    for (auto& worker : workers_) {
+        worker->stop();
+    }
+}
+
+std::future<std::string> WorkerPool::submitRequest(std::shared_ptr<OCRRequest> request) {
+    auto future = request->result_promise.get_future();
+    request->submit_time = std::chrono::steady_clock::now();
+    request->shape_key = workers_.front()->shapeKey(*request);
+    if (hedge_policy_.enabled() && !request->cancel_token) {
+        // 对冲副本先完成时通过它取消原请求，须在分派前创建
+        request->cancel_token = std::make_shared<CancellationToken>();
+    }
+    
+    // 准入检查与入队在同一把锁内完成，并发提交不会超过队列上限
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    std::string reason;
+    int retry_after_ms = 0;
+    if (!admitRequest(*request, reason, retry_after_ms)) {
+        rejected_requests_.fetch_add(1);
+        scheduler_.recordRejected(request->priority_class);
+        JsonWriter writer;
+        OCRWorker::writeRejectJson(request->request_id, reason, retry_after_ms, writer);
+        request->setResult(writer.str());
+        return future;
+    }
+    scheduler_.push(std::move(request));
+    dispatchLocked();
+    
+    return future;
+}
+
+AdmissionStats WorkerPool::getAdmissionStats() const {
+    AdmissionStats stats;
+    stats.rejected = rejected_requests_.load();
+    stats.cancelled = cancelled_requests_.load();
+    for (const auto& worker : workers_) {
+        stats.expired += worker->getExpiredCount();
+        stats.cancelled += worker->getCancelledCount();
+    }
+    return stats;
+}
+
+CascadeStats WorkerPool::getCascadeStats() const {
+    CascadeStats stats;
+    for (const auto& worker : workers_) {
+        CascadeStats worker_stats = worker->getCascadeStats();
+        stats.accepted += worker_stats.accepted;
+        stats.fallbacks += worker_stats.fallbacks;
+    }
+    return stats;
+}
+
+int64_t WorkerPool::getRedecodeCount() const {
+    int64_t count = 0;
+    for (const auto& worker : workers_) {
+        count += worker->getRedecodeCount();
+    }
+    return count;
+}
+
+std::vector<PriorityClassStats> WorkerPool::getSchedulerStats() const {
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    return scheduler_.stats();
+}
+
+CostModelStats WorkerPool::getCostModelStats() const {
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    return scheduler_.costModel().stats();
+}
+
+HedgingStats WorkerPool::getHedgingStats() const {
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    HedgingStats stats;
+    for (const auto& class_stats : scheduler_.stats()) {
+        stats.dispatched += class_stats.dispatched;
+    }
+    stats.launched = hedges_launched_;
+    stats.wins = hedge_wins_;
+    return stats;
+}
+
+std::vector<WorkerShapeStats> WorkerPool::getShapeStats() const {
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    return shape_affinity_.stats();
+}
+
+int WorkerPool::removeCancelled() {
+    std::vector<std::shared_ptr<OCRRequest>> removed;
+    std::vector<std::shared_ptr<OCRRequest>> dispatched;
+    {
+        std::lock_guard<std::mutex> lock(workers_mutex_);
+        scheduler_.removeCancelled(removed);
+        for (const auto& request : removed) {
+            scheduler_.recordCompleted(*request);
+        }
+        
+        // Worker队列中移出的请求不经过完成回调，在这里结束跟踪
+        for (auto& worker : workers_) {
+            worker->removeCancelled(dispatched);
+        }
+        for (const auto& request : dispatched) {
+            in_flight_.erase(std::remove_if(in_flight_.begin(), in_flight_.end(),
+                                            [&](const InFlight& entry) { return entry.request == request; }),
+                             in_flight_.end());
+            for (auto& entry : in_flight_) {
+                if (entry.partner == request) {
+                    entry.partner.reset();
+                }
+            }
+            if (request->delivered) {
+                scheduler_.recordCompleted(*request);
+            }
+        }
+        dispatchLocked();
+    }
+    
+    // 尚未分派给任何Worker，worker_id 为 -1
+    JsonWriter writer;
+    for (auto& request : removed) {
+        OCRWorker::writeErrorJson(request->request_id, RequestCancelled().what(), -1, writer);
+        request->setResult(writer.str());
+    }
+    cancelled_requests_.fetch_add(static_cast<int64_t>(removed.size()));
+    return static_cast<int>(removed.size() + dispatched.size());
+}
+
+std::string WorkerPool::getDetPrecision() const {
+    return workers_.empty() ? std::string() : workers_.front()->getDetPrecision();
+}
+
+std::string WorkerPool::getRecPrecision() const {
+    return workers_.empty() ? std::string() : workers_.front()->getRecPrecision();
+}
+
+bool WorkerPool::admitRequest(const OCRRequest& request, std::string& reason, int& retry_after_ms) const {
+    double service_ms = averageServiceMs();
+    double workers = static_cast<double>(workers_.size());
+    if (scheduler_.full(request.priority_class)) {
+        // 最快在任一Worker完成一个请求后才有空位
+        reason = "Server overloaded: request queue is full";
+        retry_after_ms = std::max(1, static_cast<int>(std::ceil(service_ms / workers)));
+        return false;
+    }
+    
+    if (request.deadline != std::chrono::steady_clock::time_point::max()) {
+        // 有空闲Worker时立即分派，否则等排在前面的请求由全部Worker分摊处理
+        bool any_free = std::any_of(workers_.begin(), workers_.end(),
+                                    [](const auto& worker) { return worker->pendingRequests() == 0; });
+        double wait_ms = any_free ? 0.0 : (scheduler_.queuedAhead(request.priority_class) + 1) * service_ms / workers;
+        // 代价模型已有足够样本时按请求尺寸预测自身耗时
+        const CostModel& cost_model = scheduler_.costModel();
+        double finish_ms = wait_ms + (cost_model.ready() ? cost_model.predict(request) : service_ms);
+        double remaining_ms = std::chrono::duration<double, std::milli>(
+            request.deadline - std::chrono::steady_clock::now()).count();
+        if (finish_ms > remaining_ms) {
+            // 按当前积压估计，排空后再试才可能在同样的截止时间内完成
+            reason = "Deadline cannot be met: estimated completion in " +
+                     std::to_string(static_cast<int>(std::ceil(finish_ms))) + " ms";
+            retry_after_ms = std::max(1, static_cast<int>(std::ceil(wait_ms)));
+            return false;
+        }
+    }
+    return true;
+}
+
+void WorkerPool::dispatchLocked() {
+    // 空闲Worker每次只拿一个请求，其余留在调度器中按优先级和客户端公平排序；从轮询位置开始找
+    std::vector<size_t> idle;
+    size_t start = static_cast<size_t>(next_worker_index_.fetch_add(1)) % workers_.size();
+    for (size_t k = 0; k < workers_.size(); ++k) {
+        size_t index = (start + k) % workers_.size();
+        if (workers_[index]->pendingRequests() == 0) {
+            idle.push_back(index);
+        }
+    }
+    while (!idle.empty() && scheduler_.queued() > 0) {
+        auto request = scheduler_.pop();
+        OCRWorker* worker = pickWorkerLocked(*request, idle);
+        in_flight_.push_back({request, std::chrono::steady_clock::now(), nullptr, false});
+        worker->addRequest(std::move(request));
+        hedge_cv_.notify_one();
+    }
+}
+
+OCRWorker* WorkerPool::pickWorkerLocked(const OCRRequest& request, std::vector<size_t>& idle) {
+    // 有多个空闲Worker时优先交给最近处理过同一输入形状的，推理引擎不必重新编译
+    size_t pick = prefer_warm_workers_ ? shape_affinity_.choose(request.shape_key, idle) : 0;
+    size_t index = idle[pick];
+    idle.erase(idle.begin() + static_cast<std::ptrdiff_t>(pick));
+    shape_affinity_.record(index, request.shape_key);
+    return workers_[index].get();
+}
+
+void WorkerPool::onRequestCompleted(const OCRRequest& request) {
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    std::shared_ptr<OCRRequest> partner;
+    auto it = std::find_if(in_flight_.begin(), in_flight_.end(),
+                           [&](const InFlight& entry) { return entry.request.get() == &request; });
+    if (it != in_flight_.end()) {
+        partner = std::move(it->partner);
+        in_flight_.erase(it);
+    }
+    if (partner) {
+        // 先完成的一方已给出响应，另一方不再需要
+        partner->cancel_token->cancel();
+        for (auto& entry : in_flight_) {
+            if (entry.request == partner) {
+                entry.partner.reset();
+            }
+        }
+    }
+    
+    // 对冲中只统计给出响应的一方
+    if (request.delivered) {
+        if (request.hedge_of) {
+            ++hedge_wins_;
+        }
+        scheduler_.recordCompleted(request);
+        hedge_policy_.record(request);
+    }
+    dispatchLocked();
+    hedge_cv_.notify_one();
+}
+
+void WorkerPool::hedgeLoop() {
+    std::unique_lock<std::mutex> lock(workers_mutex_);
+    while (hedge_running_) {
+        auto next = hedgeLocked();
+        if (next == std::chrono::steady_clock::time_point::max()) {
+            hedge_cv_.wait(lock);
+        } else {
+            hedge_cv_.wait_until(lock, next);
+        }
+    }
+}
+
+std::chrono::steady_clock::time_point WorkerPool::hedgeLocked() {
+    auto now = std::chrono::steady_clock::now();
+    auto next = std::chrono::steady_clock::time_point::max();
+    // 有请求等待分派时空闲Worker应先处理它们
+    if (scheduler_.queued() > 0) {
+        return next;
+    }
+    
+    size_t count = in_flight_.size();  // 新加入的对冲副本不再检查
+    for (size_t i = 0; i < count; ++i) {
+        if (in_flight_[i].hedged) {
+            continue;
+        }
+        double threshold_ms = hedge_policy_.thresholdMs(*in_flight_[i].request);
+        if (threshold_ms < 0.0) {
+            continue;
+        }
+        auto due = in_flight_[i].started + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double, std::milli>(threshold_ms));
+        if (due > now) {
+            next = std::min(next, due);
+            continue;
+        }
+        if (in_flight_[i].request->cancel_token->isCancelled()) {
+            continue;
+        }
+        
+        std::vector<size_t> idle;
+        for (size_t index = 0; index < workers_.size(); ++index) {
+            if (workers_[index]->pendingRequests() == 0) {
+                idle.push_back(index);
+            }
+        }
+        if (idle.empty()) {
+            // 等有Worker完成请求时再检查
+            return std::chrono::steady_clock::time_point::max();
+        }
+        auto hedge = makeHedgeRequest(in_flight_[i].request);
+        in_flight_[i].hedged = true;
+        in_flight_[i].partner = hedge;
+        in_flight_.push_back({hedge, now, in_flight_[i].request, true});
+        ++hedges_launched_;
+        pickWorkerLocked(*hedge, idle)->addRequest(std::move(hedge));
+    }
+    return next;
+}
+
+double WorkerPool::averageServiceMs() const {
+    double total = 0.0;
+    int count = 0;
+    for (const auto& worker : workers_) {
+        double service_ms = worker->averageServiceMs();
+        if (service_ms > 0.0) {
+            total += service_ms;
+            ++count;
+        }
+    }
+    return count > 0 ? total / count : 0.0;
+}
+
+} // namespace PaddleOCR
@@ -0,0 +1,1329 @@
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <future>
+#include <thread>
+#include <chrono>
+#include <json/json.h>
+#include <sstream>
+#include <vector>
+#include <cstring>
+#include <filesystem>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+
+#include <paddle_ocr/ocr_worker.h>
+#include <paddle_ocr/inference_backend.h>
+#include <paddle_ocr/buffer_pool.h>
+#include <paddle_ocr/ipc_request.h>
+#include <paddle_ocr/image_loader.h>
+#include <paddle_ocr/result_cache.h>
+#include <paddle_ocr/rec_cache.h>
+#include <paddle_ocr/layout_template.h>
+#include <paddle_ocr/cpu_worker_pool.h>
+#include "simple_test.h"
+
+using namespace PaddleOCR;
+
+/**
+ * @brief 使用 mock 推理后端的流水线测试
+ *
+ * 不依赖 Paddle 运行时和模型权重 (仅需 models/rec/ppocr_keys_v1.txt 字典)，
+ * 用于在任意 Linux 机器上回归测试和压测排队、前后处理、序列化等推理以外的开销。
+ */
+class MockPipelineTest {
+private:
+    std::string model_dir_;
+    cv::Mat test_image_;
+    std::unique_ptr<OCRWorker> worker_;
+
+public:
+    void setUp() {
+        model_dir_ = "models";
+        test_image_ = createTestImage();
+    }
+
+    void tearDown() {
+        if (worker_) {
+            worker_->stop();
+        }
+        worker_.reset();
+    }
+
+    cv::Mat createTestImage() {
+        cv::Mat image = cv::Mat::zeros(400, 600, CV_8UC3);
+        image.setTo(cv::Scalar(255, 255, 255));
+        cv::putText(image, "Hello OCR Test", cv::Point(50, 50),
+                   cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0, 0, 0), 2);
+        cv::putText(image, "PaddleOCR", cv::Point(50, 100),
+                   cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0, 0, 0), 2);
+        return image;
+    }
+
+    Json::Value parseJsonResult(const std::string& json_str) {
+        Json::Value root;
+        Json::CharReaderBuilder builder;
+        std::string errors;
+        std::istringstream iss(json_str);
+
+        if (!Json::parseFromStream(builder, iss, &root, &errors)) {
+            throw std::runtime_error("Failed to parse JSON: " + errors);
+        }
+
+        return root;
+    }
+
+    /**
+     * @brief 创建全部模型使用指定 mock 后端的 Worker
+     */
+    std::unique_ptr<OCRWorker> createMockWorker(int worker_id, const std::string& backend,
+                                                bool enable_cls = false) {
+        OCRWorkerConfig config;
+        config.det_backend = backend;
+        config.cls_backend = backend;
+        config.rec_backend = backend;
+        return std::make_unique<OCRWorker>(worker_id, model_dir_, false, 0, enable_cls, config);
+    }
+
+    Json::Value runRequest(OCRWorker& worker, int request_id, const cv::Mat& image) {
+        return runRequest(worker, std::make_shared<OCRRequest>(request_id, image));
+    }
+
+    Json::Value runRequest(OCRWorker& worker, std::shared_ptr<OCRRequest> request) {
+        auto future = request->result_promise.get_future();
+        worker.addRequest(request);
+
+        auto status = future.wait_for(std::chrono::seconds(30));
+        SimpleTest::assertTrue(status == std::future_status::ready, "Mock request should complete within 30 seconds");
+        return parseJsonResult(future.get());
+    }
+
+    void testMockBackendShapes() {
+        SimpleTest::printLine("\n=== 测试 mock 后端输出形状 ===");
+
+        InferenceOptions options;
+        options.model_name = "Detector";
+        auto det = CreateInferenceBackend("mock", options);
+        SimpleTest::assertTrue(det->Name() == "mock", "Backend name should be mock");
+
+        std::vector<float> det_input(1 * 3 * 128 * 256, 0.5f);
+        det->Reshape({1, 3, 128, 256});
+        det->CopyFromCpu(det_input.data());
+        SimpleTest::assertTrue(det->Run(), "Det mock should run");
+        std::vector<int> det_shape = det->OutputShape();
+        SimpleTest::assertEquals(4, int(det_shape.size()), "Det output should be NCHW");
+        SimpleTest::assertEquals(128, det_shape[2], "Det map height should match input");
+        SimpleTest::assertEquals(256, det_shape[3], "Det map width should match input");
+
+        options.model_name = "Recognizer";
+        options.num_classes = 100;
+        auto rec = CreateInferenceBackend("mock", options);
+        std::vector<float> rec_input(2 * 3 * 48 * 320, 0.1f);
+        rec->Reshape({2, 3, 48, 320});
+        rec->CopyFromCpu(rec_input.data());
+        SimpleTest::assertTrue(rec->Run(), "Rec mock should run");
+        std::vector<int> rec_shape = rec->OutputShape();
+        SimpleTest::assertEquals(2, rec_shape[0], "Rec output batch should match input");
+        SimpleTest::assertEquals(40, rec_shape[1], "Rec output should have W/8 time steps");
+        SimpleTest::assertEquals(100, rec_shape[2], "Rec output should have num_classes columns");
+
+        // Clone 后输出一致
+        auto rec_clone = rec->Clone();
+        rec_clone->Reshape({2, 3, 48, 320});
+        rec_clone->CopyFromCpu(rec_input.data());
+        rec_clone->Run();
+        std::vector<float> a(2 * 40 * 100), b(2 * 40 * 100);
+        rec->CopyToCpu(a.data());
+        rec_clone->CopyToCpu(b.data());
+        SimpleTest::assertTrue(a == b, "Cloned mock should produce identical logits");
+    }
+
+    void testMockDeterministic() {
+        SimpleTest::printLine("\n=== 测试 mock 流水线结果确定性 ===");
+
+        worker_ = createMockWorker(1, "mock", true);
+        worker_->start();
+
+        Json::Value first = runRequest(*worker_, 2001, test_image_);
+        Json::Value second = runRequest(*worker_, 2002, test_image_);
+        SimpleTest::printJsonResult(first, "mock流水线结果");
+
+        SimpleTest::assertTrue(first["success"].asBool(), "Mock OCR should succeed");
+        SimpleTest::assertTrue(first["words"].size() > 0, "Mock det should produce text lines");
+        SimpleTest::assertEquals(int(first["words"].size()), int(second["words"].size()),
+                                 "Same image should give the same number of words");
+        bool same_text = true;
+        for (Json::ArrayIndex i = 0; i < first["words"].size() && i < second["words"].size(); ++i) {
+            same_text = same_text && first["words"][i]["text"] == second["words"][i]["text"]
+                        && first["words"][i]["box"] == second["words"][i]["box"];
+        }
+        SimpleTest::assertTrue(same_text, "Same image should give identical words and boxes");
+    }
+
+    void testMockLatency() {
+        SimpleTest::printLine("\n=== 测试 mock 后端模拟延迟 ===");
+
+        worker_ = createMockWorker(1, "mock:40");
+        worker_->start();
+
+        Json::Value result = runRequest(*worker_, 2003, test_image_);
+        SimpleTest::assertTrue(result["success"].asBool(), "Mock OCR should succeed");
+        // det 与每个 rec 批次各至少 40ms
+        SimpleTest::assertTrue(result["processing_time_ms"].asDouble() >= 80.0,
+                               "Processing time should include simulated det and rec latency");
+        std::cout << "processing_time_ms (mock:40): " << result["processing_time_ms"].asDouble() << std::endl;
+    }
+
+    void testBufferPoolSteadyState() {
+        SimpleTest::printLine("\n=== 测试中间缓冲区内存池稳态命中率 ===");
+
+        // 尺寸等级：块大小不小于请求、浪费不超过 25%
+        bool classes_ok = true;
+        for (size_t size : {size_t(1), size_t(64), size_t(65), size_t(4096), size_t(512 * 512 * 3 * 4)}) {
+            size_t class_size = 0;
+            int cls = PooledMatAllocator::sizeClass(size, class_size);
+            classes_ok = classes_ok && cls >= 0 && class_size >= size && class_size <= size + size / 4 + 64;
+        }
+        SimpleTest::assertTrue(classes_ok, "Size classes should cover the request with at most 25% waste");
+
+        worker_ = createMockWorker(1, "mock", true);
+        SimpleTest::assertTrue(PooledMatAllocator::installed(), "Worker should install the pooled allocator by default");
+        worker_->start();
+
+        // 预热后同尺寸请求应几乎全部命中池
+        for (int i = 0; i < 3; ++i) {
+            runRequest(*worker_, 4000 + i, test_image_);
+        }
+        BufferPoolStatsSnapshot before = PooledMatAllocator::stats();
+        for (int i = 0; i < 20; ++i) {
+            runRequest(*worker_, 4100 + i, test_image_);
+        }
+        BufferPoolStatsSnapshot after = PooledMatAllocator::stats();
+
+        long long allocations = after.allocations - before.allocations;
+        long long hits = after.pool_hits - before.pool_hits;
+        double hit_ratio = allocations > 0 ? static_cast<double>(hits) / allocations : 0.0;
+        std::cout << "steady-state Mat allocations: " << allocations << ", pool hits: " << hits
+                  << ", hit ratio: " << hit_ratio << std::endl;
+        SimpleTest::assertTrue(allocations > 0, "Pipeline Mats should go through the pooled allocator");
+        SimpleTest::assertTrue(hit_ratio > 0.8, "Steady-state requests should reuse pooled buffers");
+    }
+
+    void testIPCRequestParse() {
+        SimpleTest::printLine("\n=== 测试 IPC 请求原地解析 ===");
+
+        // 大 Base64 字段应直接指向接收缓冲区
+        std::string payload(1 << 20, 'A');
+        std::string buffer = "{ \"command\": \"recognize\", \"image_data\": \"" + payload + "\",\n \"extra\": [1, {\"x\": \"\\u4e2d\"}, -2.5e3, null, true] }";
+        IPCRequest request;
+        std::string error;
+        SimpleTest::assertTrue(request.parseInSitu(buffer.data(), buffer.size(), error), "Valid request should parse");
+        std::string_view image_data = request.getString("image_data");
+        SimpleTest::assertEquals(static_cast<int>(payload.size()), static_cast<int>(image_data.size()),
+                                 "image_data should keep its full length");
+        SimpleTest::assertTrue(image_data.data() >= buffer.data() && image_data.data() < buffer.data() + buffer.size(),
+                               "image_data should be a view into the receive buffer");
+        SimpleTest::assertTrue(request.command() == "recognize", "Command should be parsed");
+        SimpleTest::assertTrue(request.getString("extra", "none") == "none", "Non-string members should yield the default");
+        SimpleTest::assertTrue(buffer.find("\"x\": \"\\u4e2d\"") != std::string::npos,
+                               "Strings nested in arrays should not be rewritten");
+
+        // 转义字符串原地反转义，重复的键以最后一个为准
+        std::string escaped = "{\"image_path\":\"C:\\\\imgs\\/\\u4e2d\\ud83d\\ude00.png\",\"command\":\"status\",\"command\":\"shutdown\",}";
+        SimpleTest::assertTrue(request.parseInSitu(escaped.data(), escaped.size(), error), "Escaped request should parse");
+        SimpleTest::assertTrue(request.getString("image_path") == "C:\\imgs/\xE4\xB8\xAD\xF0\x9F\x98\x80.png",
+                               "Escapes and surrogate pairs should be decoded in place");
+        SimpleTest::assertTrue(request.command() == "shutdown", "Last duplicate key should win");
+
+        // 非法输入
+        for (std::string bad : {"", "[1,2]", "{\"command\": }", "{\"command\": \"recognize\"",
+                                "{\"a\": \"\\x\"}", "{\"a\": [1, 2}", "{\"a\": \"\\ud83d\"}"}) {
+            SimpleTest::assertTrue(!request.parseInSitu(bad.data(), bad.size(), error) && !error.empty(),
+                                   "Malformed request should be rejected: " + bad);
+        }
+
+        // 与 JsonCpp 解析同一请求的耗时对比
+        const int iterations = 20;
+        std::string source = "{\"command\": \"recognize\", \"image_data\": \"" + payload + "\"}";
+        std::vector<char> scratch(source.size());
+        size_t sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            std::memcpy(scratch.data(), source.data(), source.size());
+            request.parseInSitu(scratch.data(), scratch.size(), error);
+            sink += request.getString("image_data").size();
+        }
+        double in_situ_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            Json::Value root = parseJsonResult(source);
+            sink += root["image_data"].asString().size();
+        }
+        double jsoncpp_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "1MB request x " << iterations << ": in-situ " << in_situ_ms << "ms (incl. buffer copy), JsonCpp "
+                  << jsoncpp_ms << "ms (" << sink << " bytes)" << std::endl;
+    }
+
+    void testReducedDecode() {
+        SimpleTest::printLine("\n=== 测试 image_path 映射与缩小解码 ===");
+
+        // 模拟 12MP 手机照片
+        cv::Mat photo(3000, 4000, CV_8UC3, cv::Scalar(255, 255, 255));
+        for (int y = 200; y < 2800; y += 300) {
+            cv::putText(photo, "Reduced decode line " + std::to_string(y), cv::Point(200, y),
+                        cv::FONT_HERSHEY_SIMPLEX, 6.0, cv::Scalar(0, 0, 0), 12);
+        }
+        std::filesystem::path dir = std::filesystem::temp_directory_path();
+        std::string jpeg_path = (dir / "paddle_ocr_reduced_decode.jpg").string();
+        std::string png_path = (dir / "paddle_ocr_reduced_decode.png").string();
+        SimpleTest::assertTrue(cv::imwrite(jpeg_path, photo), "Should write test JPEG");
+        SimpleTest::assertTrue(cv::imwrite(png_path, photo(cv::Rect(0, 0, 2000, 1500))), "Should write test PNG");
+
+        std::string error;
+        auto file = MappedFile::open(jpeg_path, error);
+        SimpleTest::assertTrue(file != nullptr, "JPEG should be mapped");
+        cv::Size jpeg_size;
+        SimpleTest::assertTrue(ImageLoader::probeJpegSize(file->data(), file->size(), jpeg_size) &&
+                               jpeg_size == photo.size(), "JPEG header probe should report the full size");
+        SimpleTest::assertEquals(4, ImageLoader::chooseScale(photo.size(), 960), "12MP photo should decode at 1/4");
+        SimpleTest::assertEquals(1, ImageLoader::chooseScale(cv::Size(1280, 720), 960), "Small image should not be reduced");
+
+        ReducedDecodeConfig config;
+        config.enabled = true;
+        cv::Mat image;
+        std::shared_ptr<const ReducedImageSource> source;
+        SimpleTest::assertTrue(ImageLoader::load(jpeg_path, config, image, source, error), "Reduced load should succeed");
+        SimpleTest::assertTrue(source != nullptr && source->scale == 4, "Large JPEG should be reduced by 4");
+        SimpleTest::assertTrue(image.size() == cv::Size(1000, 750), "Reduced image should be 1/4 of the original");
+        SimpleTest::assertTrue(source->original_size == photo.size(), "Source should keep the original size");
+        SimpleTest::assertTrue(source->decodeFull().size() == photo.size(), "Full decode should restore the original size");
+        SimpleTest::assertTrue(source->decodeAt(2).size() == cv::Size(2000, 1500), "Re-decode at 1/2 should halve the original");
+        SimpleTest::assertEquals(2, source->redecodeScale(6.0, 10), "6px text at 1/4 reaches 10px at 1/2");
+        SimpleTest::assertEquals(1, source->redecodeScale(4.0, 10), "4px text at 1/4 needs the original");
+
+        SimpleTest::assertTrue(ImageLoader::load(png_path, config, image, source, error) && !source &&
+                               image.size() == cv::Size(2000, 1500), "Non-JPEG images should decode at full resolution");
+        SimpleTest::assertTrue(!ImageLoader::load((dir / "paddle_ocr_missing.jpg").string(), config, image, source, error) &&
+                               error.find("Failed to load image from path") == 0, "Missing file should report a load error");
+
+        // 缩小解码的请求：结果尺寸与坐标按原图输出
+        worker_ = createMockWorker(1, "mock");
+        worker_->start();
+        ImageLoader::load(jpeg_path, config, image, source, error);
+        auto request = std::make_shared<OCRRequest>(5001, std::move(image));
+        request->reduced_source = source;
+        auto future = request->result_promise.get_future();
+        worker_->addRequest(request);
+        Json::Value result = parseJsonResult(future.get());
+        SimpleTest::assertTrue(result["success"].asBool(), "Reduced request should succeed");
+        SimpleTest::assertEquals(4000, result["width"].asInt(), "Reported width should be the original width");
+        SimpleTest::assertEquals(3000, result["height"].asInt(), "Reported height should be the original height");
+        bool inside = result["words"].size() > 0;
+        for (const auto& word : result["words"]) {
+            for (const auto& point : word["box"]) {
+                inside = inside && point[0].asInt() >= 0 && point[0].asInt() < 4000 &&
+                         point[1].asInt() >= 0 && point[1].asInt() < 3000;
+            }
+        }
+        SimpleTest::assertTrue(inside, "Boxes should be mapped back into original coordinates");
+
+        // 解码耗时对比
+        const int iterations = 5;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            cv::Mat full = cv::imread(jpeg_path);
+        }
+        double full_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            ImageLoader::load(jpeg_path, config, image, source, error);
+        }
+        double reduced_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+        std::cout << "12MP JPEG decode: imread " << full_ms << "ms, mmap + 1/" << (source ? source->scale : 1)
+                  << " decode " << reduced_ms << "ms" << std::endl;
+
+        std::filesystem::remove(jpeg_path);
+        std::filesystem::remove(png_path);
+    }
+
+    void testResultCache() {
+        SimpleTest::printLine("\n=== 测试结果缓存与相同请求合并 ===");
+
+        // XXH64 标准测试向量
+        SimpleTest::assertTrue(ResultCache::hash64("", 0) == 0xEF46DB3751D8E999ULL, "XXH64 of empty input");
+        SimpleTest::assertTrue(ResultCache::hash64("abc", 3) == 0x44BC2CF5AD770999ULL, "XXH64 of abc");
+        SimpleTest::assertTrue(!(ResultCache::makeKey("image", "a") == ResultCache::makeKey("image", "b")),
+                               "Request variants should not share keys");
+
+        ResultCacheConfig config;
+        config.enabled = true;
+        config.max_entries = 2;
+        ResultCache cache(config);
+        const std::string ok = "{\"success\":true,\"words\":[]}";
+
+        // 同步计算包装为异步提交
+        auto submitting = [](std::function<std::string()> compute) -> ResultCache::Submit {
+            return [compute](std::shared_ptr<CancellationToken>) { return std::async(std::launch::async, compute); };
+        };
+
+        // 8 个并发的相同请求只计算一次
+        std::atomic<int> computations{0};
+        auto slow_compute = submitting([&]() {
+            computations++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            return ok;
+        });
+        std::vector<std::thread> threads;
+        std::vector<std::string> responses(8);
+        ResultCache::Key key = ResultCache::makeKey("same image bytes");
+        for (int i = 0; i < 8; ++i) {
+            threads.emplace_back([&, i]() { responses[i] = *cache.getOrCompute(key, slow_compute); });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        SimpleTest::assertEquals(1, computations.load(), "Concurrent identical requests should share one computation");
+        SimpleTest::assertTrue(std::all_of(responses.begin(), responses.end(), [&](const std::string& r) { return r == ok; }),
+                               "All coalesced requests should get the same response");
+        bool shared = false;
+        cache.getOrCompute(key, slow_compute, {}, &shared);
+        SimpleTest::assertEquals(1, computations.load(), "Repeated request should hit the cache");
+        SimpleTest::assertTrue(shared, "Cache hits should be reported as shared");
+        cache.getOrCompute(ResultCache::makeKey("fresh image"), submitting([]() { return std::string("{\"success\":false}"); }), {}, &shared);
+        SimpleTest::assertTrue(!shared, "Computed results should not be reported as shared");
+
+        // 共享的响应换成本请求的 request_id 和耗时
+        Json::Value rebound = parseJsonResult(ResultCache::rebind(
+            "{\"processing_time_ms\":456.5,\"request_id\":7,\"success\":true,\"words\":[{\"text\":\"中文\"}],\"worker_id\":2}", 9, 0.25));
+        SimpleTest::assertEquals(9, rebound["request_id"].asInt(), "Shared responses should carry the caller's request_id");
+        SimpleTest::assertTrue(rebound["processing_time_ms"].asDouble() == 0.25, "Shared responses should report the caller's time");
+        SimpleTest::assertTrue(rebound["cached"].asBool(), "Shared responses should be marked as cached");
+        SimpleTest::assertTrue(rebound["words"][0]["text"].asString() == "中文", "Recognized text should be preserved");
+
+        // 失败结果不缓存，异常传给调用方
+        const std::string failed = "{\"error\":\"x\",\"success\":false}";
+        ResultCache::Key failed_key = ResultCache::makeKey("broken image");
+        cache.getOrCompute(failed_key, submitting([&]() { return failed; }));
+        int failed_runs = 0;
+        cache.getOrCompute(failed_key, submitting([&]() { ++failed_runs; return failed; }));
+        SimpleTest::assertEquals(1, failed_runs, "Failed results should not be cached");
+        bool thrown = false;
+        try {
+            cache.getOrCompute(ResultCache::makeKey("throws"), submitting([]() -> std::string { throw std::runtime_error("boom"); }));
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        SimpleTest::assertTrue(thrown, "Compute exceptions should propagate");
+
+        // 等待共享计算的请求单独用一个缓存，不影响下面的淘汰顺序
+        std::atomic<int> cancel_calls{0};
+        ResultCache waiting_cache(config, [&]() { cancel_calls++; });
+
+        // 首个请求失败 (如超过它自己的截止时间) 时，合并进来的请求按自己的参数重新计算，不共享失败结果
+        ResultCache::Key expiring_key = ResultCache::makeKey("expiring image");
+        std::promise<void> leader_started;
+        std::thread leader([&]() {
+            waiting_cache.getOrCompute(expiring_key, submitting([&]() {
+                leader_started.set_value();
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                return std::string("{\"error\":\"Deadline exceeded before processing\",\"success\":false}");
+            }));
+        });
+        leader_started.get_future().wait();
+        std::optional<std::string> follower = waiting_cache.getOrCompute(expiring_key, submitting([&]() { return ok; }), {}, &shared);
+        leader.join();
+        SimpleTest::assertTrue(follower && *follower == ok && !shared, "Followers should recompute when the shared computation fails");
+
+        // 合并进来的请求在自己被取消时不再等待，其他调用方仍在等待时不取消共享的计算
+        ResultCache::Key slow_key = ResultCache::makeKey("slow image");
+        std::promise<std::shared_ptr<CancellationToken>> slow_started;
+        std::promise<std::string> slow_result;
+        std::thread slow_leader([&]() {
+            waiting_cache.getOrCompute(slow_key, [&](std::shared_ptr<CancellationToken> token) {
+                slow_started.set_value(token);
+                return slow_result.get_future();
+            });
+        });
+        std::shared_ptr<CancellationToken> slow_token = slow_started.get_future().get();
+        CancellationToken follower_token;
+        follower_token.cancel();
+        std::optional<std::string> gave_up = waiting_cache.getOrCompute(slow_key, submitting([&]() { return ok; }),
+                                                                [&]() { return follower_token.isCancelled(); });
+        SimpleTest::assertTrue(!gave_up, "Cancelled followers should stop waiting for the shared computation");
+        SimpleTest::assertTrue(!slow_token->isCancelled() && cancel_calls == 0,
+                               "Shared computation should continue while another caller waits");
+        slow_result.set_value(ok);
+        slow_leader.join();
+
+        // 所有等待者 (含发起计算的请求) 都放弃后才取消共享的计算
+        ResultCache::Key abandoned_key = ResultCache::makeKey("abandoned image");
+        std::promise<std::shared_ptr<CancellationToken>> abandoned_started;
+        std::atomic<bool> leader_gone{false};
+        std::atomic<bool> follower_gone{false};
+        std::optional<std::string> leader_result = ok;
+        std::optional<std::string> follower_result = ok;
+        auto until_cancelled = [&](std::shared_ptr<CancellationToken> token) {
+            abandoned_started.set_value(token);
+            return std::async(std::launch::async, [token]() {
+                while (!token->isCancelled()) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                }
+                return std::string("{\"error\":\"Request cancelled\",\"success\":false}");
+            });
+        };
+        std::thread abandoned_leader([&]() {
+            leader_result = waiting_cache.getOrCompute(abandoned_key, until_cancelled, [&]() { return leader_gone.load(); });
+        });
+        std::shared_ptr<CancellationToken> abandoned_token = abandoned_started.get_future().get();
+        long long coalesced = waiting_cache.stats().coalesced;
+        std::thread abandoned_follower([&]() {
+            follower_result = waiting_cache.getOrCompute(abandoned_key, submitting([&]() { return ok; }),
+                                                 [&]() { return follower_gone.load(); });
+        });
+        while (waiting_cache.stats().coalesced == coalesced) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        leader_gone = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        SimpleTest::assertTrue(!abandoned_token->isCancelled(), "Leader leaving alone should not cancel the shared computation");
+        follower_gone = true;
+        abandoned_follower.join();
+        abandoned_leader.join();
+        SimpleTest::assertTrue(abandoned_token->isCancelled() && cancel_calls == 1,
+                               "Shared computation should be cancelled once every caller has left");
+        SimpleTest::assertTrue(!leader_result && !follower_result, "Callers that left should get no shared result");
+
+        // 条数上限按 LRU 淘汰
+        cache.getOrCompute(ResultCache::makeKey("second"), submitting([&]() { return ok; }));
+        cache.getOrCompute(key, slow_compute);  // key 成为最近使用
+        cache.getOrCompute(ResultCache::makeKey("third"), submitting([&]() { return ok; }));
+        ResultCacheStats stats = cache.stats();
+        SimpleTest::assertEquals(2, static_cast<int>(stats.entries), "Cache should respect max_entries");
+        SimpleTest::assertTrue(stats.evictions >= 1, "Least recently used entry should be evicted");
+        cache.getOrCompute(key, slow_compute);
+        SimpleTest::assertEquals(1, computations.load(), "Recently used entry should survive eviction");
+
+        // 过期后重新计算
+        config.ttl_seconds = 1;
+        ResultCache short_lived(config);
+        int runs = 0;
+        auto counted = submitting([&]() { ++runs; return ok; });
+        short_lived.getOrCompute(key, counted);
+        short_lived.getOrCompute(key, counted);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+        short_lived.getOrCompute(key, counted);
+        SimpleTest::assertEquals(2, runs, "Expired entries should be recomputed");
+        SimpleTest::assertEquals(1, static_cast<int>(short_lived.stats().expirations), "Expiration should be counted");
+
+        std::cout << "hits: " << stats.hits << ", misses: " << stats.misses << ", coalesced: " << stats.coalesced
+                  << ", evictions: " << stats.evictions << std::endl;
+    }
+
+    void testRecognitionCache() {
+        SimpleTest::printLine("\n=== 测试文字区域识别缓存 ===");
+
+        auto makeCrop = [](const std::string& text, double background, int shift, int width = 280) {
+            cv::Mat crop(48, width, CV_8UC3, cv::Scalar::all(background));
+            cv::putText(crop, text, cv::Point(8 + shift, 34), cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0, 0, 0), 2);
+            return crop;
+        };
+
+        RecCacheConfig config;
+        config.enabled = true;
+        config.min_score = 0.5f;
+        RecognitionCache& cache = RecognitionCache::instance();
+        cache.configure(config);
+        cache.clear();
+
+        cache.insert(RecognitionCache::fingerprint(makeCrop("Name", 255, 0)), "Name", 0.98f);
+
+        std::string text;
+        float score = 0.0f;
+        SimpleTest::assertTrue(cache.lookup(RecognitionCache::fingerprint(makeCrop("Name", 255, 0)), text, score) &&
+                               text == "Name", "Identical crop should hit");
+
+        // 底色变化、噪声和检测框位移仍视为同一区域
+        cv::Mat noisy = makeCrop("Name", 200, 3);
+        cv::Mat noise(noisy.size(), noisy.type());
+        cv::randn(noise, cv::Scalar::all(0), cv::Scalar::all(8));
+        noisy += noise;
+        SimpleTest::assertTrue(cache.lookup(RecognitionCache::fingerprint(noisy), text, score) && text == "Name",
+                               "Shifted noisy crop on a darker background should hit");
+
+        cv::Mat inverted;
+        cv::bitwise_not(makeCrop("Name", 255, 0), inverted);
+        SimpleTest::assertTrue(cache.lookup(RecognitionCache::fingerprint(inverted), text, score),
+                               "Light text on a dark background should hit");
+
+        cache.insert(RecognitionCache::fingerprint(makeCrop("No.1234567", 255, 0)), "No.1234567", 0.97f);
+        SimpleTest::assertTrue(!cache.lookup(RecognitionCache::fingerprint(makeCrop("No.1234563", 255, 0)), text, score),
+                               "Same-width text differing in one character should miss");
+        SimpleTest::assertTrue(!cache.lookup(RecognitionCache::fingerprint(makeCrop("Card", 255, 0)), text, score),
+                               "Different text should miss");
+        SimpleTest::assertTrue(RecognitionCache::fingerprint(makeCrop("", 255, 0)).width == 0,
+                               "Blank crop should have no fingerprint");
+
+        // 长文本中单个易混字符不同：容差按字符窗口计，不因整行变长而放宽
+        const std::string line = "Account 1234567890 Il0O";
+        cache.insert(RecognitionCache::fingerprint(makeCrop(line, 255, 0, 480)), line, 0.96f);
+        SimpleTest::assertTrue(cache.lookup(RecognitionCache::fingerprint(makeCrop(line, 220, 2, 480)), text, score) &&
+                               text == line, "Identical long line should hit");
+        const std::pair<char, char> confusables[] = {{'1', 'l'}, {'0', 'O'}, {'I', 'l'}, {'O', '0'}, {'3', '8'}, {'c', 'e'}};
+        for (const auto& [from, to] : confusables) {
+            std::string variant = line;
+            variant[variant.find(from)] = to;
+            SimpleTest::assertTrue(!cache.lookup(RecognitionCache::fingerprint(makeCrop(variant, 255, 0, 480)), text, score),
+                                   "Long line with '" + std::string(1, from) + "' -> '" + std::string(1, to) + "' should miss");
+        }
+        SimpleTest::assertTrue(RecognitionCache::fingerprint(
+                                   makeCrop("Account 1234567890 Branch Office Reference Number 42", 255, 0, 1600)).width == 0,
+                               "Lines wider than the thumbnail limit should not be cached");
+
+        cache.insert(RecognitionCache::fingerprint(makeCrop("Low", 255, 0)), "Low", 0.3f);
+        SimpleTest::assertTrue(!cache.lookup(RecognitionCache::fingerprint(makeCrop("Low", 255, 0)), text, score),
+                               "Low-confidence results should not be cached");
+
+        // 内存上限
+        config.max_bytes = 16 << 10;
+        cache.configure(config);
+        for (int i = 0; i < 200; ++i) {
+            std::string label = "ID" + std::to_string(100000 + i * 7919);
+            cache.insert(RecognitionCache::fingerprint(makeCrop(label, 255, 0)), label, 0.95f);
+        }
+        RecCacheStats stats = cache.stats();
+        SimpleTest::assertTrue(stats.bytes <= config.max_bytes, "Cache should stay within its byte budget");
+        SimpleTest::assertTrue(stats.evictions > 0, "Cache should evict when over budget");
+
+        // Worker 第二次处理同一图像时识别全部命中
+        config.max_bytes = size_t(8) << 20;
+        cache.clear();
+        OCRWorkerConfig worker_config;
+        worker_config.det_backend = "mock";
+        worker_config.cls_backend = "mock";
+        worker_config.rec_backend = "mock";
+        worker_config.rec_cache = config;
+        worker_ = std::make_unique<OCRWorker>(1, model_dir_, false, 0, false, worker_config);
+        worker_->start();
+
+        Json::Value first = runRequest(*worker_, 6001, test_image_);
+        RecCacheStats after_first = cache.stats();
+        Json::Value second = runRequest(*worker_, 6002, test_image_);
+        RecCacheStats after_second = cache.stats();
+
+        SimpleTest::assertTrue(first["words"].size() > 0, "Mock request should produce words");
+        SimpleTest::assertTrue(first["words"] == second["words"], "Cached recognition should reproduce the same words");
+        SimpleTest::assertEquals(0, int(after_first.hits), "First request should not hit an empty cache");
+        SimpleTest::assertTrue(after_second.hits - after_first.hits >= static_cast<long long>(after_first.entries) &&
+                               after_second.hits > after_first.hits, "Cached regions of the repeated image should hit");
+        std::cout << "rec cache entries: " << after_second.entries << ", bytes: " << after_second.bytes
+                  << ", hits: " << after_second.hits << "/" << after_second.lookups << std::endl;
+    }
+
+    void testLayoutTemplate() {
+        SimpleTest::printLine("\n=== 测试版面模板 (跳过检测) ===");
+
+        const std::string json = R"({"templates": [
+            {"name": "bank_card", "align": true, "align_margin": 0.01, "fields": [
+                {"name": "card_number", "box": [0.04, 0.40, 0.62, 0.12]},
+                {"name": "holder", "box": [0.04, 0.66, 0.40, 0.12]},
+                {"name": "blank", "box": [0.70, 0.05, 0.25, 0.10]}]},
+            {"name": "fixed", "align": false, "fields": [{"name": "all", "box": [0.25, 0.25, 0.5, 0.5]}]}]})";
+        LayoutTemplateRegistry registry;
+        std::string error;
+        SimpleTest::assertTrue(registry.parse(json, error), "Template JSON should parse: " + error);
+        SimpleTest::assertEquals(2, int(registry.size()), "Both templates should be registered");
+        SimpleTest::assertTrue(registry.find("missing") == nullptr, "Unknown template should not be found");
+        SimpleTest::assertTrue(!LayoutTemplateRegistry().parse(
+            R"({"templates": [{"name": "bad", "fields": [{"name": "f", "box": [0.8, 0, 0.5, 0.1]}]}]})", error),
+            "Field boxes outside the image should be rejected");
+        SimpleTest::assertTrue(!LayoutTemplateRegistry().parse(
+            R"({"templates": [{"name": "a", "fields": [{"name": "f", "box": [0, 0, 1, 1]}]},
+                              {"name": "a", "fields": [{"name": "f", "box": [0, 0, 1, 1]}]}]})", error),
+            "Duplicate template names should be rejected");
+
+        cv::Mat card(400, 640, CV_8UC3, cv::Scalar(255, 255, 255));
+        cv::putText(card, "6222 0212 3456", cv::Point(40, 200), cv::FONT_HERSHEY_SIMPLEX, 1.2, cv::Scalar(0, 0, 0), 2);
+        cv::putText(card, "ZHANG SAN", cv::Point(40, 300), cv::FONT_HERSHEY_SIMPLEX, 1.2, cv::Scalar(0, 0, 0), 2);
+
+        auto bank_card = registry.find("bank_card");
+        std::vector<Quad> quads = bank_card->locate(card);
+        SimpleTest::assertEquals(3, int(quads.size()), "One quad per field");
+        cv::Rect number = cv::boundingRect(std::vector<cv::Point>(quads[0].begin(), quads[0].end()));
+        cv::Rect nominal(26, 160, 397, 48);
+        SimpleTest::assertTrue(number.contains(cv::Point(45, 190)) && number.width < nominal.width,
+                               "Aligned field should shrink to the text it contains");
+        SimpleTest::assertTrue((number & cv::Rect(0, 156, 640, 56)) == number,
+                               "Aligned field should stay within the expanded template region");
+        SimpleTest::assertTrue(quads[2] == Quad{}, "Blank field should have an empty quad");
+
+        std::vector<Quad> fixed = registry.find("fixed")->locate(card);
+        SimpleTest::assertTrue(fixed[0][0] == cv::Point(160, 100) && fixed[0][2] == cv::Point(479, 299),
+                               "Unaligned field should use the template region as is");
+
+        // Worker 按模板只识别字段区域，结果带字段名
+        worker_ = createMockWorker(1, "mock");
+        worker_->start();
+        auto request = std::make_shared<OCRRequest>(7001, card);
+        request->layout = bank_card;
+        auto future = request->result_promise.get_future();
+        worker_->addRequest(request);
+        Json::Value result = parseJsonResult(future.get());
+        SimpleTest::assertTrue(result["success"].asBool(), "Template request should succeed");
+        SimpleTest::assertEquals(2, int(result["words"].size()), "Only non-blank fields should be recognized");
+        SimpleTest::assertTrue(result["words"][0]["field"].asString() == "card_number" &&
+                               result["words"][1]["field"].asString() == "holder", "Words should carry field names");
+
+        Json::Value detected = runRequest(*worker_, 7002, card);
+        SimpleTest::assertTrue(detected["words"].size() > 0 && !detected["words"][0].isMember("field"),
+                               "Detection mode should not emit field names");
+
+        // 模板模式与检测模式的耗时对比 (mock 检测延迟 20ms)
+        tearDown();
+        worker_ = createMockWorker(1, "mock:20");
+        worker_->start();
+        const int iterations = 10;
+        double template_ms = 0.0, detect_ms = 0.0;
+        for (int i = 0; i < iterations; ++i) {
+            auto timed = std::make_shared<OCRRequest>(7100 + i, card);
+            timed->layout = bank_card;
+            auto timed_future = timed->result_promise.get_future();
+            worker_->addRequest(timed);
+            template_ms += parseJsonResult(timed_future.get())["processing_time_ms"].asDouble();
+            detect_ms += runRequest(*worker_, 7200 + i, card)["processing_time_ms"].asDouble();
+        }
+        std::cout << "template: " << template_ms / iterations << "ms, detection: " << detect_ms / iterations
+                  << "ms per request" << std::endl;
+        SimpleTest::assertTrue(template_ms < detect_ms, "Template mode should skip the detector latency");
+    }
+
+    void testTaskTypes() {
+        SimpleTest::printLine("\n=== 测试 detect / recognize_regions / rois ===");
+
+        // 协议字段解析
+        std::string json = R"({"command":"detect","rois":[[0,0,600,200]],"regions":[[[1,2],[3,4],[5,6],[7,8]]],"bad":[[1,2,3]]})";
+        IPCRequest parsed;
+        std::string error;
+        std::vector<double> values;
+        SimpleTest::assertTrue(parsed.parseInSitu(json.data(), json.size(), error), "Request should parse");
+        SimpleTest::assertTrue(parsed.getNumberArrays("rois", 4, values) && values.size() == 4 && values[2] == 600,
+                               "rois should read as groups of four numbers");
+        SimpleTest::assertTrue(parsed.getNumberArrays("regions", 8, values) && values.size() == 8 && values[7] == 8,
+                               "regions should flatten four points per item");
+        SimpleTest::assertTrue(!parsed.getNumberArrays("bad", 4, values), "Items with the wrong size should be rejected");
+
+        worker_ = createMockWorker(1, "mock");
+        worker_->start();
+        auto submit = [&](const std::shared_ptr<OCRRequest>& request) {
+            auto future = request->result_promise.get_future();
+            worker_->addRequest(request);
+            return parseJsonResult(future.get());
+        };
+
+        Json::Value full = runRequest(*worker_, 8001, test_image_);
+        SimpleTest::assertTrue(full["words"].size() > 0, "Full recognition should produce words");
+
+        // 只检测：输出 boxes，与完整识别的文字框一致
+        auto detect = std::make_shared<OCRRequest>(8002, test_image_);
+        detect->task = OCRTask::Detect;
+        Json::Value detected = submit(detect);
+        SimpleTest::assertTrue(detected["success"].asBool() && !detected.isMember("words"), "Detect should not emit words");
+        SimpleTest::assertEquals(int(full["words"].size()), int(detected["boxes"].size()),
+                                 "Detect should return one box per recognized word");
+        bool same_boxes = true;
+        for (Json::ArrayIndex i = 0; i < detected["boxes"].size(); ++i) {
+            same_boxes = same_boxes && detected["boxes"][i] == full["words"][i]["box"];
+        }
+        SimpleTest::assertTrue(same_boxes, "Detected boxes should match the full pipeline");
+
+        // 只识别给定框：与完整识别一一对应，退化框输出空文本
+        auto regions = std::make_shared<OCRRequest>(8003, test_image_);
+        regions->task = OCRTask::RecognizeRegions;
+        for (const auto& box : detected["boxes"]) {
+            Quad quad;
+            for (int k = 0; k < 4; ++k) {
+                quad[k] = cv::Point(box[k][0].asInt(), box[k][1].asInt());
+            }
+            regions->regions.push_back(quad);
+        }
+        regions->regions.push_back(Quad{});
+        Json::Value recognized = submit(regions);
+        SimpleTest::assertEquals(int(regions->regions.size()), int(recognized["words"].size()),
+                                 "recognize_regions should return one word per region");
+        bool same_text = true;
+        for (Json::ArrayIndex i = 0; i < full["words"].size(); ++i) {
+            same_text = same_text && recognized["words"][i]["text"] == full["words"][i]["text"];
+        }
+        SimpleTest::assertTrue(same_text, "Recognizing the detected boxes should reproduce the full pipeline text");
+        SimpleTest::assertTrue(recognized["words"][full["words"].size()]["text"].asString().empty(),
+                               "Degenerate region should produce empty text");
+
+        // rois：只在给定区域内检测，框坐标为整图坐标
+        cv::Rect roi(100, 200, 400, 150);
+        auto cropped = std::make_shared<OCRRequest>(8004, test_image_);
+        cropped->rois.push_back(roi);
+        Json::Value roi_result = submit(cropped);
+        bool inside = roi_result["words"].size() > 0;
+        for (const auto& word : roi_result["words"]) {
+            for (const auto& point : word["box"]) {
+                inside = inside && roi.contains(cv::Point(point[0].asInt(), point[1].asInt()));
+            }
+        }
+        SimpleTest::assertTrue(inside, "ROI detection should only return boxes inside the ROI");
+    }
+
+    /**
+     * @brief 有界队列、截止时间准入和过期请求丢弃
+     */
+    void testAdmissionControl() {
+        SimpleTest::printLine("\n=== 测试准入控制 ===");
+
+        std::string json = R"({"deadline_ms":250,"bad":"250"})";
+        IPCRequest parsed;
+        std::string error;
+        double deadline_ms = 0.0;
+        SimpleTest::assertTrue(parsed.parseInSitu(json.data(), json.size(), error), "Request should parse");
+        SimpleTest::assertTrue(parsed.getNumber("deadline_ms", deadline_ms) && deadline_ms == 250.0,
+                               "deadline_ms should read as a number");
+        SimpleTest::assertTrue(!parsed.getNumber("bad", deadline_ms), "String members should not read as numbers");
+
+        OCRWorkerConfig config;
+        config.det_backend = "mock:20";
+        config.cls_backend = "mock:20";
+        config.rec_backend = "mock:20";
+        config.admission.max_queue_depth = 2;
+        CPUWorkerPool pool(model_dir_, 1, config);
+        pool.start();
+        // 响应先于完成回调给出，等回调记录完成后Worker才算空闲
+        auto waitCompleted = [&pool](int64_t count) {
+            while (pool.getSchedulerStats()[0].completed < count) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        };
+
+        // 先完成一个请求，让Worker得到处理耗时的估计
+        Json::Value warm = parseJsonResult(pool.submitRequest(std::make_shared<OCRRequest>(9000, test_image_)).get());
+        SimpleTest::assertTrue(warm["success"].asBool(), "Warm-up request should succeed");
+        waitCompleted(1);
+
+        // 突发请求：一个立即分派，两个排队，超过队列上限的部分立即拒绝，不等待
+        std::vector<std::future<std::string>> futures;
+        for (int i = 0; i < 6; ++i) {
+            futures.push_back(pool.submitRequest(std::make_shared<OCRRequest>(9001 + i, test_image_)));
+        }
+        int rejected_fast = 0;
+        for (size_t i = 3; i < futures.size(); ++i) {
+            if (futures[i].wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                Json::Value result = parseJsonResult(futures[i].get());
+                if (!result["success"].asBool() && result["retry_after_ms"].asInt() > 0) {
+                    ++rejected_fast;
+                }
+            }
+        }
+        SimpleTest::assertEquals(3, rejected_fast, "Requests beyond the queue depth should be rejected immediately");
+        for (size_t i = 0; i < 3; ++i) {
+            SimpleTest::assertTrue(parseJsonResult(futures[i].get())["success"].asBool(), "Admitted requests should succeed");
+        }
+
+        waitCompleted(4);
+
+        // 按当前积压无法在截止时间前完成的请求同样立即拒绝
+        auto busy = pool.submitRequest(std::make_shared<OCRRequest>(9010, test_image_));
+        auto urgent = std::make_shared<OCRRequest>(9011, test_image_);
+        urgent->deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(5);
+        auto urgent_future = pool.submitRequest(urgent);
+        SimpleTest::assertTrue(urgent_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready,
+                               "Request with an unreachable deadline should be rejected without queueing");
+        Json::Value urgent_result = parseJsonResult(urgent_future.get());
+        SimpleTest::assertTrue(!urgent_result["success"].asBool() && urgent_result["retry_after_ms"].asInt() > 0,
+                               "Deadline rejection should carry retry_after_ms");
+        busy.get();
+
+        AdmissionStats stats = pool.getAdmissionStats();
+        SimpleTest::assertEquals(4, int(stats.rejected), "Pool should count rejected requests");
+        SimpleTest::assertEquals(4, int(pool.getSchedulerStats()[0].rejected), "Rejections should be counted per class");
+        pool.stop();
+
+        // 出队时已过截止时间的请求不再推理
+        worker_ = createMockWorker(1, "mock");
+        worker_->start();
+        auto expired = std::make_shared<OCRRequest>(9020, test_image_);
+        expired->deadline = std::chrono::steady_clock::now() - std::chrono::milliseconds(1);
+        Json::Value expired_result = runRequest(*worker_, expired);
+        SimpleTest::assertTrue(!expired_result["success"].asBool(), "Expired request should fail");
+        SimpleTest::assertEquals(1, int(worker_->getExpiredCount()), "Worker should count expired requests");
+        SimpleTest::assertEquals(0, worker_->pendingRequests(), "Expired request should leave the queue");
+        SimpleTest::assertTrue(runRequest(*worker_, 9021, test_image_)["success"].asBool(),
+                               "Requests without a deadline should be unaffected");
+    }
+
+    /**
+     * @brief 已取消的请求移出队列，处理中的请求在阶段之间中止
+     */
+    void testCancellation() {
+        SimpleTest::printLine("\n=== 测试请求取消 ===");
+
+        // 检测阶段远长于测试线程从观察到出队到发出取消的间隔，取消总在检测结束前到达
+        OCRWorkerConfig config;
+        config.det_backend = "mock:200";
+        config.cls_backend = "mock:30";
+        config.rec_backend = "mock:30";
+        worker_ = std::make_unique<OCRWorker>(1, model_dir_, false, 0, false, config);
+
+        // Worker 启动前入队，三个请求都确定在队列中
+        std::vector<std::shared_ptr<OCRRequest>> requests;
+        std::vector<std::future<std::string>> futures;
+        for (int i = 0; i < 3; ++i) {
+            auto request = std::make_shared<OCRRequest>(9100 + i, test_image_);
+            request->cancel_token = std::make_shared<CancellationToken>();
+            futures.push_back(request->result_promise.get_future());
+            requests.push_back(request);
+            worker_->addRequest(request);
+        }
+
+        // 排队中的请求：移出队列并立即给出响应
+        requests[2]->cancel_token->cancel();
+        std::vector<std::shared_ptr<OCRRequest>> removed_requests;
+        worker_->removeCancelled(removed_requests);
+        SimpleTest::assertEquals(1, int(removed_requests.size()), "Cancelled queued request should be removed");
+        SimpleTest::assertTrue(futures[2].wait_for(std::chrono::seconds(0)) == std::future_status::ready,
+                               "Removed request should be answered immediately");
+        Json::Value removed = parseJsonResult(futures[2].get());
+        SimpleTest::assertTrue(!removed["success"].asBool() && removed["error"].asString() == "Request cancelled",
+                               "Removed request should report cancellation");
+
+        // 正在处理的请求：等 Worker 取走第一个请求后取消，在检测之后中止
+        worker_->start();
+        while (worker_->isIdle()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        requests[0]->cancel_token->cancel();
+        Json::Value aborted = parseJsonResult(futures[0].get());
+        SimpleTest::assertTrue(!aborted["success"].asBool() && aborted["error"].asString() == "Request cancelled",
+                               "Running request should abort between stages");
+
+        Json::Value kept = parseJsonResult(futures[1].get());
+        SimpleTest::assertTrue(kept["success"].asBool() && kept["words"].size() > 0,
+                               "Requests that were not cancelled should complete normally");
+        SimpleTest::assertEquals(2, int(worker_->getCancelledCount()), "Worker should count cancelled requests");
+        SimpleTest::assertEquals(0, worker_->pendingRequests(), "No request should remain pending");
+    }
+
+    /**
+     * @brief 优先级类别按权重、类别内按客户端公平分派
+     */
+    void testWeightedFairQueue() {
+        SimpleTest::printLine("\n=== 测试加权公平调度 ===");
+
+        SchedulerConfig config;
+        std::string error;
+        SimpleTest::assertTrue(SchedulerConfig::parse("interactive:8,bulk:1:3", config, error), "Class spec should parse");
+        SimpleTest::assertTrue(!SchedulerConfig::parse("bulk:0", config, error), "Zero weight should be rejected");
+        SimpleTest::assertEquals(1, config.findClass("bulk"), "Classes should keep their order");
+        SimpleTest::assertEquals(-1, config.findClass("missing"), "Unknown class should not be found");
+
+        RequestScheduler scheduler(config, 0);
+        auto makeRequest = [&](int id, int priority_class, const std::string& client) {
+            auto request = std::make_shared<OCRRequest>(id, cv::Mat());
+            request->priority_class = priority_class;
+            request->client_id = client;
+            return request;
+        };
+
+        // 批量类别上限 3，第 4 个起队列已满
+        for (int i = 0; i < 3; ++i) {
+            scheduler.push(makeRequest(i, 1, "bulk-a"));
+        }
+        SimpleTest::assertTrue(scheduler.full(1) && !scheduler.full(0), "Queue depth should be enforced per class");
+        scheduler.push(makeRequest(10, 1, "bulk-b"));
+        scheduler.push(makeRequest(11, 1, "bulk-b"));
+        for (int i = 0; i < 3; ++i) {
+            scheduler.push(makeRequest(100 + i, 0, "desk"));
+        }
+
+        std::vector<std::string> order;
+        std::vector<int> ids;
+        while (auto request = scheduler.pop()) {
+            order.push_back(request->client_id);
+            ids.push_back(request->request_id);
+        }
+        SimpleTest::assertEquals(8, int(order.size()), "Every queued request should be dispatched once");
+        int desk_done = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            desk_done += order[i] == "desk" ? 1 : 0;
+        }
+        SimpleTest::assertEquals(3, desk_done, "Interactive requests should be dispatched within the first four");
+        // 批量类别内两个客户端交替，而不是先排空提交更早、更多的客户端
+        std::vector<std::string> bulk;
+        for (const auto& client : order) {
+            if (client != "desk") {
+                bulk.push_back(client);
+            }
+        }
+        SimpleTest::assertTrue(bulk[0] != bulk[1] && bulk[1] != bulk[2] && bulk[2] != bulk[3],
+                               "Bulk clients should alternate");
+        SimpleTest::assertTrue(std::find(ids.begin(), ids.end(), 0) < std::find(ids.begin(), ids.end(), 1),
+                               "Requests of one client should stay in FIFO order");
+
+        std::vector<PriorityClassStats> stats = scheduler.stats();
+        SimpleTest::assertEquals(3, int(stats[0].dispatched), "Dispatches should be counted per class");
+        SimpleTest::assertEquals(3, stats[1].max_queue_depth, "Configured depth should be reported");
+    }
+
+    /**
+     * @brief 代价模型在线拟合耗时，类别内小请求先分派，等待过久的大请求不会饿死
+     */
+    void testShortestJobFirst() {
+        SimpleTest::printLine("\n=== 测试按预测耗时优先分派 ===");
+
+        RequestScheduler scheduler(SchedulerConfig(), 0);
+        auto makeRequest = [](int id, int width, int height, const std::string& client) {
+            auto request = std::make_shared<OCRRequest>(id, cv::Mat(height, width, CV_8UC1));
+            request->client_id = client;
+            return request;
+        };
+
+        // 模拟已完成的请求：耗时 = 20ms + 50ms/百万像素 + 2ms/文字框
+        const int sizes[][2] = {{500, 300}, {2000, 1500}, {1000, 800}, {1600, 1200}, {800, 600}, {1200, 900}};
+        for (int i = 0; i < 36; ++i) {
+            auto request = makeRequest(i, sizes[i % 6][0], sizes[i % 6][1], "history");
+            double megapixels = request->image_data.total() / 1e6;
+            request->box_count = static_cast<int>(megapixels * 20) + i % 3;
+            request->service_ms = 20.0 + 50.0 * megapixels + 2.0 * request->box_count;
+            scheduler.push(request);
+            scheduler.recordCompleted(*scheduler.pop());
+        }
+        const CostModel& model = scheduler.costModel();
+        SimpleTest::assertTrue(model.ready(), "Cost model should be ready after enough samples");
+        double big_ms = model.predict(*makeRequest(0, 2000, 1500, "probe"));
+        double small_ms = model.predict(*makeRequest(0, 500, 300, "probe"));
+        SimpleTest::printLine("预测耗时: 2000x1500 = " + std::to_string(big_ms) + " ms, 500x300 = " + std::to_string(small_ms) + " ms");
+        SimpleTest::assertTrue(std::abs(big_ms - 290.0) < 29.0, "Large image prediction should be within 10%");
+        SimpleTest::assertTrue(std::abs(small_ms - 33.0) < 5.0, "Small image prediction should be close");
+
+        // 大请求先提交，小请求仍先分派
+        scheduler.push(makeRequest(100, 2000, 1500, "photo"));
+        scheduler.push(makeRequest(101, 500, 300, "screenshot"));
+        SimpleTest::assertEquals(101, scheduler.pop()->request_id, "Smaller request should be dispatched first");
+        SimpleTest::assertEquals(100, scheduler.pop()->request_id, "Larger request should follow");
+
+        // 已等待足够久的大请求不再让位
+        auto waiting = makeRequest(102, 2000, 1500, "photo");
+        scheduler.push(waiting);
+        waiting->submit_time -= std::chrono::seconds(10);
+        scheduler.push(makeRequest(103, 500, 300, "screenshot"));
+        SimpleTest::assertEquals(102, scheduler.pop()->request_id, "Aged request should not starve");
+        scheduler.pop();
+
+        // 关闭后按提交顺序分派
+        SchedulerConfig fifo;
+        fifo.shortest_job_first = false;
+        RequestScheduler plain(fifo, 0);
+        plain.push(makeRequest(200, 2000, 1500, "photo"));
+        plain.push(makeRequest(201, 500, 300, "photo"));
+        SimpleTest::assertEquals(200, plain.pop()->request_id, "FIFO order should be kept without SJF");
+    }
+
+    /**
+     * @brief 对冲阈值按预测耗时归一；对冲后每个请求只得到一个响应，落败的一方不计为取消
+     */
+    void testHedging() {
+        SimpleTest::printLine("\n=== 测试对冲执行 ===");
+
+        HedgingConfig policy_config;
+        policy_config.percentile = 90;
+        policy_config.min_samples = 10;
+        HedgePolicy policy(policy_config);
+        OCRRequest sample(0, cv::Mat());
+        sample.predicted_ms = 10.0;
+        SimpleTest::assertTrue(policy.thresholdMs(sample) < 0.0, "No hedging before enough samples");
+        for (int i = 1; i <= 10; ++i) {
+            sample.service_ms = 10.0 * i;  // 比值 1..10
+            policy.record(sample);
+        }
+        OCRRequest large(0, cv::Mat());
+        large.predicted_ms = 100.0;
+        SimpleTest::assertEquals(90, int(std::lround(policy.thresholdMs(sample))), "Threshold should be the ratio percentile times prediction");
+        SimpleTest::assertEquals(900, int(std::lround(policy.thresholdMs(large))), "Larger predictions should get larger thresholds");
+
+        // 先用只检测的请求积累样本，代价模型按检测耗时预测；之后的整图识别多出远长于检测的识别阶段，
+        // 处理时间必然远超阈值，且逐个提交时另一个Worker总是空闲，对冲必定发生
+        OCRWorkerConfig config;
+        config.det_backend = "mock:10";
+        config.cls_backend = "mock:10";
+        config.rec_backend = "mock:150";
+        config.hedging.percentile = 50;
+        config.hedging.min_samples = 5;
+        CPUWorkerPool pool(model_dir_, 2, config);
+        pool.start();
+
+        const int warmup = 6;
+        const int count = warmup + 4;
+        for (int i = 0; i < count; ++i) {
+            auto request = std::make_shared<OCRRequest>(9200 + i, test_image_);
+            request->task = i < warmup ? OCRTask::Detect : OCRTask::Recognize;
+            Json::Value result = parseJsonResult(pool.submitRequest(request).get());
+            SimpleTest::assertTrue(result["success"].asBool() && result["request_id"].asInt() == 9200 + i,
+                                   "Every request should get its own successful response");
+        }
+        while (pool.getSchedulerStats()[0].completed < count) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        HedgingStats stats = pool.getHedgingStats();
+        SimpleTest::printLine("对冲: " + std::to_string(stats.launched) + " / " + std::to_string(stats.dispatched) +
+                              ", 副本先完成 " + std::to_string(stats.wins));
+        SimpleTest::assertTrue(stats.launched > 0, "Slow requests should be hedged on the idle worker");
+        SimpleTest::assertTrue(stats.wins <= stats.launched, "Wins cannot exceed hedges");
+        SimpleTest::assertEquals(count, int(stats.dispatched), "Hedge copies should not count as dispatched requests");
+        SimpleTest::assertEquals(count, int(pool.getSchedulerStats()[0].completed), "Each request should complete once");
+        SimpleTest::assertEquals(0, int(pool.getAdmissionStats().cancelled), "Losing copies should not count as cancelled");
+        pool.stop();
+    }
+
+    void testShapeAffinity() {
+        SimpleTest::printLine("\n=== 测试输入形状亲和 ===");
+
+        const int64_t a = ShapeAffinity::detKey(320, 640);
+        const int64_t b = ShapeAffinity::detKey(480, 480);
+        const int64_t c = ShapeAffinity::detKey(640, 640);
+        SimpleTest::assertTrue(a != b && ShapeAffinity::recKey(320) != ShapeAffinity::detKey(0, 320),
+                               "Detection and recognition shapes should get distinct keys");
+
+        ShapeAffinity affinity(2, 2);
+        affinity.record(0, a);
+        affinity.record(1, b);
+        SimpleTest::assertEquals(1, int(affinity.choose(a, {1, 0})), "Should pick the idle worker that served the shape");
+        SimpleTest::assertEquals(0, int(affinity.choose(c, {1, 0})), "Unseen shapes should go to the first idle worker");
+        SimpleTest::assertEquals(0, int(affinity.choose(0, {1, 0})), "Unknown shapes should go to the first idle worker");
+
+        affinity.record(0, ShapeAffinity::recKey(320));  // 识别形状不挤占检测形状
+        affinity.record(0, a);                           // 命中
+        affinity.record(0, b);
+        affinity.record(0, c);                           // 容量为 2，挤出 a
+        affinity.record(0, a);                           // 未命中
+        std::vector<WorkerShapeStats> unit_stats = affinity.stats();
+        SimpleTest::assertEquals(6, int(unit_stats[0].requests), "Every keyed request should be counted");
+        SimpleTest::assertEquals(1, int(unit_stats[0].hits), "Only shapes still in the recent set should hit");
+
+        // 两种尺寸交替提交，各自固定在一个Worker上
+        OCRWorkerConfig config;
+        config.det_backend = "mock:5";
+        config.cls_backend = "mock:5";
+        config.rec_backend = "mock:2";
+        CPUWorkerPool pool(model_dir_, 2, config);
+        pool.start();
+
+        const int count = 20;
+        cv::Mat wide(320, 640, CV_8UC3, cv::Scalar(255, 255, 255));
+        cv::Mat square(480, 480, CV_8UC3, cv::Scalar(255, 255, 255));
+        for (int i = 0; i < count; ++i) {
+            auto request = std::make_shared<OCRRequest>(9400 + i, i % 2 == 0 ? wide : square);
+            Json::Value result = parseJsonResult(pool.submitRequest(request).get());
+            SimpleTest::assertTrue(result["success"].asBool(), "Request should succeed");
+            while (pool.getSchedulerStats()[0].completed < i + 1) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+
+        int64_t requests = 0;
+        int64_t hits = 0;
+        for (const auto& stats : pool.getShapeStats()) {
+            requests += stats.requests;
+            hits += stats.hits;
+        }
+        SimpleTest::printLine("形状命中: " + std::to_string(hits) + " / " + std::to_string(requests));
+        SimpleTest::assertEquals(count, int(requests), "Every request should have a shape key");
+        SimpleTest::assertTrue(hits >= count - 4, "Alternating shapes should keep returning to warm workers");
+        pool.stop();
+    }
+
+    /**
+     * @brief 零延迟 mock 下的流水线开销基准：多个 Worker 并发处理，推理耗时不计
+     */
+    void testPipelineOverhead() {
+        SimpleTest::printLine("\n=== 流水线开销基准 (mock, 零推理延迟) ===");
+
+        const int worker_count = 4;
+        const int request_count = 200;
+        std::vector<std::unique_ptr<OCRWorker>> workers;
+        for (int i = 0; i < worker_count; ++i) {
+            workers.push_back(createMockWorker(i, "mock"));
+            workers.back()->start();
+        }
+
+        std::vector<std::future<std::string>> futures;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < request_count; ++i) {
+            auto request = std::make_shared<OCRRequest>(3000 + i, test_image_);
+            futures.push_back(request->result_promise.get_future());
+            workers[i % worker_count]->addRequest(request);
+        }
+
+        int succeeded = 0;
+        double processing_sum = 0.0;
+        for (auto& future : futures) {
+            Json::Value result = parseJsonResult(future.get());
+            if (result["success"].asBool()) {
+                ++succeeded;
+                processing_sum += result["processing_time_ms"].asDouble();
+            }
+        }
+        double wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        for (auto& worker : workers) {
+            worker->stop();
+        }
+
+        SimpleTest::assertEquals(request_count, succeeded, "All mock requests should succeed");
+        std::cout << "requests: " << request_count << ", workers: " << worker_count
+                  << ", wall: " << wall_ms << "ms"
+                  << ", throughput: " << (request_count * 1000.0 / wall_ms) << " req/s"
+                  << ", avg in-worker: " << (processing_sum / std::max(1, succeeded)) << "ms" << std::endl;
+    }
+
+    void runSingleTest(const std::string& testName) {
+        setUp();
+        try {
+            if (testName == "MockBackendShapes") {
+                testMockBackendShapes();
+            } else if (testName == "MockDeterministic") {
+                testMockDeterministic();
+            } else if (testName == "MockLatency") {
+                testMockLatency();
+            } else if (testName == "BufferPoolSteadyState") {
+                testBufferPoolSteadyState();
+            } else if (testName == "IPCRequestParse") {
+                testIPCRequestParse();
+            } else if (testName == "ReducedDecode") {
+                testReducedDecode();
+            } else if (testName == "ResultCache") {
+                testResultCache();
+            } else if (testName == "RecognitionCache") {
+                testRecognitionCache();
+            } else if (testName == "LayoutTemplate") {
+                testLayoutTemplate();
+            } else if (testName == "TaskTypes") {
+                testTaskTypes();
+            } else if (testName == "AdmissionControl") {
+                testAdmissionControl();
+            } else if (testName == "Cancellation") {
+                testCancellation();
+            } else if (testName == "WeightedFairQueue") {
+                testWeightedFairQueue();
+            } else if (testName == "ShortestJobFirst") {
+                testShortestJobFirst();
+            } else if (testName == "Hedging") {
+                testHedging();
+            } else if (testName == "ShapeAffinity") {
+                testShapeAffinity();
+            } else if (testName == "PipelineOverhead") {
+                testPipelineOverhead();
+            } else {
+                SimpleTest::printError("未知测试: " + testName);
+                SimpleTest::printLine("可用测试: MockBackendShapes, MockDeterministic, MockLatency, BufferPoolSteadyState, IPCRequestParse, ReducedDecode, ResultCache, RecognitionCache, LayoutTemplate, TaskTypes, AdmissionControl, Cancellation, WeightedFairQueue, ShortestJobFirst, Hedging, ShapeAffinity, PipelineOverhead");
+            }
+        } catch (const std::exception& e) {
+            SimpleTest::printError("测试 " + testName + " 失败: " + std::string(e.what()));
+        }
+        tearDown();
+    }
+
+    void runAllTests() {
+        SimpleTest::printLine("开始运行 mock 流水线测试...");
+
+        try {
+            setUp();
+            testMockBackendShapes();
+            tearDown();
+
+            setUp();
+            testMockDeterministic();
+            tearDown();
+
+            setUp();
+            testMockLatency();
+            tearDown();
+
+            setUp();
+            testBufferPoolSteadyState();
+            tearDown();
+
+            setUp();
+            testIPCRequestParse();
+            tearDown();
+
+            setUp();
+            testReducedDecode();
+            tearDown();
+
+            setUp();
+            testResultCache();
+            tearDown();
+
+            setUp();
+            testRecognitionCache();
+            tearDown();
+
+            setUp();
+            testLayoutTemplate();
+            tearDown();
+
+            setUp();
+            testTaskTypes();
+            tearDown();
+
+            setUp();
+            testAdmissionControl();
+            tearDown();
+
+            setUp();
+            testCancellation();
+            tearDown();
+
+            setUp();
+            testWeightedFairQueue();
+            tearDown();
+
+            setUp();
+            testShortestJobFirst();
+            tearDown();
+
+            setUp();
+            testHedging();
+            tearDown();
+
+            setUp();
+            testShapeAffinity();
+            tearDown();
+
+            setUp();
+            testPipelineOverhead();
+            tearDown();
+
+            SimpleTest::printLine("\n所有 mock 流水线测试完成!");
+        } catch (const std::exception& e) {
+            SimpleTest::printError("测试失败: " + std::string(e.what()));
+            tearDown();
+        }
+    }
+};
+
+int main(int argc, char* argv[]) {
+    SimpleTest::setupConsole();
+
+    MockPipelineTest test;
+
+    if (argc > 1) {
+        std::string testName = argv[1];
+        SimpleTest::printLine("运行指定测试: " + testName);
+        test.runSingleTest(testName);
+    } else {
+        SimpleTest::printLine("运行所有测试...");
+        test.runAllTests();
+    }
+
+    return 0;
+}
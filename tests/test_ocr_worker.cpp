@@ -8,8 +8,13 @@
 #include <fstream>
 #include <cassert>
 #include <filesystem>
+#include <algorithm>
+#include <string>
+#include <vector>
 
 #include <paddle_ocr/ocr_worker.h>
+#include <paddle_ocr/rec_batch_planner.h>
+#include <paddle_ocr/cpu_features.h>
 #include "simple_test.h"
 
 using namespace PaddleOCR;
@@ -381,6 +386,335 @@ public:
         no_cls_worker->stop();
     }
     
+    void testTiledDetection() {
+        SimpleTest::printLine("\n=== 测试长图分块检测 ===");
+        
+        OCRWorkerConfig config;
+        config.tiled_det.enabled = true;
+        config.tiled_det.tile_side = 640;
+        config.tiled_det.overlap = 96;
+        
+        // 两个Worker互为peer，分块可以并行
+        auto tiled_worker = std::make_unique<OCRWorker>(6, model_dir_, false, 0, false, config);
+        auto peer_worker = std::make_unique<OCRWorker>(7, model_dir_, false, 0, false, config);
+        std::vector<OCRWorker*> peers = {tiled_worker.get(), peer_worker.get()};
+        tiled_worker->setPeers(peers);
+        peer_worker->setPeers(peers);
+        tiled_worker->start();
+        peer_worker->start();
+        
+        // 600x4000 的长截图，每隔300像素一行文字，包括落在分块接缝上的行
+        cv::Mat long_image(4000, 600, CV_8UC3, cv::Scalar(255, 255, 255));
+        int line_count = 0;
+        for (int y = 60; y < 4000; y += 300) {
+            cv::putText(long_image, "Line " + std::to_string(line_count++), cv::Point(40, y),
+                       cv::FONT_HERSHEY_SIMPLEX, 1.2, cv::Scalar(0, 0, 0), 2);
+        }
+        
+        auto request = std::make_shared<OCRRequest>(6001, long_image);
+        auto future = request->result_promise.get_future();
+        tiled_worker->addRequest(request);
+        
+        auto status = future.wait_for(std::chrono::seconds(60));
+        SimpleTest::assertTrue(status == std::future_status::ready, "Tiled detection should complete");
+        
+        Json::Value result = parseJsonResult(future.get());
+        SimpleTest::printJsonResult(result, "长图分块检测结果");
+        
+        SimpleTest::assertTrue(result["success"].asBool(), "Tiled OCR should succeed");
+        SimpleTest::assertEquals(4000, result["height"].asInt(), "Height should be the original height");
+        SimpleTest::assertTrue(result["words"].size() > 0, "Tiled detection should find text lines");
+        SimpleTest::assertTrue(static_cast<int>(result["words"].size()) <= line_count,
+                               "Seam duplicates should be merged");
+        
+        tiled_worker->stop();
+        peer_worker->stop();
+    }
+    
+    void testCascadeMode() {
+        SimpleTest::printLine("\n=== 测试级联模式 ===");
+        
+        cv::Mat real_image = loadTestImageFromFile("card-jd.jpg");
+        
+        // 常规单次流程作为基准
+        worker_ = std::make_unique<OCRWorker>(1, model_dir_, false, 0, false);
+        worker_->start();
+        auto baseline_request = std::make_shared<OCRRequest>(7001, real_image);
+        auto baseline_future = baseline_request->result_promise.get_future();
+        worker_->addRequest(baseline_request);
+        SimpleTest::assertTrue(baseline_future.wait_for(std::chrono::seconds(30)) == std::future_status::ready,
+                               "Baseline processing should complete");
+        Json::Value baseline = parseJsonResult(baseline_future.get());
+        worker_->stop();
+        
+        OCRWorkerConfig config;
+        config.cascade.enabled = true;
+        config.cascade.fast_side_len = 320;
+        config.cascade.rec_threshold = 0.85f;
+        auto cascade_worker = std::make_unique<OCRWorker>(8, model_dir_, false, 0, false, config);
+        cascade_worker->start();
+        
+        auto request = std::make_shared<OCRRequest>(7002, real_image);
+        auto future = request->result_promise.get_future();
+        cascade_worker->addRequest(request);
+        SimpleTest::assertTrue(future.wait_for(std::chrono::seconds(30)) == std::future_status::ready,
+                               "Cascade processing should complete");
+        Json::Value result = parseJsonResult(future.get());
+        SimpleTest::printJsonResult(result, "级联模式结果");
+        
+        SimpleTest::assertTrue(result["success"].asBool(), "Cascade OCR should succeed");
+        SimpleTest::assertTrue(result["words"].size() > 0, "Cascade mode should recognize text");
+        
+        // 统计复检后仍低于阈值的文字数量
+        int low_confidence = 0;
+        for (const auto& word : result["words"]) {
+            if (word["confidence"].asFloat() < config.cascade.rec_threshold) {
+                low_confidence++;
+            }
+        }
+        SimpleTest::printLine("基准文字数: " + std::to_string(baseline["words"].size()) +
+                              ", 级联文字数: " + std::to_string(result["words"].size()) +
+                              ", 低置信度: " + std::to_string(low_confidence));
+        SimpleTest::printLine("基准耗时: " + std::to_string(baseline["processing_time_ms"].asDouble()) +
+                              " ms, 级联耗时: " + std::to_string(result["processing_time_ms"].asDouble()) + " ms");
+        
+        // 级联结果应与单次流程识别出相同的文字 (顺序和框坐标可能不同)
+        std::vector<std::string> baseline_texts;
+        std::vector<std::string> cascade_texts;
+        for (const auto& word : baseline["words"]) {
+            baseline_texts.push_back(word["text"].asString());
+        }
+        for (const auto& word : result["words"]) {
+            cascade_texts.push_back(word["text"].asString());
+        }
+        std::sort(baseline_texts.begin(), baseline_texts.end());
+        std::sort(cascade_texts.begin(), cascade_texts.end());
+        SimpleTest::assertTrue(cascade_texts == baseline_texts, "Cascade mode should recognize the same text as a single pass");
+        
+        // 结果一致不能说明级联生效：回退到常规流程时结果同样一致
+        CascadeStats cascade_stats = cascade_worker->getCascadeStats();
+        SimpleTest::assertEquals(1, static_cast<int>(cascade_stats.accepted), "Cascade fast pass should be accepted");
+        SimpleTest::assertEquals(0, static_cast<int>(cascade_stats.fallbacks), "Cascade should not fall back");
+        
+        cascade_worker->stop();
+    }
+    
+    void testRecBatchPlanner() {
+        SimpleTest::printLine("\n=== 测试识别批次规划 ===");
+        
+        RecBatchPlannerConfig config;
+        config.max_batch = 16;
+        config.width_bucket = 64;
+        config.max_batch_width = 1600;
+        
+        // 15 条短行 + 1 条超长行：固定切分会把短行全部填充到超长行的宽度
+        std::vector<int> widths(15, 120);
+        widths.push_back(2400);
+        std::vector<RecBatch> batches = RecBatchPlanner::plan(widths, 192, config);
+        
+        SimpleTest::assertEquals(2, static_cast<int>(batches.size()), "Long line should get its own batch");
+        SimpleTest::assertEquals(192, batches[0].width, "Short batch width should respect the minimum width");
+        SimpleTest::assertEquals(15, static_cast<int>(batches[0].end - batches[0].begin), "Short lines stay together");
+        SimpleTest::assertEquals(2432, batches[1].width, "Batch width should be rounded up to the bucket");
+        
+        // 批次必须连续覆盖全部图像
+        size_t covered = 0;
+        for (const auto& batch : batches) {
+            SimpleTest::assertEquals(static_cast<int>(covered), static_cast<int>(batch.begin), "Batches should be contiguous");
+            covered = batch.end;
+        }
+        SimpleTest::assertEquals(static_cast<int>(widths.size()), static_cast<int>(covered), "Batches should cover all images");
+        
+        // 宽度接近的图像不应被无谓拆分
+        std::vector<int> uniform(32, 300);
+        std::vector<RecBatch> uniform_batches = RecBatchPlanner::plan(uniform, 192, config);
+        SimpleTest::assertEquals(2, static_cast<int>(uniform_batches.size()), "Uniform widths should fill max_batch");
+    }
+    
+    void testCpuPrecision() {
+        SimpleTest::printLine("\n=== 测试CPU精度选择 ===");
+        
+        const CPUFeatures& features = CPUFeatures::detect();
+        SimpleTest::printLine("CPU: " + features.summary());
+        
+        SimpleTest::assertTrue(CPUFeatures::resolvePrecision("fp32") == "fp32", "Explicit fp32 should be kept");
+        std::string expected = features.supportsBf16() ? "bf16" : "fp32";
+        SimpleTest::assertTrue(CPUFeatures::resolvePrecision("auto") == expected, "auto should follow CPU bf16 support");
+        SimpleTest::assertTrue(CPUFeatures::resolvePrecision("bf16") == expected, "bf16 should fall back without hardware support");
+        
+        OCRWorkerConfig config;
+        config.cpu_precision = "auto";
+        worker_ = std::make_unique<OCRWorker>(1, model_dir_, false, 0, false, config);
+        SimpleTest::assertTrue(worker_->getDetPrecision() == expected, "Detector should run with the resolved precision");
+        SimpleTest::assertTrue(worker_->getRecPrecision() == expected, "Recognizer should run with the resolved precision");
+    }
+    
+    void testRequestOwnership() {
+        SimpleTest::printLine("\n=== 测试请求图像所有权转移 ===");
+        
+        // 右值构造：像素缓冲区原样移交，不再拷贝
+        cv::Mat decoded = createTestImage();
+        const uchar* pixels = decoded.data;
+        auto moved_request = std::make_shared<OCRRequest>(8001, std::move(decoded));
+        SimpleTest::assertTrue(moved_request->image_data.data == pixels, "Rvalue image should be moved into the request");
+        SimpleTest::assertTrue(decoded.empty(), "Moved-from image should be empty");
+        
+        // 左值构造：调用方仍持有图像，请求持有独立副本
+        auto copied_request = std::make_shared<OCRRequest>(8002, test_image_);
+        SimpleTest::assertTrue(copied_request->image_data.data != test_image_.data, "Lvalue image should be cloned");
+        
+        worker_ = std::make_unique<OCRWorker>(1, model_dir_, false, 0, false);
+        worker_->start();
+        auto future = moved_request->result_promise.get_future();
+        worker_->addRequest(std::move(moved_request));
+        
+        auto status = future.wait_for(std::chrono::seconds(30));
+        SimpleTest::assertTrue(status == std::future_status::ready, "Moved request should complete");
+        Json::Value result = parseJsonResult(future.get());
+        SimpleTest::assertTrue(result["success"].asBool(), "Moved request should succeed");
+        
+        worker_->stop();
+    }
+    
+    
+    /**
+     * @brief 旧版结果序列化 (Json::Value 树 + StreamWriterBuilder)，作为流式写入器的对照
+     */
+    static std::string legacyResultJson(const OCRResult& result, int worker_id) {
+        Json::Value json_result;
+        json_result["request_id"] = result.request_id;
+        json_result["width"] = result.width;
+        json_result["height"] = result.height;
+        json_result["success"] = result.success;
+        json_result["processing_time_ms"] = result.processing_time_ms;
+        json_result["worker_id"] = worker_id;
+        if (result.success) {
+            Json::Value words_array(Json::arrayValue);
+            for (const auto& word : result.words) {
+                Json::Value word_map(Json::objectValue);
+                word_map["text"] = word.text;
+                word_map["confidence"] = word.confidence;
+                if (!word.field.empty()) {
+                    word_map["field"] = word.field;
+                }
+                Json::Value box_array(Json::arrayValue);
+                for (const auto& point : word.box) {
+                    Json::Value point_array(Json::arrayValue);
+                    point_array.append(point.x);
+                    point_array.append(point.y);
+                    box_array.append(point_array);
+                }
+                word_map["box"] = box_array;
+                words_array.append(word_map);
+            }
+            json_result["words"] = words_array;
+        } else {
+            json_result["error"] = result.error_message;
+        }
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "";
+        builder["enableYAMLCompatibility"] = false;
+        builder["dropNullPlaceholders"] = false;
+        builder["useSpecialFloats"] = false;
+        builder["emitUTF8"] = true;
+        return Json::writeString(builder, json_result);
+    }
+    
+    void testJsonResultWriter() {
+        SimpleTest::printLine("\n=== 测试流式 JSON 结果写入器 ===");
+        
+        const std::vector<std::string> texts = {
+            "Hello", "", "引号\"反斜杠\\", "换行\n制表\t回车\r", std::string("控制\x01\x1f\x7f字符", 15),
+            std::string("含\0空字符", 13), "中文识别结果：价格￥12.50", "emoji \xF0\x9F\x98\x80", "/slash/"
+        };
+        const std::vector<float> confidences = {0.0f, 1.0f, 0.5f, 0.987654321f, 1e-7f, 0.1f};
+        const std::vector<double> times = {0.0, 12.0, 3.25, 123.456789012345, 1e21, 1e-5};
+        
+        std::vector<OCRResult> cases;
+        for (size_t i = 0; i < times.size(); ++i) {
+            OCRResult result;
+            result.request_id = static_cast<int>(i) * 1000 - 1;
+            result.success = true;
+            result.width = 1920;
+            result.height = -1 + static_cast<int>(i);
+            result.processing_time_ms = times[i];
+            for (size_t j = 0; j < i * 3; ++j) {
+                WordResult word;
+                word.text = texts[(i + j) % texts.size()];
+                word.confidence = confidences[(i * 7 + j) % confidences.size()];
+                word.field = j % 2 ? "card_number" : "";
+                word.box = {cv::Point(static_cast<int>(j), 0), cv::Point(100000, -5),
+                            cv::Point(-2147483647, 2147483647), cv::Point(0, static_cast<int>(i))};
+                result.words.push_back(word);
+            }
+            cases.push_back(result);
+        }
+        OCRResult failure;
+        failure.request_id = 7;
+        failure.success = false;
+        failure.width = 0;
+        failure.height = 0;
+        failure.processing_time_ms = 0.5;
+        failure.error_message = "无法解码 \"image\"\n";
+        cases.push_back(failure);
+        
+        JsonWriter writer;
+        for (const auto& result : cases) {
+            OCRWorker::writeResultJson(result, 3, writer);
+            SimpleTest::assertTrue(legacyResultJson(result, 3) == writer.str(),
+                                   "Streaming writer should match Json::Value output byte for byte");
+        }
+        
+        // 异常路径的错误响应
+        {
+            Json::Value error_result;
+            error_result["request_id"] = 42;
+            error_result["success"] = false;
+            error_result["error"] = "bad\talloc";
+            error_result["worker_id"] = 2;
+            Json::StreamWriterBuilder builder;
+            builder["indentation"] = "";
+            builder["emitUTF8"] = true;
+            OCRWorker::writeErrorJson(42, "bad\talloc", 2, writer);
+            SimpleTest::assertTrue(Json::writeString(builder, error_result) == writer.str(),
+                                   "Error response should match Json::Value output");
+        }
+        
+        // 基准：200 个文字框的典型结果
+        OCRResult large;
+        large.request_id = 1;
+        large.success = true;
+        large.width = 2480;
+        large.height = 3508;
+        large.processing_time_ms = 456.789;
+        for (int j = 0; j < 200; ++j) {
+            WordResult word;
+            word.text = texts[j % texts.size()] + " 第" + std::to_string(j) + "行";
+            word.confidence = 0.9f + 0.0003f * j;
+            word.box = {cv::Point(10, 20 * j), cv::Point(800, 20 * j), cv::Point(800, 20 * j + 18), cv::Point(10, 20 * j + 18)};
+            large.words.push_back(word);
+        }
+        
+        const int iterations = 500;
+        size_t sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            sink += legacyResultJson(large, 1).size();
+        }
+        double legacy_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            OCRWorker::writeResultJson(large, 1, writer);
+            sink += writer.str().size();
+        }
+        double streaming_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        
+        std::cout << "200 words x " << iterations << ": Json::Value " << legacy_ms << "ms, streaming "
+                  << streaming_ms << "ms, speedup " << (legacy_ms / std::max(streaming_ms, 1e-3))
+                  << "x (" << sink << " bytes)" << std::endl;
+    }
+    
     void testPerformanceBenchmark() {
         SimpleTest::printLine("\n=== 性能基准测试 ===");
         
@@ -595,13 +929,25 @@ public:
                 testWithTextClassification();
             } else if (testName == "WithoutTextClassification") {
                 testWithoutTextClassification();
+            } else if (testName == "TiledDetection") {
+                testTiledDetection();
+            } else if (testName == "CascadeMode") {
+                testCascadeMode();
+            } else if (testName == "RecBatchPlanner") {
+                testRecBatchPlanner();
+            } else if (testName == "CpuPrecision") {
+                testCpuPrecision();
+            } else if (testName == "RequestOwnership") {
+                testRequestOwnership();
+            } else if (testName == "JsonResultWriter") {
+                testJsonResultWriter();
             } else if (testName == "PerformanceBenchmark") {
                 testPerformanceBenchmark();
             } else if (testName == "ColdVsWarmStartup") {
                 testColdVsWarmStartup();
             } else {
                 SimpleTest::printError("未知测试: " + testName);
-                SimpleTest::printError("可用测试: ConstructorCPU, StartStop, MultipleStart, BasicOCRProcessing, RealImageProcessing, EmptyImageProcessing, ConcurrentProcessing, IdleState, InvalidModelPath, WithTextClassification, WithoutTextClassification, PerformanceBenchmark, ColdVsWarmStartup");
+                SimpleTest::printError("可用测试: ConstructorCPU, StartStop, MultipleStart, BasicOCRProcessing, RealImageProcessing, EmptyImageProcessing, ConcurrentProcessing, IdleState, InvalidModelPath, WithTextClassification, WithoutTextClassification, TiledDetection, CascadeMode, RecBatchPlanner, CpuPrecision, RequestOwnership, JsonResultWriter, PerformanceBenchmark, ColdVsWarmStartup");
                 return;
             }
             
@@ -671,6 +1017,30 @@ public:
             testWithoutTextClassification();
             tearDown();
             
+            setUp();
+            testTiledDetection();
+            tearDown();
+            
+            setUp();
+            testCascadeMode();
+            tearDown();
+            
+            setUp();
+            testRecBatchPlanner();
+            tearDown();
+            
+            setUp();
+            testCpuPrecision();
+            tearDown();
+            
+            setUp();
+            testRequestOwnership();
+            tearDown();
+            
+            setUp();
+            testJsonResultWriter();
+            tearDown();
+            
             setUp();
             testPerformanceBenchmark();
             tearDown();